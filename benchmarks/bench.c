@@ -7,6 +7,7 @@
 #include <stdio.h>
 #include "arith.h"
 #include "random.h"
+#include "dispatch.h"
 
 #define WARMUP      5000
 #define BENCH_LOOPS 15000
@@ -15,6 +16,48 @@
 // Volatile sink prevents compiler from optimizing away function calls
 static volatile digit_t sink;
 
+// Rows after the single-element ones: variable-time versions, array kernels, then radix 2^51 and 4-way p256_0
+// kernels when built. The variable-time rows read the random t1 (non-squares half of the time) and write to t
+#define VT_SEL      11
+#define VEC_SEL     14
+#define F51_SEL     22
+
+// Scratch of the f_inv_batch rows, which invert a timed batch in chunks of 8, 64 and BATCH elements
+static f_elm_t binv[BATCH];
+#ifdef RADIX51
+// Radix 2^51 copies of the operands for the f51_* rows
+static f51_elm_t *u0 = NULL, *u1 = NULL;
+#define X4_SEL      (F51_SEL + 6)
+#else
+#define X4_SEL      F51_SEL
+#endif
+
+#if PRIME_ID == P256_0
+// 4-way copies of the operands for the f_*_x4 rows, one entry per four elements, timed per call
+static f_elm_x4_t *v0 = NULL, *v1 = NULL, v2;
+#define X8_SEL      (X4_SEL + 4)
+#else
+#define X8_SEL      X4_SEL
+#endif
+
+// 8-way copies of the operands for the f_*_x8 rows, one entry per eight elements, timed per call
+static f_elm_x8_t *w0 = NULL, *w1 = NULL;
+
+// Interleaved rows, one call per two or four elements, timed per element
+#define MULL_SEL    (X8_SEL + 2)
+
+// Constant-time rows, the lookup scans a table of 16 elements
+#define CT_SEL      (MULL_SEL + 3)
+
+// Constant multiplier for the f_mul_const row, prepared from t1[0]
+#define CONST_SEL   (CT_SEL + 2)
+static f_const_t kc;
+
+// Structure-of-arrays operands for the f_vec_* rows, one batch, timed per element like the array kernels
+#define SOA_SEL     (CONST_SEL + 2)
+static f_vec_t sa, sb;
+static uint8_t cond[BATCH];
+
 // Returns nanoseconds using monotonic clock (unaffected by system time changes)
 static inline uint64_t get_time_ns(void) {
     struct timespec ts;
@@ -43,22 +86,98 @@ static const char* format_number(uint64_t num) {
 
 
 static void __attribute__((noinline)) bench_fun(int sel, f_elm_t *t0, f_elm_t* t1, unsigned char* s, int i){
+    digit_t t[2 * WORDS_FIELD];
+
     switch (sel) {
         case 0: f_red(t0[i]); sink = t0[i][0]; break;
         case 1: f_add(t0[i], t1[i], t0[i]); sink = t0[i][0]; break;
         case 2: f_neg(t0[i], t0[i]); sink = t0[i][0]; break;
         case 3: f_sub(t0[i], t1[i], t0[i]); sink = t0[i][0]; break;
-        case 4: f_mul(t0[i], t1[i], t0[i]); sink = t0[i][0]; break;
-        case 5: f_leg(t0[i], &s[i]); sink = s[i]; break;
-        case 6: f_inv(t0[i], t0[i]); sink = t0[i][0]; break;
-        case 7: f_sqrt(t0[i], t0[i]); sink = t0[i][0]; break;
+        case 4: mp_mul(t0[i], t1[i], t); sink = t[WORDS_FIELD]; break;
+        case 5: mp_sqr(t0[i], t); sink = t[WORDS_FIELD]; break;
+        case 6: f_mul(t0[i], t1[i], t0[i]); sink = t0[i][0]; break;
+        case 7: f_sqr(t0[i], t0[i]); sink = t0[i][0]; break;
+        case 8: f_leg(t0[i], &s[i]); sink = s[i]; break;
+        case 9: f_inv(t0[i], t0[i]); sink = t0[i][0]; break;
+        case 10: f_sqrt(t0[i], t0[i]); sink = t0[i][0]; break;
+        case VT_SEL + 0: f_leg_vartime(t1[i], &s[i]); sink = s[i]; break;
+        case VT_SEL + 1: f_inv_vartime(t1[i], t); sink = t[0]; break;
+        case VT_SEL + 2: f_sqrt_vartime(t1[i], t); sink = t[0]; break;
+#ifdef RADIX51
+        case F51_SEL + 0: f51_add(u0[i], u1[i], u0[i]); sink = u0[i][0]; break;
+        case F51_SEL + 1: f51_sub(u0[i], u1[i], u0[i]); sink = u0[i][0]; break;
+        case F51_SEL + 2: f51_mul(u0[i], u1[i], u0[i]); sink = u0[i][0]; break;
+        case F51_SEL + 3: f51_sqr(u0[i], u0[i]); sink = u0[i][0]; break;
+        case F51_SEL + 4: f51_inv(u0[i], u0[i]); sink = u0[i][0]; break;
+        case F51_SEL + 5: f51_sqrt(u0[i], u0[i]); sink = u0[i][0]; break;
+#endif
+#if PRIME_ID == P256_0
+        case X4_SEL + 0: f_add_x4(v0[i / 4], v1[i / 4], v2); sink = v2[0][0]; break;
+        case X4_SEL + 1: f_sub_x4(v0[i / 4], v1[i / 4], v2); sink = v2[0][0]; break;
+        case X4_SEL + 2: f_mul_x4(v0[i / 4], v1[i / 4], v0[i / 4]); sink = v0[i / 4][0][0]; break;
+        case X4_SEL + 3: f_sqr_x4(v0[i / 4], v0[i / 4]); sink = v0[i / 4][0][0]; break;
+#endif
+        case X8_SEL + 0: f_mul_x8(w0[i / 8], w1[i / 8], w0[i / 8]); sink = w0[i / 8][0][0]; break;
+        case X8_SEL + 1: f_sqr_x8(w0[i / 8], w0[i / 8]); sink = w0[i / 8][0][0]; break;
+        case MULL_SEL + 0: if(!(i & 1)) f_mul2((const f_elm_t *)&t0[i], (const f_elm_t *)&t1[i], &t0[i]); sink = t0[i][0]; break;
+        case MULL_SEL + 1: if(!(i & 3)) f_mul4((const f_elm_t *)&t0[i], (const f_elm_t *)&t1[i], &t0[i]); sink = t0[i][0]; break;
+        case MULL_SEL + 2: if(!(i & 3)) f_sqr4((const f_elm_t *)&t0[i], &t0[i]); sink = t0[i][0]; break;
+        case CT_SEL + 0: f_table_lookup((const f_elm_t *)t1, 16, i & 15, t0[i]); sink = t0[i][0]; break;
+        case CT_SEL + 1: f_cswap(t0[i], t1[i], t1[i][0] & 1); sink = t0[i][0]; break;
+        case CONST_SEL + 0: f_mul_const(t0[i], &kc, t0[i]); sink = t0[i][0]; break;
+        case CONST_SEL + 1: f_mul_small(t0[i], 121666, t0[i]); sink = t0[i][0]; break;
+        default: break;
+    }
+}
+
+
+// Array kernels are called once per timed batch, the time per element is comparable with the other rows
+static void __attribute__((noinline)) bench_vec(int sel, f_elm_t *t0, f_elm_t* t1, int n){
+    switch (sel) {
+        case VEC_SEL + 0: f_add_vec(t0, t1, t0, n); break;
+        case VEC_SEL + 1: f_sub_vec(t0, t1, t0, n); break;
+        case VEC_SEL + 2: f_mul_vec(t0, t1, t0, n); break;
+        case VEC_SEL + 3: f_sqr_vec(t0, t0, n); break;
+        case VEC_SEL + 4: f_axpy_vec(t1[0], t1, t0, n); break;
+        case VEC_SEL + 5: for(int j = 0; j < n; j += 8) f_inv_batch(t0 + j, t0 + j, n - j < 8 ? n - j : 8, binv); break;
+        case VEC_SEL + 6: for(int j = 0; j < n; j += 64) f_inv_batch(t0 + j, t0 + j, n - j < 64 ? n - j : 64, binv); break;
+        case VEC_SEL + 7: f_inv_batch(t0, t0, n, binv); break;
         default: break;
     }
+    sink = t0[0][0];
+}
+
+
+static void __attribute__((noinline)) bench_soa(int sel, f_elm_t *t0){
+    switch (sel) {
+        case SOA_SEL + 0: f_vec_pack(t0, &sa); break;
+        case SOA_SEL + 1: f_vec_add(&sa, &sb, &sa); break;
+        case SOA_SEL + 2: f_vec_sub(&sa, &sb, &sa); break;
+        case SOA_SEL + 3: f_vec_mul(&sa, &sb, &sa); break;
+        case SOA_SEL + 4: f_vec_select(&sa, &sb, &sa, cond); break;
+        default: break;
+    }
+    sink = sa.data[0];
 }
 
 
 int main(void){
-    const char *function_names[] = {"f_red", "f_add", "f_neg", "f_sub", "f_mul", "f_leg", "f_inv", "f_sqrt"};
+    const char *function_names[] = {"f_red", "f_add", "f_neg", "f_sub", "mp_mul", "mp_sqr", "f_mul", "f_sqr", "f_leg", "f_inv", "f_sqrt"
+                                   , "f_leg_vt", "f_inv_vt", "f_sqrt_vt"
+                                   , "f_add_vec", "f_sub_vec", "f_mul_vec", "f_sqr_vec", "f_axpy_vec"
+                                   , "f_inv_b8", "f_inv_b64", "f_inv_b1000"
+#ifdef RADIX51
+                                   , "f51_add", "f51_sub", "f51_mul", "f51_sqr", "f51_inv", "f51_sqrt"
+#endif
+#if PRIME_ID == P256_0
+                                   , "f_add_x4", "f_sub_x4", "f_mul_x4", "f_sqr_x4"
+#endif
+                                   , "f_mul_x8", "f_sqr_x8"
+                                   , "f_mul2", "f_mul4", "f_sqr4"
+                                   , "f_lookup16", "f_cswap"
+                                   , "f_mul_const", "f_mul_small"
+                                   , "f_vec_pack", "f_vec_add", "f_vec_sub", "f_vec_mul", "f_vec_sel"
+                                   };
     f_elm_t *t0 = NULL, *t1 = NULL;
     unsigned char *s = NULL;
     int result = 0;
@@ -67,6 +186,34 @@ int main(void){
     t1 = malloc(BENCH_LOOPS * sizeof(f_elm_t));
     s = calloc(BENCH_LOOPS, sizeof(unsigned char));
 
+#ifdef RADIX51
+    u0 = malloc(BENCH_LOOPS * sizeof(f51_elm_t));
+    u1 = malloc(BENCH_LOOPS * sizeof(f51_elm_t));
+    if (!u0 || !u1) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        result = 1;
+        goto cleanup;
+    }
+#endif
+
+    w0 = malloc(BENCH_LOOPS / 8 * sizeof(f_elm_x8_t));
+    w1 = malloc(BENCH_LOOPS / 8 * sizeof(f_elm_x8_t));
+    if (!w0 || !w1 || f_vec_init(&sa, BATCH) || f_vec_init(&sb, BATCH)) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        result = 1;
+        goto cleanup;
+    }
+
+#if PRIME_ID == P256_0
+    v0 = malloc(BENCH_LOOPS / 4 * sizeof(f_elm_x4_t));
+    v1 = malloc(BENCH_LOOPS / 4 * sizeof(f_elm_x4_t));
+    if (!v0 || !v1) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        result = 1;
+        goto cleanup;
+    }
+#endif
+
     if (!t0 || !t1 || !s) {
         fprintf(stderr, "Error: Memory allocation failed\n");
         result = 1;
@@ -77,7 +224,26 @@ int main(void){
     for(int i = 0; i < BENCH_LOOPS; i++){
         f_rand(t0[i]);
         f_rand(t1[i]);
+#ifdef RADIX51
+        f51_unpack(t0[i], u0[i]);
+        f51_unpack(t1[i], u1[i]);
+#endif
+    }
+    for(int i = 0; i + 8 <= BENCH_LOOPS; i += 8){
+        to_mont_x8((const f_elm_t *)&t0[i], w0[i / 8]);
+        to_mont_x8((const f_elm_t *)&t1[i], w1[i / 8]);
+    }
+    f_const_prepare(t1[0], &kc);
+    f_vec_pack((const f_elm_t *)t0, &sa);
+    f_vec_pack((const f_elm_t *)t1, &sb);
+    for(int i = 0; i < BATCH; i++)
+        cond[i] = t1[i][0] & 1;
+#if PRIME_ID == P256_0
+    for(int i = 0; i < BENCH_LOOPS; i += 4){
+        f_pack_x4((const f_elm_t *)&t0[i], v0[i / 4]);
+        f_pack_x4((const f_elm_t *)&t1[i], v1[i / 4]);
     }
+#endif
 
     // WARMUP
     for(int i = 0; i < WARMUP; i++){
@@ -86,23 +252,39 @@ int main(void){
 
     // BENCHMARKING
     const char *prime_names[] = {"p64_0", "p64_1", "p128_0", "p128_1", "p192_0", "p192_1", "p256_0", "p256_1", "p512_0", "p512_1"};
-    printf("Benchmarking %s\n\n", prime_names[PRIME_ID]);
+    printf("Benchmarking %s\n", prime_names[PRIME_ID]);
+#ifdef RUNTIME_DISPATCH
+    printf("Backend: %s\n", f_backend_name());
+#endif
+#ifdef KARATSUBA_THRESHOLD
+    if (WORDS_FIELD == 8)
+        printf("mp_mul/mp_sqr: %s (KARATSUBA_THRESHOLD = %d)\n",
+               KARATSUBA_THRESHOLD > 8 ? "schoolbook" : KARATSUBA_THRESHOLD > 4 ? "one-level Karatsuba" : "two-level Karatsuba", KARATSUBA_THRESHOLD);
+#endif
+    printf("\n");
 
-    for(int sel = 0; sel < 8; sel++){
+    int num_funs = sizeof(function_names) / sizeof(function_names[0]);
+    for(int sel = 0; sel < num_funs; sel++){
         uint64_t total_ns = 0;
         
         for(int i = 0; i < BENCH_LOOPS; i += BATCH){
             int batch_end = (i + BATCH <= BENCH_LOOPS) ? i + BATCH : BENCH_LOOPS;
             uint64_t time_start = get_time_ns();
-            for(int j = i; j < batch_end; j++){
-                bench_fun(sel, t0, t1, s, j);
-            }
+            if(sel >= VEC_SEL && sel < F51_SEL)
+                bench_vec(sel, &t0[i], &t1[i], batch_end - i);
+            else if(sel >= SOA_SEL)
+                bench_soa(sel, &t0[i]);
+            else
+                for(int j = i; j < batch_end; j++){
+                    bench_fun(sel, t0, t1, s, j);
+                }
             uint64_t time_end = get_time_ns();
             total_ns += (time_end - time_start);
         }
         
-        uint64_t avg_ns = total_ns / BENCH_LOOPS;
-        printf("%-8s %9s ns/op\n", function_names[sel], format_number(avg_ns));
+        // Tenths of a nanosecond, the array kernels of the single-word fields take less than one
+        uint64_t avg_ns10 = 10 * total_ns / BENCH_LOOPS;
+        printf("%-11s %9s.%u ns/op\n", function_names[sel], format_number(avg_ns10 / 10), (unsigned)(avg_ns10 % 10));
     }
     printf("\n");
 
@@ -110,5 +292,17 @@ cleanup:
     free(t0);
     free(t1);
     free(s);
+#ifdef RADIX51
+    free(u0);
+    free(u1);
+#endif
+    free(w0);
+    free(w1);
+    f_vec_free(&sa);
+    f_vec_free(&sb);
+#if PRIME_ID == P256_0
+    free(v0);
+    free(v1);
+#endif
     return result;
 }
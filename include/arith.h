@@ -53,6 +53,12 @@ uint8_t f_neq(const f_elm_t a, const f_elm_t b);
 // Conditional select of two field elements
 void cond_select(const f_elm_t a, const f_elm_t b, f_elm_t c, uint8_t cond);
 
+// Constant-time table lookup, out = table[idx], every entry is read, out = 0 if idx >= n
+void f_table_lookup(const f_elm_t* table, const unsigned int n, const unsigned int idx, f_elm_t out);
+
+// Constant-time conditional swap of two field elements, cond in {0, 1}
+void f_cswap(f_elm_t a, f_elm_t b, const uint8_t cond);
+
 // Copy a field element
 void f_copy(const f_elm_t a, f_elm_t b);
 
@@ -85,22 +91,193 @@ void mp_mul(const digit_t* a, const digit_t* b, digit_t* c);
 // Montgomery form reduction after multiplication
 void mont_redc(const digit_t* a, digit_t* c);
 
+// Reduction of a double-width product into canonical form (SPECIAL_FORM_REDUCTION, SOLINAS_REDUCTION, BARRETT_REDUCTION)
+void mp_red(const digit_t* a, digit_t* c);
+
 // Multiplication of field elements
 void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c);
 
+// Squaring of a multiprecision word (without reduction)
+void mp_sqr(const digit_t* a, digit_t* c);
+
+// Squaring of a field element
+void f_sqr(const f_elm_t a, f_elm_t c);
+
+// Multiplication of n pairs of field elements, c[i] = a[i] * b[i]
+void f_mul_vec(const f_elm_t* a, const f_elm_t* b, f_elm_t* c, const unsigned int n);
+
+// Squaring of n field elements, c[i] = a[i]^2
+void f_sqr_vec(const f_elm_t* a, f_elm_t* c, const unsigned int n);
+
+// Addition of n pairs of field elements, c[i] = a[i] + b[i]
+void f_add_vec(const f_elm_t* a, const f_elm_t* b, f_elm_t* c, const unsigned int n);
+
+// Subtraction of n pairs of field elements, c[i] = a[i] - b[i]
+void f_sub_vec(const f_elm_t* a, const f_elm_t* b, f_elm_t* c, const unsigned int n);
+
+// Scaled accumulation of n field elements, y[i] = y[i] + alpha * x[i]
+void f_axpy_vec(const f_elm_t alpha, const f_elm_t* x, f_elm_t* y, const unsigned int n);
+
+// Clear an accumulator
+void acc_zero(acc_t acc);
+
+// Accumulate a product without reduction, acc = acc + a*b
+void acc_muladd(acc_t acc, const f_elm_t a, const f_elm_t b);
+
+// Accumulate a negated product without reduction, acc = acc - a*b
+void acc_mulsub(acc_t acc, const f_elm_t a, const f_elm_t b);
+
+// Reduce an accumulator into a field element, a single mont_redc (or mp_red) for the whole sum
+void acc_reduce(const acc_t acc, f_elm_t c);
+
+// Dot product of field elements with a single reduction, c = a[0]*b[0] + ... + a[n-1]*b[n-1]
+void f_dot(const unsigned int n, const f_elm_t* a, const f_elm_t* b, f_elm_t c);
+
+// Inversion of n field elements, out[i] = in[i]^(-1) and 0 for in[i] = 0, with 3(n-1) multiplications and one f_inv
+// scratch holds n elements and overlaps neither in nor out, out may equal in
+void f_inv_batch(const f_elm_t* in, f_elm_t* out, const unsigned int n, f_elm_t* scratch);
+
+// Two independent multiplications with interleaved carry chains, c[l] = a[l] * b[l]
+void f_mul2(const f_elm_t a[2], const f_elm_t b[2], f_elm_t c[2]);
+
+// Four independent multiplications with interleaved carry chains, c[l] = a[l] * b[l]
+void f_mul4(const f_elm_t a[4], const f_elm_t b[4], f_elm_t c[4]);
+
+// Two independent squarings with interleaved carry chains, c[l] = a[l]^2
+void f_sqr2(const f_elm_t a[2], f_elm_t c[2]);
+
+// Four independent squarings with interleaved carry chains, c[l] = a[l]^2
+void f_sqr4(const f_elm_t a[4], f_elm_t c[4]);
+
+// Precompute the Shoup quotient of a fixed multiplier c
+void f_const_prepare(const f_elm_t c, f_const_t* k);
+
+// Multiplication by a prepared constant, same value as f_mul(a, k->c)
+void f_mul_const(const f_elm_t a, const f_const_t* k, f_elm_t c);
+
+// Multiplication by a small integer, c = a * k mod p in the form of a
+void f_mul_small(const f_elm_t a, const uint64_t k, f_elm_t c);
+
+// Eight Montgomery multiplications in radix 2^52, AVX-512 IFMA when the CPU supports it
+void f_mul_x8(const f_elm_x8_t a, const f_elm_x8_t b, f_elm_x8_t c);
+
+// Eight Montgomery squarings in radix 2^52
+void f_sqr_x8(const f_elm_x8_t a, f_elm_x8_t c);
+
+// Convert eight numbers into the Montgomery domain of the x8 kernels
+void to_mont_x8(const f_elm_t a[8], f_elm_x8_t b);
+
+// Convert eight numbers from the Montgomery domain of the x8 kernels into canonical values
+void from_mont_x8(const f_elm_x8_t a, f_elm_t b[8]);
+
+// Allocate a zeroed structure-of-arrays vector of n field elements, 0 on success
+int f_vec_init(f_vec_t* v, const unsigned int n);
+
+// Release the storage of a vector
+void f_vec_free(f_vec_t* v);
+
+// Transpose v->n field elements into a vector
+void f_vec_pack(const f_elm_t* a, f_vec_t* v);
+
+// Transpose a vector back into v->n field elements
+void f_vec_unpack(const f_vec_t* v, f_elm_t* a);
+
+// Addition of two vectors, c[k] = a[k] + b[k]
+void f_vec_add(const f_vec_t* a, const f_vec_t* b, f_vec_t* c);
+
+// Subtraction of two vectors, c[k] = a[k] - b[k]
+void f_vec_sub(const f_vec_t* a, const f_vec_t* b, f_vec_t* c);
+
+// Multiplication of two vectors, c[k] = a[k] * b[k]
+void f_vec_mul(const f_vec_t* a, const f_vec_t* b, f_vec_t* c);
+
+// Squaring of a vector, c[k] = a[k]^2
+void f_vec_sqr(const f_vec_t* a, f_vec_t* c);
+
+// Selection between two vectors, c[k] = cond[k] ? b[k] : a[k] with cond[k] in {0, 1}
+void f_vec_select(const f_vec_t* a, const f_vec_t* b, f_vec_t* c, const uint8_t* cond);
+
+#ifdef RADIX51
+// Convert a 4x64 integer below 2^256 into radix 2^51
+void f51_unpack(const f_elm_t a, f51_elm_t b);
+
+// Convert a radix 2^51 element into its canonical 4x64 value
+void f51_pack(const f51_elm_t a, f_elm_t b);
+
+// Addition in radix 2^51, without carries
+void f51_add(const f51_elm_t a, const f51_elm_t b, f51_elm_t c);
+
+// Subtraction in radix 2^51, without carries
+void f51_sub(const f51_elm_t a, const f51_elm_t b, f51_elm_t c);
+
+// Multiplication in radix 2^51
+void f51_mul(const f51_elm_t a, const f51_elm_t b, f51_elm_t c);
+
+// Squaring in radix 2^51
+void f51_sqr(const f51_elm_t a, f51_elm_t c);
+
+// Multiplicative inverse in radix 2^51
+void f51_inv(const f51_elm_t a, f51_elm_t b);
+
+// Square root in radix 2^51
+void f51_sqrt(const f51_elm_t a, f51_elm_t b);
+#endif
+
+#if PRIME_ID == P256_0
+// Convert four field elements into the 4-way vector layout
+void f_pack_x4(const f_elm_t a[4], f_elm_x4_t b);
+
+// Convert the 4-way vector layout into four field elements
+void f_unpack_x4(const f_elm_x4_t a, f_elm_t b[4]);
+
+// 4-way addition, without carries
+void f_add_x4(const f_elm_x4_t a, const f_elm_x4_t b, f_elm_x4_t c);
+
+// 4-way subtraction, without carries
+void f_sub_x4(const f_elm_x4_t a, const f_elm_x4_t b, f_elm_x4_t c);
+
+// 4-way multiplication, AVX2 when the CPU supports it
+void f_mul_x4(const f_elm_x4_t a, const f_elm_x4_t b, f_elm_x4_t c);
+
+// 4-way squaring, AVX2 when the CPU supports it
+void f_sqr_x4(const f_elm_x4_t a, f_elm_x4_t c);
+#endif
+
+#if PRIME_ID == P512_1
+// Squaring in Fp[x]/(x^2 - w) for the Cipolla square root, a = a[0] + a[1]*x with a[2] = a[1]^2 * w, b likewise
+void fp_2_sqr(const f_elm_t a[3], f_elm_t b[3]);
+
+// Multiplication in Fp[x]/(x^2 - w), c = a * b with c[2] = c[1]^2 * w
+void fp_2_mul(const f_elm_t a[3], const f_elm_t b[3], f_elm_t c[3], const f_elm_t w);
+#endif
+
 // Convert a number from value to Montgomery form  (a -> aR)
 void to_mont(const digit_t* a, f_elm_t b);
 
 // Convert a number from Montgomery form into value (aR -> a)
 void from_mont(const f_elm_t a, digit_t* b);
 
-// Multiplicative inverse of a field element
+// Multiplicative inverse of a field element, 0 for a = 0
+// Constant-time safegcd (src/safegcd), the exponentiation chains of the backends with FERMAT_INVERSION
 void f_inv(const f_elm_t a, f_elm_t b);
 
-// Legendre symbol of a field element
+// Legendre symbol of a field element, 1 for a non-square and 0 otherwise
+// Constant-time binary GCD (src/jacobi), the exponentiation chains of the backends with EULER_LEGENDRE
 void f_leg(const f_elm_t a, unsigned char *b);
 
+// Jacobi symbol of a field element, 1 for a non-zero square, -1 for a non-square and 0 for zero
+int f_jacobi(const f_elm_t a);
+
 // Square root of a field element
 void f_sqrt(const f_elm_t a, f_elm_t b);
 
+// Variable-time versions for public inputs only, the running time depends on the value of a
+// Inverse with safegcd (src/safegcd), Jacobi and Legendre symbols with the binary GCD (src/jacobi)
+void f_inv_vartime(const f_elm_t a, f_elm_t b);
+int f_jacobi_vartime(const f_elm_t a);
+void f_leg_vartime(const f_elm_t a, unsigned char *b);
+
+// Square root with f_sqrt, returns 0 and b = 0 without running it when a is not a square
+int f_sqrt_vartime(const f_elm_t a, f_elm_t b);
+
 #endif
\ No newline at end of file
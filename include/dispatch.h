@@ -0,0 +1,50 @@
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include "parameters.h"
+
+
+// CPU features used by the kernels
+#define CPU_BMI2_ADX        0x1     // mulx/adcx/adox, the x86-64 assembly backend
+#define CPU_AVX2            0x2     // array kernels of p64_0/p64_1, 4-way kernels of p256_0
+#define CPU_AVX512_IFMA     0x4     // 8-way kernels
+
+// Features of the CPU, probed once and restricted by the FF_DISPATCH environment variable
+// FF_DISPATCH is a comma-separated list of the features to use (bmi2, avx2, avx512ifma), "generic" for none
+unsigned int cpu_features(void);
+
+
+#ifdef RUNTIME_DISPATCH
+// Field operations of one backend, in the order of BACKEND_TABLE (src/dispatch/backend.h)
+typedef struct {
+    const char *name;
+    unsigned int features;          // CPU features the backend needs
+    void (*f_red)(f_elm_t a);
+    void (*f_rand)(f_elm_t a);
+    void (*f_add)(const f_elm_t a, const f_elm_t b, f_elm_t c);
+    void (*f_sub)(const f_elm_t a, const f_elm_t b, f_elm_t c);
+    void (*f_neg)(const f_elm_t a, f_elm_t b);
+    void (*mp_mul)(const digit_t *a, const digit_t *b, digit_t *c);
+    void (*mont_redc)(const digit_t *a, digit_t *c);
+    void (*f_mul)(const f_elm_t a, const f_elm_t b, f_elm_t c);
+    void (*mp_sqr)(const digit_t *a, digit_t *c);
+    void (*f_sqr)(const f_elm_t a, f_elm_t c);
+    void (*to_mont)(const digit_t *a, f_elm_t b);
+    void (*from_mont)(const f_elm_t a, digit_t *b);
+    void (*f_sqrt)(const f_elm_t a, f_elm_t b);
+#ifdef FERMAT_INVERSION
+    void (*f_inv)(const f_elm_t a, f_elm_t b);      // Otherwise f_inv is the shared safegcd inversion
+#endif
+#ifdef EULER_LEGENDRE
+    void (*f_leg)(const f_elm_t a, unsigned char *b);       // Otherwise f_leg is the shared binary GCD
+#endif
+} f_backend_t;
+
+extern const f_backend_t f_backend_generic;
+extern const f_backend_t f_backend_x86;
+
+// Name of the backend picked at load time
+const char *f_backend_name(void);
+#endif
+
+#endif
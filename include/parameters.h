@@ -28,6 +28,7 @@
 typedef uint64_t        digit_t;        // Unsigned 64-bit digit
 typedef uint32_t        hdigit_t;       // Unsigned 32-bit digit
 typedef unsigned uint128_t __attribute__((mode(TI)));
+typedef int int128_t __attribute__((mode(TI)));
 
 // Derive field size from PRIME_ID
 #if (PRIME_ID == P64_0 || PRIME_ID == P64_1)
@@ -55,6 +56,25 @@ typedef unsigned uint128_t __attribute__((mode(TI)));
 #endif
 
 typedef digit_t f_elm_t[WORDS_FIELD];
+typedef digit_t acc_t[2 * WORDS_FIELD];     // Double-width accumulator, same layout as the output of mp_mul
+#define WORDS52_FIELD   ((NBITS_FIELD + 2 + 51) / 52)
+typedef digit_t f_elm_x8_t[WORDS52_FIELD][8];   // Eight elements in radix 2^52, limb-major with one lane per element
+typedef struct {
+    digit_t *data;                          // Limb i of element k at data[i*stride + k], 64-byte aligned
+    unsigned int n;                         // Number of elements
+    unsigned int stride;                    // n rounded up to a multiple of 8, the lanes past n are zero
+} f_vec_t;                                  // Structure-of-arrays vector of field elements
+typedef struct {
+    f_elm_t c;                              // The multiplier as a field element
+    f_elm_t w;                              // Its plain value in [0, p), f_mul(a, c) = a*w mod p
+    f_elm_t wq;                             // Shoup quotient floor(w * 2^(64*WORDS_FIELD) / p)
+} f_const_t;                                // Fixed multiplier prepared for f_mul_const
+#ifdef RADIX51
+typedef digit_t f51_elm_t[5];               // p256_0 element in unsaturated radix 2^51 (USE_RADIX51)
+#endif
+#if PRIME_ID == P256_0
+typedef digit_t f_elm_x4_t[10][4];          // Four p256_0 elements in radix 2^25.5, limb-major with one lane per element
+#endif
 
 // Prime-specific constants (defined in each p*_*/prime_params.c)
 extern const digit_t p[WORDS_FIELD];         // Field order p
@@ -65,6 +85,41 @@ extern const digit_t pp[WORDS_FIELD];        // pp = -p^(-1) mod R
 extern const digit_t ip[WORDS_FIELD];        // ip = p^(-1) mod R
 extern const digit_t Zero[WORDS_FIELD];      // Zero
 extern const digit_t One[WORDS_FIELD];       // One
+extern const digit_t mu[WORDS_FIELD + 1];    // mu = floor(2^(128*WORDS_FIELD) / p), Barrett constant
+
+// With SPECIAL_FORM_REDUCTION the primes of the form 2^k - c keep elements in canonical form
+// The Mersenne primes keep products in [0, 2^k) and correct them lazily (0 may be represented by p)
+#if defined(SPECIAL_FORM_REDUCTION) && (PRIME_ID == P64_0 || PRIME_ID == P128_0)
+    #define MERSENNE_FORM
+#endif
+
+// With SOLINAS_REDUCTION the Solinas primes p256_1 and p512_0 keep elements in canonical form
+// With BARRETT_REDUCTION every prime without one of these reductions keeps elements in canonical form as well
+#if (defined(SPECIAL_FORM_REDUCTION) && (PRIME_ID == P64_0 || PRIME_ID == P64_1 || PRIME_ID == P128_0 || PRIME_ID == P128_1 || PRIME_ID == P192_0 || PRIME_ID == P192_1 || PRIME_ID == P256_0)) || \
+    (defined(SOLINAS_REDUCTION) && (PRIME_ID == P256_1 || PRIME_ID == P512_0))
+    #define CANONICAL_FORM
+#elif defined(BARRETT_REDUCTION)
+    #define CANONICAL_FORM
+    #define BARRETT_FORM
+#endif
+
+#ifdef CANONICAL_FORM
+    #define F_ONE       One                  // Multiplicative identity
+#else
+    #define F_ONE       Mont_one             // Multiplicative identity
+#endif
+
+// With LAZY_REDUCTION the primes with a spare top bit keep every element in [0, 2p) instead of [0, p)
+// f_add, f_sub and f_neg skip the final correction, f_eq, f_neq, f_leg and from_mont canonicalise
+#if defined(LAZY_REDUCTION) && (PRIME_ID == P64_0 || PRIME_ID == P128_0 || PRIME_ID == P192_1 || PRIME_ID == P256_0 || PRIME_ID == P512_1)
+    #define REDUNDANT_FORM
+#endif
+
+// f_inv is the constant-time safegcd inversion of src/safegcd, FERMAT_INVERSION keeps the exponentiation chains
+// of the backends. The single-word primes keep them in any case, there the chain is shorter than four safegcd batches.
+#if WORDS_FIELD == 1 && !defined(FERMAT_INVERSION)
+    #define FERMAT_INVERSION
+#endif
 
 
 #endif
@@ -38,6 +38,12 @@ void print_hex(const unsigned char *a, const int nbytes)
 uint8_t f_eq(const f_elm_t a, const f_elm_t b)
 {
     uint8_t t = 0;
+#if defined(MERSENNE_FORM) || defined(REDUNDANT_FORM)
+    f_elm_t ta, tb;                 // Final correction of lazily reduced elements
+    f_copy(a, ta); f_red(ta);
+    f_copy(b, tb); f_red(tb);
+    a = ta; b = tb;
+#endif
     for(unsigned int i = 0; i < NBYTES_FIELD; i++)
         t |= ((uint8_t *)a)[i] ^ ((uint8_t *)b)[i];
 
@@ -48,6 +54,12 @@ uint8_t f_eq(const f_elm_t a, const f_elm_t b)
 uint8_t f_neq(const f_elm_t a, const f_elm_t b)
 {
     uint8_t t = 0;
+#if defined(MERSENNE_FORM) || defined(REDUNDANT_FORM)
+    f_elm_t ta, tb;                 // Final correction of lazily reduced elements
+    f_copy(a, ta); f_red(ta);
+    f_copy(b, tb); f_red(tb);
+    a = ta; b = tb;
+#endif
     for(unsigned int i = 0; i < NBYTES_FIELD; i++)
         t |= ((uint8_t *)a)[i] ^ ((uint8_t *)b)[i];
     
@@ -75,3 +87,466 @@ void f_copy(const f_elm_t a, f_elm_t b)
 
 
 
+// The single-word primes have their own array kernels in src/primes/p64_*/avx2/arith_vec.c
+#if WORDS_FIELD > 1
+#ifndef MERSENNE_FORM
+// Multiplication of n pairs of field elements, c[i] = a[i] * b[i]
+void f_mul_vec(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+    for (unsigned int i = 0; i < n; i++)
+        f_mul(a[i], b[i], c[i]);
+}
+
+// Squaring of n field elements, c[i] = a[i]^2
+void f_sqr_vec(const f_elm_t *a, f_elm_t *c, const unsigned int n)
+{
+    for (unsigned int i = 0; i < n; i++)
+        f_sqr(a[i], c[i]);
+}
+#endif
+
+// Addition of n pairs of field elements, c[i] = a[i] + b[i]
+void f_add_vec(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+    for (unsigned int i = 0; i < n; i++)
+        f_add(a[i], b[i], c[i]);
+}
+
+// Subtraction of n pairs of field elements, c[i] = a[i] - b[i]
+void f_sub_vec(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+    for (unsigned int i = 0; i < n; i++)
+        f_sub(a[i], b[i], c[i]);
+}
+
+// Scaled accumulation, y[i] = y[i] + alpha * x[i]
+void f_axpy_vec(const f_elm_t alpha, const f_elm_t *x, f_elm_t *y, const unsigned int n)
+{
+    f_elm_t t;
+
+    for (unsigned int i = 0; i < n; i++)
+    {
+        f_mul(alpha, x[i], t);
+        f_add(y[i], t, y[i]);
+    }
+}
+#endif
+
+
+
+// Double-width accumulation of products
+// The accumulator is any integer below R^2 that is congruent to the sum of the products, so a carry out of
+// the top word (or a borrow, for acc_mulsub) is folded back in as R^2 = Mont_one*R (mod p). For reduced
+// operands (below 2p with REDUNDANT_FORM) this never carries again, so any number of products can be
+// accumulated for every prime.
+
+void acc_zero(acc_t acc)
+{
+    for (int i = 0; i < 2 * WORDS_FIELD; i++)
+        acc[i] = 0;
+}
+
+
+void acc_muladd(acc_t acc, const f_elm_t a, const f_elm_t b)
+{
+    digit_t t0[2 * WORDS_FIELD], mask, carry = 0;
+
+    mp_mul(a, b, t0);
+
+    for (int i = 0; i < 2 * WORDS_FIELD; i++)
+        ADDC(carry, acc[i], t0[i], acc[i]);
+
+    mask = 0 - carry;
+    carry = 0;
+    for (int i = 0; i < WORDS_FIELD; i++)
+        ADDC(carry, acc[WORDS_FIELD + i], Mont_one[i] & mask, acc[WORDS_FIELD + i]);
+}
+
+
+void acc_mulsub(acc_t acc, const f_elm_t a, const f_elm_t b)
+{
+    digit_t t0[2 * WORDS_FIELD], mask, borrow = 0;
+
+    mp_mul(a, b, t0);
+
+    for (int i = 0; i < 2 * WORDS_FIELD; i++)
+        SUBC(borrow, acc[i], t0[i], acc[i]);
+
+    mask = 0 - borrow;
+    borrow = 0;
+    for (int i = 0; i < WORDS_FIELD; i++)
+        SUBC(borrow, acc[WORDS_FIELD + i], Mont_one[i] & mask, acc[WORDS_FIELD + i]);
+}
+
+
+void acc_reduce(const acc_t acc, f_elm_t c)
+{
+    digit_t t0[2 * WORDS_FIELD] = {0};
+
+#if defined(MERSENNE_FORM)
+    // Fold the high half with R = Mont_one[0] (mod p), which keeps the input of mp_red below 2^(2k)
+    uint128_t uv = 0;
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+    {
+        uv = (uint128_t)acc[WORDS_FIELD + i] * Mont_one[0] + acc[i] + (digit_t)(uv >> RADIX);
+        t0[i] = (digit_t)uv;
+    }
+    t0[WORDS_FIELD] = (digit_t)(uv >> RADIX);
+    mp_red(t0, c);
+#elif defined(CANONICAL_FORM)
+    for (int i = 0; i < 2 * WORDS_FIELD; i++)
+        t0[i] = acc[i];
+    mp_red(t0, c);
+#else
+    // mont_redc needs acc < p*R, reducing the high half modulo p is enough
+    for (int i = 0; i < 2 * WORDS_FIELD; i++)
+        t0[i] = acc[i];
+    f_red(t0 + WORDS_FIELD);
+    mont_redc(t0, c);
+#endif
+}
+
+
+// Dot product of field elements with a single reduction
+void f_dot(const unsigned int n, const f_elm_t *a, const f_elm_t *b, f_elm_t c)
+{
+    acc_t acc = {0};
+
+    for (unsigned int i = 0; i < n; i++)
+        acc_muladd(acc, a[i], b[i]);
+
+    acc_reduce(acc, c);
+}
+
+
+// Inversion of n field elements with Montgomery's trick, 3(n-1) multiplications and a single f_inv
+// The running products go to scratch (n elements, neither in nor out), out may equal in. A zero input is replaced by 1
+// in the products and its output is cleared, with masks, so it does not spoil the other inverses or the timing.
+void f_inv_batch(const f_elm_t *in, f_elm_t *out, const unsigned int n, f_elm_t *scratch)
+{
+    f_elm_t x, t, inv;
+    uint8_t nz;
+
+    if (n == 0)
+        return;
+
+    // scratch[i] = x[0] * ... * x[i], x[i] = 1 for a zero input
+    nz = f_eq(in[0], Zero);
+    cond_select(F_ONE, in[0], scratch[0], nz);
+    for (unsigned int i = 1; i < n; i++)
+    {
+        cond_select(F_ONE, in[i], x, f_eq(in[i], Zero));
+        f_mul(scratch[i - 1], x, scratch[i]);
+    }
+
+    f_inv(scratch[n - 1], inv);
+
+    // inv = (x[0] * ... * x[i])^(-1) on entry, in[i] is read before out[i] is written
+    for (unsigned int i = n - 1; i > 0; i--)
+    {
+        nz = f_eq(in[i], Zero);
+        cond_select(F_ONE, in[i], x, nz);
+        f_mul(inv, scratch[i - 1], t);
+        f_mul(inv, x, inv);
+        cond_select(Zero, t, out[i], nz);
+    }
+    nz = f_eq(in[0], Zero);
+    cond_select(Zero, inv, out[0], nz);
+}
+
+
+
+// Multi-buffer multiplication
+// L independent products are computed side by side: every step of one lane is followed by the same step of the
+// other lanes, so their carry chains overlap instead of waiting on each other. Montgomery form uses product scanning
+// with one final subtraction (the result is below 2p with lazy reduction), the canonical forms interleave the schoolbook
+// product and reduce each lane with mp_red. All loops are unrolled so the lanes stay in registers. From 512 bits on the
+// unrolled lanes no longer fit the register file and the products are left to f_mul, one after the other.
+// Squarings go through the same loops with b = a.
+// The ARM64 backends have a two-lane kernel per prime in assembly (arm64/arith_arm*_mul2.S, from tools/mullanes.py),
+// which runs the same product scanning on both lanes with the loads and multiplications of the lanes alternating.
+// Four lanes take two calls, the accumulators of four lanes do not fit the registers.
+
+#define MUL_LANES_MAX_WORDS  6
+
+#ifdef ARM_OPTIMIZATIONS
+extern void f_mul2_asm(const digit_t *a, const digit_t *b, digit_t *c);
+#endif
+
+static inline __attribute__((always_inline)) void f_mul_lanes(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const int L)
+{
+#if defined(ARM_OPTIMIZATIONS)
+    for (int l = 0; l < L; l += 2)
+        f_mul2_asm(a[l], b[l], c[l]);
+#elif WORDS_FIELD > MUL_LANES_MAX_WORDS
+    for (int l = 0; l < L; l++)
+        f_mul(a[l], b[l], c[l]);
+#elif defined(CANONICAL_FORM)
+    digit_t t[4][2 * WORDS_FIELD];
+    uint128_t uv[4];
+
+    #pragma GCC unroll 16
+    for (int i = 0; i < WORDS_FIELD; i++)
+    {
+        // t = t + a*b[i]*2^(64i)
+        #pragma GCC unroll 4
+        for (int l = 0; l < L; l++)
+            uv[l] = 0;
+        #pragma GCC unroll 16
+        for (int j = 0; j < WORDS_FIELD; j++)
+            #pragma GCC unroll 4
+            for (int l = 0; l < L; l++)
+            {
+                uv[l] = (uint128_t)a[l][j] * b[l][i] + (i ? t[l][i + j] : 0) + (digit_t)(uv[l] >> RADIX);
+                t[l][i + j] = (digit_t)uv[l];
+            }
+        #pragma GCC unroll 4
+        for (int l = 0; l < L; l++)
+            t[l][i + WORDS_FIELD] = (digit_t)(uv[l] >> RADIX);
+    }
+
+    #pragma GCC unroll 4
+    for (int l = 0; l < L; l++)
+        mp_red(t[l], c[l]);
+#else
+    digit_t m[4][WORDS_FIELD], r[4][WORDS_FIELD + 1], top[4] = {0}, mask[4], carry[4];
+    uint128_t acc[4] = {0}, uv;
+
+    // Column k collects a[j]*b[k-j] and m[j]*p[k-j] into a three-word accumulator
+    #pragma GCC unroll 16
+    for (int k = 0; k < 2 * WORDS_FIELD - 1; k++)
+    {
+        #pragma GCC unroll 16
+        for (int j = (k < WORDS_FIELD ? 0 : k - WORDS_FIELD + 1); j <= (k < WORDS_FIELD ? k : WORDS_FIELD - 1); j++)
+            #pragma GCC unroll 4
+            for (int l = 0; l < L; l++)
+            {
+                uv = (uint128_t)a[l][j] * b[l][k - j];
+                acc[l] += uv;
+                top[l] += (acc[l] < uv);
+                if (j < k)
+                {
+                    uv = (uint128_t)m[l][j] * p[k - j];
+                    acc[l] += uv;
+                    top[l] += (acc[l] < uv);
+                }
+            }
+        #pragma GCC unroll 4
+        for (int l = 0; l < L; l++)
+        {
+            if (k < WORDS_FIELD)
+            {
+                m[l][k] = (digit_t)acc[l] * pp[0];          // the low word of acc + m*p[0] is zero
+                uv = (uint128_t)m[l][k] * p[0];
+                acc[l] += uv;
+                top[l] += (acc[l] < uv);
+            }
+            else
+                r[l][k - WORDS_FIELD] = (digit_t)acc[l];
+            acc[l] = (acc[l] >> RADIX) | ((uint128_t)top[l] << RADIX);
+            top[l] = 0;
+        }
+    }
+    #pragma GCC unroll 4
+    for (int l = 0; l < L; l++)
+    {
+        r[l][WORDS_FIELD - 1] = (digit_t)acc[l];
+        r[l][WORDS_FIELD] = (digit_t)(acc[l] >> RADIX);
+    }
+
+    // Subtract p and add it back if that borrows
+    #pragma GCC unroll 4
+    for (int l = 0; l < L; l++)
+        carry[l] = 0;
+    #pragma GCC unroll 16
+    for (int i = 0; i < WORDS_FIELD; i++)
+        #pragma GCC unroll 4
+        for (int l = 0; l < L; l++)
+            SUBC(carry[l], r[l][i], p[i], r[l][i]);
+    #pragma GCC unroll 4
+    for (int l = 0; l < L; l++)
+    {
+        SUBC(carry[l], r[l][WORDS_FIELD], 0, mask[l]);
+        carry[l] = 0;
+    }
+    #pragma GCC unroll 16
+    for (int i = 0; i < WORDS_FIELD; i++)
+        #pragma GCC unroll 4
+        for (int l = 0; l < L; l++)
+            ADDC(carry[l], r[l][i], p[i] & mask[l], c[l][i]);
+#endif
+}
+
+
+// Two independent multiplications, c[l] = a[l] * b[l]
+void f_mul2(const f_elm_t a[2], const f_elm_t b[2], f_elm_t c[2])
+{
+    f_mul_lanes(a, b, c, 2);
+}
+
+
+// Four independent multiplications, c[l] = a[l] * b[l]
+void f_mul4(const f_elm_t a[4], const f_elm_t b[4], f_elm_t c[4])
+{
+    f_mul_lanes(a, b, c, 4);
+}
+
+
+// Two independent squarings, c[l] = a[l]^2
+void f_sqr2(const f_elm_t a[2], f_elm_t c[2])
+{
+    f_mul_lanes(a, a, c, 2);
+}
+
+
+// Four independent squarings, c[l] = a[l]^2
+void f_sqr4(const f_elm_t a[4], f_elm_t c[4])
+{
+    f_mul_lanes(a, a, c, 4);
+}
+
+
+
+// Multiplication by constants
+// f_const_prepare keeps the plain value w = f_mul(c, 1) of the multiplier, so that f_mul(a, c) = a*w mod p in every form,
+// and its Shoup quotient wq = floor(w * 2^(64W) / p). With q = floor(a*wq / 2^(64W)) the remainder a*w - q*p is in [0, 2p)
+// for any a below 2^64, two multiplications and one subtraction of p instead of the reduction of f_mul. Only the one-word
+// fields use it: with two words and more the quotient costs more multiplications than the Montgomery or special-form
+// reduction it replaces, and f_mul_const multiplies by c through f_mul.
+// f_mul_small estimates the quotient of a*k by p as a*k >> nbits(p), which is short by less than k*(2^nbits - p)/2^nbits + 1.
+// For the primes here that error is below 2 unless k is large, then one round and one subtraction of p reduce a*k.
+// Otherwise two rounds and two subtractions reduce it exactly, for every prime and every 64-bit k.
+
+// a = a - p if a >= p, a has n >= WORDS_FIELD words
+static inline void mp_csub_p(digit_t *a, const int n)
+{
+    digit_t t[WORDS_FIELD + 1], borrow = 0, mask;
+
+    for (int i = 0; i < n; i++)
+        SUBC(borrow, a[i], (i < WORDS_FIELD ? p[i] : 0), t[i]);
+    mask = 0 - borrow;                      // keep a if a < p
+    for (int i = 0; i < n; i++)
+        a[i] = (a[i] & mask) | (t[i] & ~mask);
+}
+
+
+void f_const_prepare(const f_elm_t c, f_const_t *k)
+{
+    digit_t r[WORDS_FIELD + 1], t[WORDS_FIELD + 1], borrow, mask;
+
+    f_copy(c, k->c);
+    f_mul(c, One, k->w);                    // c*R^(-1), c itself in the canonical forms
+    f_red(k->w);
+
+    // Long division of w * 2^(64W) by p, one quotient bit per step, the remainder stays below p
+    for (int i = 0; i < WORDS_FIELD; i++)
+    {
+        r[i] = k->w[i];
+        k->wq[i] = 0;
+    }
+    r[WORDS_FIELD] = 0;
+    for (int i = 64 * WORDS_FIELD - 1; i >= 0; i--)
+    {
+        for (int j = WORDS_FIELD; j > 0; j--)
+            r[j] = (r[j] << 1) | (r[j - 1] >> 63);
+        r[0] <<= 1;
+        borrow = 0;
+        for (int j = 0; j < WORDS_FIELD; j++)
+            SUBC(borrow, r[j], p[j], t[j]);
+        SUBC(borrow, r[WORDS_FIELD], 0, t[WORDS_FIELD]);
+        mask = borrow - 1;                  // 2r >= p
+        for (int j = 0; j <= WORDS_FIELD; j++)
+            r[j] = (t[j] & mask) | (r[j] & ~mask);
+        k->wq[i >> 6] |= (mask & 1) << (i & 63);
+    }
+}
+
+
+// Multiplication by a prepared constant, the value of f_mul(a, k->c)
+void f_mul_const(const f_elm_t a, const f_const_t *k, f_elm_t c)
+{
+#if WORDS_FIELD == 1
+    digit_t q = (digit_t)(((uint128_t)a[0] * k->wq[0]) >> RADIX), lo, hi, t, borrow = 0, mask;
+    uint128_t r = (uint128_t)a[0] * k->w[0] - (uint128_t)q * p[0];     // in [0, 2p)
+
+    lo = (digit_t)r;
+    hi = (digit_t)(r >> RADIX);
+    SUBC(borrow, lo, p[0], t);
+    mask = 0 - (borrow & (1 - hi));         // keep r if r < p
+    c[0] = (lo & mask) | (t & ~mask);
+#else
+    f_mul(a, k->c, c);
+#endif
+}
+
+
+// Bit length of 2^nbits - p, found once
+static int small_cbits = -1;
+
+static void f_mul_small_init(void)
+{
+    const int s = __builtin_clzll(p[WORDS_FIELD - 1]);
+    digit_t c[WORDS_FIELD], borrow = 0;
+    int bits = 0;
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+        SUBC(borrow, 0, p[i], c[i]);
+    c[WORDS_FIELD - 1] &= (digit_t)-1 >> s;
+    for (int i = 0; i < WORDS_FIELD; i++)
+        if (c[i])
+            bits = 64 * i + 64 - __builtin_clzll(c[i]);
+    small_cbits = bits;
+}
+
+
+// Multiplication by a small integer, c = a*k mod p in [0, p)
+// Multiplying by an integer commutes with the Montgomery factor, so the result is in the form of a
+// A single round is enough when k*(2^nbits - p) < 2^nbits, which the bit lengths of k and 2^nbits - p decide
+void f_mul_small(const f_elm_t a, const uint64_t k, f_elm_t c)
+{
+    digit_t t[WORDS_FIELD + 1], u[WORDS_FIELD + 1], q, carry = 0, borrow;
+    const int s = __builtin_clzll(p[WORDS_FIELD - 1]);      // p < 2^nbits, nbits = 64W - s
+    int rounds;
+    uint128_t uv;
+#ifdef REDUNDANT_FORM
+    f_elm_t ta;                             // a*k >> nbits has to fit in a word
+    f_copy(a, ta);
+    f_red(ta);
+    a = ta;
+#endif
+
+    if (small_cbits < 0)
+        f_mul_small_init();
+    rounds = (64 - __builtin_clzll(k | 1) + small_cbits <= 64 * WORDS_FIELD - s) ? 1 : 2;
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+    {
+        uv = (uint128_t)a[i] * k + carry;
+        t[i] = (digit_t)uv;
+        carry = (digit_t)(uv >> RADIX);
+    }
+    t[WORDS_FIELD] = carry;
+
+    for (int r = 0; r < rounds; r++)
+    {
+        q = (t[WORDS_FIELD] << s) | ((t[WORDS_FIELD - 1] >> 1) >> (63 - s));     // t >> nbits
+        carry = 0;
+        for (int i = 0; i < WORDS_FIELD; i++)
+        {
+            uv = (uint128_t)q * p[i] + carry;
+            u[i] = (digit_t)uv;
+            carry = (digit_t)(uv >> RADIX);
+        }
+        u[WORDS_FIELD] = carry;
+        borrow = 0;
+        for (int i = 0; i <= WORDS_FIELD; i++)
+            SUBC(borrow, t[i], u[i], t[i]);
+    }
+    mp_csub_p(t, WORDS_FIELD + 1);
+    if (rounds == 2)
+        mp_csub_p(t, WORDS_FIELD + 1);
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+        c[i] = t[i];
+}
@@ -0,0 +1,267 @@
+#include "arith.h"
+#include "dispatch.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #include <immintrin.h>
+    #define X8_IFMA
+#endif
+
+// Eight independent Montgomery multiplications in radix 2^52, for every prime
+// An f_elm_x8_t holds WORDS52_FIELD limbs of 52 bits, limb-major with one 64-bit lane per element: a[i][k] is limb i of element k.
+// Elements live in their own Montgomery domain, R' = 2^(52*WORDS52_FIELD) with 4p < R', and are kept in [0, 2p).
+// The constants come from p and pp (pp mod 2^52 = -p^(-1) mod 2^52), R'^2 mod p is R2 doubled 104*WORDS52_FIELD - 128*WORDS_FIELD times.
+// With AVX-512 IFMA the eight lanes go through vpmadd52luq/vpmadd52huq, otherwise through the same algorithm lane by lane.
+
+#define MASK52  MASK(52, 0)
+
+static digit_t p52[WORDS52_FIELD];          // p in radix 2^52
+static digit_t R2_52[WORDS52_FIELD];        // R'^2 mod p in radix 2^52
+static int x8_ready = 0;
+
+
+// WORDS_FIELD words -> WORDS52_FIELD limbs of 52 bits
+static void x8_split(const digit_t *a, digit_t *b)
+{
+    for (int i = 0; i < WORDS52_FIELD; i++)
+    {
+        int w = (52 * i) >> 6, s = (52 * i) & 63;
+        digit_t x = 0;
+        if (w < WORDS_FIELD)
+            x = a[w] >> s;
+        if (s > 12 && w + 1 < WORDS_FIELD)
+            x |= a[w + 1] << (64 - s);
+        b[i] = x & MASK52;
+    }
+}
+
+
+// WORDS52_FIELD limbs of 52 bits -> WORDS_FIELD words, the value has to fit
+static void x8_join(const digit_t *a, digit_t *b)
+{
+    for (int i = 0; i < WORDS_FIELD; i++)
+        b[i] = 0;
+    for (int i = 0; i < WORDS52_FIELD; i++)
+    {
+        int w = (52 * i) >> 6, s = (52 * i) & 63;
+        if (w < WORDS_FIELD)
+            b[w] |= a[i] << s;
+        if (s > 12 && w + 1 < WORDS_FIELD)
+            b[w + 1] |= a[i] >> (64 - s);
+    }
+}
+
+
+// a = 2a mod p, a in [0, p)
+static void x8_dbl(digit_t *a)
+{
+    digit_t t[WORDS_FIELD], mask, top, borrow = 0;
+
+    top = a[WORDS_FIELD - 1] >> 63;
+    for (int i = WORDS_FIELD - 1; i > 0; i--)
+        a[i] = (a[i] << 1) | (a[i - 1] >> 63);
+    a[0] <<= 1;
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+        SUBC(borrow, a[i], p[i], t[i]);
+    mask = 0 - (borrow & (1 - top));        // keep a if 2a < p
+    for (int i = 0; i < WORDS_FIELD; i++)
+        a[i] = (a[i] & mask) | (t[i] & ~mask);
+}
+
+
+static void x8_init(void)
+{
+    digit_t t[WORDS_FIELD];
+
+    x8_split(p, p52);
+    for (int i = 0; i < WORDS_FIELD; i++)
+        t[i] = R2[i];
+    for (int i = 0; i < 104 * WORDS52_FIELD - 128 * WORDS_FIELD; i++)
+        x8_dbl(t);
+    x8_split(t, R2_52);
+    x8_ready = 1;
+}
+
+
+// One lane, the same rows as the IFMA kernel with the 52-bit halves of 64x64 -> 128 products
+static void x8_mul_lane(const digit_t *a, const digit_t *b, digit_t *c)
+{
+    digit_t acc[WORDS52_FIELD + 1] = {0}, q;
+    const digit_t pp52 = pp[0] & MASK52;
+    uint128_t t;
+
+    for (int i = 0; i < WORDS52_FIELD; i++)
+    {
+            for (int j = 0; j < WORDS52_FIELD; j++)
+        {
+            t = (uint128_t)a[i] * b[j];
+            acc[j] += (digit_t)t & MASK52;
+            acc[j + 1] += (digit_t)(t >> 52);
+        }
+        q = (acc[0] * pp52) & MASK52;
+            for (int j = 0; j < WORDS52_FIELD; j++)
+        {
+            t = (uint128_t)q * p52[j];
+            acc[j] += (digit_t)t & MASK52;
+            acc[j + 1] += (digit_t)(t >> 52);
+        }
+        acc[1] += acc[0] >> 52;
+            for (int j = 0; j < WORDS52_FIELD; j++)
+            acc[j] = acc[j + 1];
+        acc[WORDS52_FIELD] = 0;
+    }
+
+    for (int j = 0; j < WORDS52_FIELD - 1; j++)
+    {
+        acc[j + 1] += acc[j] >> 52;
+        c[j] = acc[j] & MASK52;
+    }
+    c[WORDS52_FIELD - 1] = acc[WORDS52_FIELD - 1];
+}
+
+
+static void f_mul_x8_generic(const f_elm_x8_t a, const f_elm_x8_t b, f_elm_x8_t c)
+{
+    digit_t ta[WORDS52_FIELD], tb[WORDS52_FIELD], tc[WORDS52_FIELD];
+
+    for (int k = 0; k < 8; k++)
+    {
+        for (int i = 0; i < WORDS52_FIELD; i++)
+        {
+            ta[i] = a[i][k];
+            tb[i] = b[i][k];
+        }
+        x8_mul_lane(ta, tb, tc);
+        for (int i = 0; i < WORDS52_FIELD; i++)
+            c[i][k] = tc[i];
+    }
+}
+
+
+#ifdef X8_IFMA
+// Operand scanning: every row adds a[i]*b and q*p, then drops the bottom limb, which is 0 mod 2^52
+// Each limb collects at most four 52-bit halves per row, so the 64-bit lanes hold 4*WORDS52_FIELD of them
+__attribute__((target("avx512f,avx512ifma")))
+static void f_mul_x8_ifma(const f_elm_x8_t a, const f_elm_x8_t b, f_elm_x8_t c)
+{
+    __m512i acc[WORDS52_FIELD + 1], vb[WORDS52_FIELD], vp[WORDS52_FIELD], ai, q;
+    const __m512i zero = _mm512_setzero_si512(), m52 = _mm512_set1_epi64(MASK52), pp52 = _mm512_set1_epi64(pp[0] & MASK52);
+
+    for (int j = 0; j < WORDS52_FIELD; j++)
+    {
+        vb[j] = _mm512_loadu_si512((const void *)b[j]);
+        vp[j] = _mm512_set1_epi64(p52[j]);
+        acc[j] = zero;
+    }
+    acc[WORDS52_FIELD] = zero;
+
+    #pragma GCC unroll 10
+    for (int i = 0; i < WORDS52_FIELD; i++)
+    {
+        ai = _mm512_loadu_si512((const void *)a[i]);
+        #pragma GCC unroll 10
+        for (int j = 0; j < WORDS52_FIELD; j++)
+        {
+            acc[j] = _mm512_madd52lo_epu64(acc[j], ai, vb[j]);
+            acc[j + 1] = _mm512_madd52hi_epu64(acc[j + 1], ai, vb[j]);
+        }
+        q = _mm512_madd52lo_epu64(zero, acc[0], pp52);
+        #pragma GCC unroll 10
+        for (int j = 0; j < WORDS52_FIELD; j++)
+        {
+            acc[j] = _mm512_madd52lo_epu64(acc[j], q, vp[j]);
+            acc[j + 1] = _mm512_madd52hi_epu64(acc[j + 1], q, vp[j]);
+        }
+        acc[1] = _mm512_add_epi64(acc[1], _mm512_srli_epi64(acc[0], 52));
+        #pragma GCC unroll 10
+        for (int j = 0; j < WORDS52_FIELD; j++)
+            acc[j] = acc[j + 1];
+        acc[WORDS52_FIELD] = zero;
+    }
+
+    for (int j = 0; j < WORDS52_FIELD - 1; j++)
+    {
+        acc[j + 1] = _mm512_add_epi64(acc[j + 1], _mm512_srli_epi64(acc[j], 52));
+        _mm512_storeu_si512((void *)c[j], _mm512_and_si512(acc[j], m52));
+    }
+    _mm512_storeu_si512((void *)c[WORDS52_FIELD - 1], acc[WORDS52_FIELD - 1]);
+}
+
+
+// AVX-512 IFMA is checked once through CPUID (cpu_features), FF_DISPATCH can turn it off
+static int x8_use_ifma(void)
+{
+    return (cpu_features() & CPU_AVX512_IFMA) != 0;
+}
+#endif
+
+
+// Eight Montgomery multiplications, c = a*b/R' for every lane, inputs and output in [0, 2p)
+void f_mul_x8(const f_elm_x8_t a, const f_elm_x8_t b, f_elm_x8_t c)
+{
+    if (!x8_ready)
+        x8_init();
+#ifdef X8_IFMA
+    if (x8_use_ifma())
+    {
+        f_mul_x8_ifma(a, b, c);
+        return;
+    }
+#endif
+    f_mul_x8_generic(a, b, c);
+}
+
+
+// Eight Montgomery squarings
+void f_sqr_x8(const f_elm_x8_t a, f_elm_x8_t c)
+{
+    f_mul_x8(a, a, c);
+}
+
+
+// Eight integers below 2^(64*WORDS_FIELD) -> Montgomery domain of the x8 kernels (a -> aR')
+void to_mont_x8(const f_elm_t a[8], f_elm_x8_t b)
+{
+    f_elm_x8_t t;
+    digit_t limbs[WORDS52_FIELD];
+
+    if (!x8_ready)
+        x8_init();
+    for (int k = 0; k < 8; k++)
+    {
+        x8_split(a[k], limbs);
+        for (int i = 0; i < WORDS52_FIELD; i++)
+        {
+            b[i][k] = limbs[i];
+            t[i][k] = R2_52[i];
+        }
+    }
+    f_mul_x8(b, t, b);
+}
+
+
+// Montgomery domain of the x8 kernels -> eight canonical values in [0, p) (aR' -> a)
+void from_mont_x8(const f_elm_x8_t a, f_elm_t b[8])
+{
+    f_elm_x8_t one, t;
+    digit_t limbs[WORDS52_FIELD], r[WORDS_FIELD], mask, borrow;
+
+    for (int i = 0; i < WORDS52_FIELD; i++)
+        for (int k = 0; k < 8; k++)
+            one[i][k] = (i == 0);
+    f_mul_x8(a, one, t);                    // in [0, p]
+
+    for (int k = 0; k < 8; k++)
+    {
+        for (int i = 0; i < WORDS52_FIELD; i++)
+            limbs[i] = t[i][k];
+        x8_join(limbs, b[k]);
+
+        borrow = 0;
+        for (int i = 0; i < WORDS_FIELD; i++)
+            SUBC(borrow, b[k][i], p[i], r[i]);
+        mask = 0 - borrow;                  // keep b if b < p
+        for (int i = 0; i < WORDS_FIELD; i++)
+            b[k][i] = (b[k][i] & mask) | (r[i] & ~mask);
+    }
+}
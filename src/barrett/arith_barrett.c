@@ -0,0 +1,101 @@
+#include "arith.h"
+
+#ifdef BARRETT_FORM
+
+// Barrett reduction (HAC 14.42) with b = 2^64 and k = WORDS_FIELD, elements are kept in canonical form
+// q3 = floor(floor(a / b^(k-1)) * mu / b^(k+1)) with mu = floor(b^(2k) / p) undershoots floor(a / p) by at most 2.
+// Only the columns of q1*mu from k-1 up are summed, the ones below add less than one unit to q3 (at most one more
+// subtraction), and r = a - q3*p is computed modulo b^(k+1). Any a below b^(2k) is reduced, so the lazy
+// accumulators and inputs in [0, 2p) need no special care.
+
+#if WORDS_FIELD == 1
+    #define BARRETT_CORRECTIONS     2       // q1*mu is computed in full
+#else
+    #define BARRETT_CORRECTIONS     3
+#endif
+
+
+// Reduction of a double-width product, a < 2^(128*WORDS_FIELD) -> c in [0, p)
+void mp_red(const digit_t *a, digit_t *c)
+{
+    const digit_t *q1 = a + WORDS_FIELD - 1;            // floor(a / b^(k-1)), k+1 words
+    digit_t q3[WORDS_FIELD + 1], r[WORDS_FIELD + 1] = {0}, top = 0, mask, borrow, carry;
+    uint128_t acc = 0, uv;
+
+    // q3 = floor(q1*mu / b^(k+1)), product scanning over the columns k-1 .. 2k
+    #pragma GCC unroll 32
+    for (int s = WORDS_FIELD - 1; s <= 2 * WORDS_FIELD; s++)
+    {
+        #pragma GCC unroll 16
+        for (int i = (s > WORDS_FIELD ? s - WORDS_FIELD : 0); i <= (s < WORDS_FIELD ? s : WORDS_FIELD); i++)
+        {
+            uv = (uint128_t)q1[i] * mu[s - i];
+            acc += uv;
+            top += (acc < uv);
+        }
+        if (s > WORDS_FIELD)
+            q3[s - WORDS_FIELD - 1] = (digit_t)acc;
+        acc = (acc >> RADIX) | ((uint128_t)top << RADIX);
+        top = 0;
+    }
+    q3[WORDS_FIELD] = (digit_t)acc;
+
+    // r = q3*p mod b^(k+1)
+    #pragma GCC unroll 16
+    for (int i = 0; i <= WORDS_FIELD; i++)
+    {
+        uv = 0;
+        for (int j = 0; j < (i == 0 ? WORDS_FIELD : WORDS_FIELD + 1 - i); j++)
+        {
+            uv = (uint128_t)q3[i] * p[j] + r[i + j] + (digit_t)(uv >> RADIX);
+            r[i + j] = (digit_t)uv;
+        }
+        if (i == 0)
+            r[WORDS_FIELD] = (digit_t)(uv >> RADIX);
+    }
+
+    // r = a - q3*p mod b^(k+1), in [0, (BARRETT_CORRECTIONS + 1)p)
+    borrow = 0;
+    for (int i = 0; i <= WORDS_FIELD; i++)
+        SUBC(borrow, a[i], r[i], r[i]);
+
+    // Subtract p and add it back if that borrows
+    for (int k = 0; k < BARRETT_CORRECTIONS; k++)
+    {
+        borrow = 0;
+        for (int i = 0; i < WORDS_FIELD; i++)
+            SUBC(borrow, r[i], p[i], r[i]);
+        SUBC(borrow, r[WORDS_FIELD], 0, r[WORDS_FIELD]);
+
+        mask = 0 - borrow;
+        carry = 0;
+        for (int i = 0; i < WORDS_FIELD; i++)
+            ADDC(carry, r[i], p[i] & mask, r[i]);
+        r[WORDS_FIELD] += carry;
+    }
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+        c[i] = r[i];
+}
+
+
+// Multiplication of field elements
+void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c)
+{
+    digit_t t0[2 * WORDS_FIELD];
+
+    mp_mul(a, b, t0);
+    mp_red(t0, c);
+}
+
+
+// Squaring of a field element
+void f_sqr(const f_elm_t a, f_elm_t c)
+{
+    digit_t t0[2 * WORDS_FIELD];
+
+    mp_sqr(a, t0);
+    mp_red(t0, c);
+}
+
+#endif
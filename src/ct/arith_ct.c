@@ -0,0 +1,220 @@
+#include "arith.h"
+#include "dispatch.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #include <immintrin.h>
+    #define CT_AVX2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define CT_NEON
+#endif
+
+// Constant-time table lookup and conditional swap
+// The lookup reads every entry of the table and keeps the one at idx with a mask, so neither the memory access
+// pattern nor the running time depend on idx. With AVX2 the table is read four entries (W vectors of four words)
+// at a time: lane t of vector v belongs to entry (4v + t) / W of the group, and its mask is a vector compare
+// with idx. The lanes are folded back into the W words of the element at the end.
+// The swap xors both elements with (a ^ b) & mask, a vector of four words at a time from 256 bits on.
+// NEON, always present on AArch64, does the same with two-word vectors: the lookup reads two entries (W vectors)
+// at a time, the mask of a lane is vceqq_u64 of its entry number with idx and vbslq_u64 keeps the selected words.
+// The swap exchanges two words at a time with vbslq_u64, and the last word of an odd WORDS_FIELD with vbsl_u64.
+
+
+// 0 - 1 if a == b, 0 otherwise, without a branch
+static inline digit_t ct_eq_mask(digit_t a, digit_t b)
+{
+    digit_t d = a ^ b;
+    return ((d | (0 - d)) >> (RADIX - 1)) - 1;
+}
+
+
+static void f_table_lookup_generic(const f_elm_t *table, const unsigned int n, const unsigned int idx, f_elm_t out)
+{
+    digit_t mask;
+
+    for (int j = 0; j < WORDS_FIELD; j++)
+        out[j] = 0;
+    for (unsigned int i = 0; i < n; i++)
+    {
+        mask = ct_eq_mask(i, idx);
+        for (int j = 0; j < WORDS_FIELD; j++)
+            out[j] |= table[i][j] & mask;
+    }
+}
+
+
+static void f_cswap_generic(f_elm_t a, f_elm_t b, const uint8_t cond)
+{
+    digit_t mask = 0 - (digit_t)cond, t;
+
+    for (int j = 0; j < WORDS_FIELD; j++)
+    {
+        t = (a[j] ^ b[j]) & mask;
+        a[j] ^= t;
+        b[j] ^= t;
+    }
+}
+
+
+#ifdef CT_AVX2
+__attribute__((target("avx2")))
+static void f_table_lookup_avx2(const f_elm_t *table, const unsigned int n, const unsigned int idx, f_elm_t out)
+{
+    __m256i acc[WORDS_FIELD], off[WORDS_FIELD], mask;
+    const __m256i vidx = _mm256_set1_epi64x(idx), four = _mm256_set1_epi64x(4);
+    __m256i base = _mm256_setzero_si256();
+    const digit_t *t = (const digit_t *)table;
+    digit_t w[4];
+    unsigned int i = 0;
+
+    for (int v = 0; v < WORDS_FIELD; v++)
+    {
+        acc[v] = _mm256_setzero_si256();
+        off[v] = _mm256_setr_epi64x((4 * v) / WORDS_FIELD, (4 * v + 1) / WORDS_FIELD, (4 * v + 2) / WORDS_FIELD, (4 * v + 3) / WORDS_FIELD);
+    }
+
+    for (; i + 4 <= n; i += 4)
+    {
+        #pragma GCC unroll 8
+        for (int v = 0; v < WORDS_FIELD; v++)
+        {
+            mask = _mm256_cmpeq_epi64(_mm256_add_epi64(base, off[v]), vidx);
+            acc[v] = _mm256_or_si256(acc[v], _mm256_and_si256(mask, _mm256_loadu_si256((const __m256i *)&t[(size_t)i * WORDS_FIELD + 4 * v])));
+        }
+        base = _mm256_add_epi64(base, four);
+    }
+
+    f_table_lookup_generic(&table[i], n - i, idx - i, out);     // the last n % 4 entries, idx - i wraps if idx < i
+    for (int v = 0; v < WORDS_FIELD; v++)
+    {
+        _mm256_storeu_si256((__m256i *)w, acc[v]);
+        for (int l = 0; l < 4; l++)
+            out[(4 * v + l) % WORDS_FIELD] |= w[l];
+    }
+}
+
+
+#if WORDS_FIELD >= 4
+// Four words at a time, below four words the scalar loop is as fast
+__attribute__((target("avx2")))
+static void f_cswap_avx2(f_elm_t a, f_elm_t b, const uint8_t cond)
+{
+    const __m256i mask = _mm256_set1_epi64x(0 - (digit_t)cond);
+    __m256i va, vb, t;
+
+    #pragma GCC unroll 2
+    for (int j = 0; j < WORDS_FIELD; j += 4)
+    {
+        va = _mm256_loadu_si256((const __m256i *)&a[j]);
+        vb = _mm256_loadu_si256((const __m256i *)&b[j]);
+        t = _mm256_and_si256(_mm256_xor_si256(va, vb), mask);
+        _mm256_storeu_si256((__m256i *)&a[j], _mm256_xor_si256(va, t));
+        _mm256_storeu_si256((__m256i *)&b[j], _mm256_xor_si256(vb, t));
+    }
+}
+#endif
+
+
+// AVX2 is checked once through CPUID (cpu_features), FF_DISPATCH can turn it off
+static int ct_use_avx2(void)
+{
+    return (cpu_features() & CPU_AVX2) != 0;
+}
+#endif
+
+
+#ifdef CT_NEON
+static void f_table_lookup_neon(const f_elm_t *table, const unsigned int n, const unsigned int idx, f_elm_t out)
+{
+    uint64x2_t acc[WORDS_FIELD], off[WORDS_FIELD], mask;
+    const uint64x2_t vidx = vdupq_n_u64(idx), two = vdupq_n_u64(2);
+    uint64x2_t base = vdupq_n_u64(0);
+    const digit_t *t = (const digit_t *)table;
+    digit_t w[2];
+    unsigned int i = 0;
+
+    for (int v = 0; v < WORDS_FIELD; v++)
+    {
+        acc[v] = vdupq_n_u64(0);
+        w[0] = (2 * v) / WORDS_FIELD;
+        w[1] = (2 * v + 1) / WORDS_FIELD;
+        off[v] = vld1q_u64(w);
+    }
+
+    for (; i + 2 <= n; i += 2)
+    {
+        #pragma GCC unroll 8
+        for (int v = 0; v < WORDS_FIELD; v++)
+        {
+            mask = vceqq_u64(vaddq_u64(base, off[v]), vidx);
+            acc[v] = vbslq_u64(mask, vld1q_u64(&t[(size_t)i * WORDS_FIELD + 2 * v]), acc[v]);
+        }
+        base = vaddq_u64(base, two);
+    }
+
+    f_table_lookup_generic(&table[i], n - i, idx - i, out);     // the last entry of an odd n, idx - i wraps if idx < i
+    for (int v = 0; v < WORDS_FIELD; v++)
+    {
+        out[(2 * v) % WORDS_FIELD] |= vgetq_lane_u64(acc[v], 0);
+        out[(2 * v + 1) % WORDS_FIELD] |= vgetq_lane_u64(acc[v], 1);
+    }
+}
+
+
+static void f_cswap_neon(f_elm_t a, f_elm_t b, const uint8_t cond)
+{
+    const uint64x2_t mask = vdupq_n_u64(0 - (digit_t)cond);
+    uint64x2_t va, vb;
+    int j = 0;
+
+    #pragma GCC unroll 4
+    for (; j + 2 <= WORDS_FIELD; j += 2)
+    {
+        va = vld1q_u64(&a[j]);
+        vb = vld1q_u64(&b[j]);
+        vst1q_u64(&a[j], vbslq_u64(mask, vb, va));
+        vst1q_u64(&b[j], vbslq_u64(mask, va, vb));
+    }
+#if WORDS_FIELD % 2
+    const uint64x1_t mask1 = vdup_n_u64(0 - (digit_t)cond);
+    uint64x1_t wa = vld1_u64(&a[j]), wb = vld1_u64(&b[j]);
+
+    vst1_u64(&a[j], vbsl_u64(mask1, wb, wa));
+    vst1_u64(&b[j], vbsl_u64(mask1, wa, wb));
+#endif
+}
+#endif
+
+
+// Constant-time lookup, out = table[idx], all n entries are read, out = 0 if idx >= n
+void f_table_lookup(const f_elm_t *table, const unsigned int n, const unsigned int idx, f_elm_t out)
+{
+#ifdef CT_AVX2
+    if (ct_use_avx2())
+    {
+        f_table_lookup_avx2(table, n, idx, out);
+        return;
+    }
+#elif defined(CT_NEON)
+    f_table_lookup_neon(table, n, idx, out);
+    return;
+#endif
+    f_table_lookup_generic(table, n, idx, out);
+}
+
+
+// Constant-time conditional swap, if cond == 1 a and b are exchanged, if cond == 0 they are left as they are
+void f_cswap(f_elm_t a, f_elm_t b, const uint8_t cond)
+{
+#if defined(CT_AVX2) && WORDS_FIELD >= 4
+    if (ct_use_avx2())
+    {
+        f_cswap_avx2(a, b, cond);
+        return;
+    }
+#elif defined(CT_NEON)
+    f_cswap_neon(a, b, cond);
+    return;
+#endif
+    f_cswap_generic(a, b, cond);
+}
@@ -0,0 +1,43 @@
+// Renames the field operations of a backend source to <name>BACKEND_SUFFIX, so that several backends link into one binary
+// Include after dispatch.h and before the backend source, then define its table with BACKEND_TABLE
+
+#define BACKEND_NAME2(f, s)     f##s
+#define BACKEND_NAME(f, s)      BACKEND_NAME2(f, s)
+
+#define f_red       BACKEND_NAME(f_red, BACKEND_SUFFIX)
+#define f_rand      BACKEND_NAME(f_rand, BACKEND_SUFFIX)
+#define f_add       BACKEND_NAME(f_add, BACKEND_SUFFIX)
+#define f_sub       BACKEND_NAME(f_sub, BACKEND_SUFFIX)
+#define f_neg       BACKEND_NAME(f_neg, BACKEND_SUFFIX)
+#define mp_mul      BACKEND_NAME(mp_mul, BACKEND_SUFFIX)
+#define mont_redc   BACKEND_NAME(mont_redc, BACKEND_SUFFIX)
+#define mp_red      BACKEND_NAME(mp_red, BACKEND_SUFFIX)
+#define f_mul       BACKEND_NAME(f_mul, BACKEND_SUFFIX)
+#define mp_sqr      BACKEND_NAME(mp_sqr, BACKEND_SUFFIX)
+#define f_sqr       BACKEND_NAME(f_sqr, BACKEND_SUFFIX)
+#define to_mont     BACKEND_NAME(to_mont, BACKEND_SUFFIX)
+#define from_mont   BACKEND_NAME(from_mont, BACKEND_SUFFIX)
+#define f_sqrt      BACKEND_NAME(f_sqrt, BACKEND_SUFFIX)
+#define fp_2_mul    BACKEND_NAME(fp_2_mul, BACKEND_SUFFIX)      // p512_1 helpers
+#define fp_2_sqr    BACKEND_NAME(fp_2_sqr, BACKEND_SUFFIX)
+#ifdef FERMAT_INVERSION
+#define f_inv       BACKEND_NAME(f_inv, BACKEND_SUFFIX)     // Otherwise the calls go to the shared f_inv
+#endif
+#ifdef EULER_LEGENDRE
+#define f_leg       BACKEND_NAME(f_leg, BACKEND_SUFFIX)     // Otherwise the calls go to the shared f_leg
+#endif
+
+// Positional, a designator such as .f_mul would be renamed as well
+#ifdef FERMAT_INVERSION
+    #define BACKEND_INV     , f_inv
+#else
+    #define BACKEND_INV
+#endif
+#ifdef EULER_LEGENDRE
+    #define BACKEND_LEG     , f_leg
+#else
+    #define BACKEND_LEG
+#endif
+#define BACKEND_TABLE(name, features)                                                      \
+    {name, features, f_red, f_rand, f_add, f_sub, f_neg, mp_mul, mont_redc, f_mul, mp_sqr,  \
+     f_sqr, to_mont, from_mont, f_sqrt BACKEND_INV BACKEND_LEG}
@@ -0,0 +1,8 @@
+// Portable backend of the runtime dispatch build, always in Montgomery form
+#include "dispatch.h"
+
+#define BACKEND_SUFFIX  _generic
+#include "backend.h"
+#include "generic/arith_generic.c"
+
+const f_backend_t f_backend_generic = BACKEND_TABLE("generic", 0);
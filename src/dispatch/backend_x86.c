@@ -0,0 +1,18 @@
+// x86-64 assembly backend of the runtime dispatch build, needs BMI2 and ADX
+#include "dispatch.h"
+
+#define BACKEND_SUFFIX  _x86
+#include "backend.h"
+#if NBITS_FIELD == 64
+    #include "x86_64/arith_x86_64.c"
+#elif NBITS_FIELD == 128
+    #include "x86_64/arith_x86_128.c"
+#elif NBITS_FIELD == 192
+    #include "x86_64/arith_x86_192.c"
+#elif NBITS_FIELD == 256
+    #include "x86_64/arith_x86_256.c"
+#else
+    #include "x86_64/arith_x86_512.c"
+#endif
+
+const f_backend_t f_backend_x86 = BACKEND_TABLE("x86-64", CPU_BMI2_ADX);
@@ -0,0 +1,58 @@
+#include <stdlib.h>
+#include <string.h>
+#include "dispatch.h"
+
+static const struct {
+    const char *name;
+    unsigned int bit;
+} cpu_names[] = {
+    {"bmi2",        CPU_BMI2_ADX},
+    {"avx2",        CPU_AVX2},
+    {"avx512ifma",  CPU_AVX512_IFMA},
+};
+
+
+// Comma-separated feature names -> feature bits, unknown names (such as "generic") add nothing
+static unsigned int cpu_parse(const char *s)
+{
+    unsigned int mask = 0;
+
+    while (*s)
+    {
+        size_t len = strcspn(s, ",");
+        for (size_t i = 0; i < sizeof(cpu_names) / sizeof(cpu_names[0]); i++)
+            if (strlen(cpu_names[i].name) == len && strncmp(s, cpu_names[i].name, len) == 0)
+                mask |= cpu_names[i].bit;
+        s += len;
+        if (*s == ',')
+            s++;
+    }
+    return mask;
+}
+
+
+// CPUID is read once, FF_DISPATCH can only take features away
+unsigned int cpu_features(void)
+{
+    static int features = -1;
+
+    if (features < 0)
+    {
+        unsigned int f = 0;
+        const char *env = getenv("FF_DISPATCH");
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+        __builtin_cpu_init();       // may run from a constructor, before the one of libgcc
+        if (__builtin_cpu_supports("bmi2") && __builtin_cpu_supports("adx"))
+            f |= CPU_BMI2_ADX;
+        if (__builtin_cpu_supports("avx2"))
+            f |= CPU_AVX2;
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512ifma"))
+            f |= CPU_AVX512_IFMA;
+#endif
+        if (env)
+            f &= cpu_parse(env);
+        features = (int)f;
+    }
+    return (unsigned int)features;
+}
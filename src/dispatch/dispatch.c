@@ -0,0 +1,80 @@
+#include "arith.h"
+#include "dispatch.h"
+
+// Backends in order of preference, the first one whose features the CPU has (see cpu_features) is used
+static const f_backend_t *const backends[] = {&f_backend_x86, &f_backend_generic};
+
+// Valid before the constructor runs, so that other constructors can use the field operations
+static const f_backend_t *backend = &f_backend_generic;
+
+
+__attribute__((constructor))
+static void f_dispatch_init(void)
+{
+    unsigned int features = cpu_features();
+
+    for (size_t i = 0; i < sizeof(backends) / sizeof(backends[0]); i++)
+        if ((backends[i]->features & ~features) == 0)
+        {
+            backend = backends[i];
+            break;
+        }
+}
+
+
+const char *f_backend_name(void)
+{
+    return backend->name;
+}
+
+
+// Every operation is a single indirect call into the backend
+
+void f_red(f_elm_t a) {
+    backend->f_red(a); }
+
+void f_rand(f_elm_t a) {
+    backend->f_rand(a); }
+
+void f_add(const f_elm_t a, const f_elm_t b, f_elm_t c) {
+    backend->f_add(a, b, c); }
+
+void f_sub(const f_elm_t a, const f_elm_t b, f_elm_t c) {
+    backend->f_sub(a, b, c); }
+
+void f_neg(const f_elm_t a, f_elm_t b) {
+    backend->f_neg(a, b); }
+
+void mp_mul(const digit_t *a, const digit_t *b, digit_t *c) {
+    backend->mp_mul(a, b, c); }
+
+void mont_redc(const digit_t *a, digit_t *c) {
+    backend->mont_redc(a, c); }
+
+void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c) {
+    backend->f_mul(a, b, c); }
+
+void mp_sqr(const digit_t *a, digit_t *c) {
+    backend->mp_sqr(a, c); }
+
+void f_sqr(const f_elm_t a, f_elm_t c) {
+    backend->f_sqr(a, c); }
+
+void to_mont(const digit_t *a, f_elm_t b) {
+    backend->to_mont(a, b); }
+
+void from_mont(const f_elm_t a, digit_t *b) {
+    backend->from_mont(a, b); }
+
+void f_sqrt(const f_elm_t a, f_elm_t b) {
+    backend->f_sqrt(a, b); }
+
+#ifdef FERMAT_INVERSION
+void f_inv(const f_elm_t a, f_elm_t b) {
+    backend->f_inv(a, b); }
+#endif
+
+#ifdef EULER_LEGENDRE
+void f_leg(const f_elm_t a, unsigned char *b) {
+    backend->f_leg(a, b); }
+#endif
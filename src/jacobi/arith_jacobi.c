@@ -0,0 +1,307 @@
+#include "arith.h"
+
+// Constant-time Jacobi symbol with the optimised binary GCD of Pornin (eprint 2020/972)
+// The binary GCD on (a, b = p) halves a when it is even, otherwise swaps a and b when a < b and sets a = (a - b)/2.
+// Each step maps to a rule of the Jacobi symbol (a | b): halving flips the sign for b = 3, 5 mod 8, a swap flips it
+// for a = b = 3 mod 4. A batch runs JACOBI_STEPS steps on 64-bit approximations of a and b (top 33 bits and low 31
+// bits, exact while both fit in 64 bits) and collects them in a 2x2 matrix, which is then applied to the full a and b.
+// The low bits the rules look at stay exact during the batch. When the approximation took a wrong turn a comes out
+// negative, it is negated and (-1 | b) is applied. After 2*64*WORDS_FIELD steps a = 0 and b = 1.
+// Montgomery form needs no conversion, (xR | p) = (x | p) as R is an even power of 2.
+// The _vartime functions, for public inputs, shift out runs of zeros of a at once and stop as soon as a = 0, with
+// a plain 64-bit loop once a and b fit in a word. f_sqrt_vartime returns early for non-squares.
+
+#define JACOBI_STEPS        29          // 31 exact low bits, the last step reads 3 bits of b
+#define JACOBI_BATCHES      ((2 * RADIX * WORDS_FIELD + JACOBI_STEPS - 1) / JACOBI_STEPS)
+
+// Transition matrix of a batch, [a', b'] = [f0 g0; f1 g1] [a, b] / 2^JACOBI_STEPS
+typedef struct {
+    int64_t f0, g0, f1, g1;
+} trans_jac_t;
+
+
+// Number of leading zeros of a, 64 for a = 0, without a branch
+static inline unsigned int ct_clz(digit_t a)
+{
+    digit_t m;
+    unsigned int n = 0;
+
+    for (int s = 32; s > 0; s >>= 1)
+    {
+        m = ((a >> (RADIX - s)) - 1) >> (RADIX - 1);        // top s bits are zero
+        m = 0 - m;
+        n += s & (unsigned int)m;
+        a ^= (a ^ (a << s)) & m;
+    }
+    m = 0 - ((a >> (RADIX - 1)) ^ 1);                        // a = 0
+    return n + (1 & (unsigned int)m);
+}
+
+
+#if WORDS_FIELD > 1
+// Approximations of a and b: the low 31 bits and the 33 bits below the top bit of max(a, b, 2^63)
+static void approx_ab(const digit_t *a, const digit_t *b, digit_t *xa, digit_t *xb)
+{
+    digit_t ah = a[1], al = a[0], bh = b[1], bl = b[0], m;
+    unsigned int s;
+
+    // Top non-zero word of a | b (at least word 1) and the word below it
+    for (int i = 2; i < WORDS_FIELD; i++)
+    {
+        m = 0 - (((a[i] | b[i]) | (0 - (a[i] | b[i]))) >> (RADIX - 1));
+        ah ^= (ah ^ a[i]) & m;
+        al ^= (al ^ a[i - 1]) & m;
+        bh ^= (bh ^ b[i]) & m;
+        bl ^= (bl ^ b[i - 1]) & m;
+    }
+
+    s = ct_clz(ah | bh);
+    ah = (digit_t)((((uint128_t)ah << RADIX) | al) << s >> RADIX);
+    bh = (digit_t)((((uint128_t)bh << RADIX) | bl) << s >> RADIX);
+    m = (digit_t)0 - ((digit_t)1 << 31);
+    *xa = (ah & m) | (a[0] & ~m);
+    *xb = (bh & m) | (b[0] & ~m);
+}
+#endif
+
+
+// JACOBI_STEPS binary GCD steps on the approximations, the sign flips are accumulated in bit 1 of the return value
+// The rows of the matrix are packed as f + 2^32 g, the factors stay below 2^29 in absolute value
+static digit_t jacobi_steps(digit_t *ya, digit_t *yb, trans_jac_t *t)
+{
+    digit_t xa = *ya, xb = *yb, r0 = 1, r1 = (digit_t)1 << 32, ls = 0, odd, swap, x;
+
+    for (int i = 0; i < JACOBI_STEPS; i++)
+    {
+        odd = 0 - (xa & 1);
+        swap = odd & (digit_t)(((uint128_t)xa - xb) >> RADIX);   // a odd and a < b
+        ls ^= swap & xa & xb;                                   // a = b = 3 mod 4
+        x = (xa ^ xb) & swap;
+        xa ^= x;
+        xb ^= x;
+        x = (r0 ^ r1) & swap;
+        r0 ^= x;
+        r1 ^= x;
+        xa -= xb & odd;
+        r0 -= r1 & odd;
+        xa >>= 1;
+        r1 <<= 1;
+        ls ^= xb ^ (xb >> 1);                                   // b = 3, 5 mod 8
+    }
+
+    *ya = xa;
+    *yb = xb;
+    t->f0 = (int64_t)(r0 << 32) >> 32;
+    t->g0 = (int64_t)(r0 - (digit_t)t->f0) >> 32;
+    t->f1 = (int64_t)(r1 << 32) >> 32;
+    t->g1 = (int64_t)(r1 - (digit_t)t->f1) >> 32;
+    return ls;
+}
+
+
+// Variable-time version of jacobi_steps, a run of k zeros of a is one shift (one flip when k is odd)
+static digit_t jacobi_steps_var(digit_t *ya, digit_t *yb, trans_jac_t *t)
+{
+    digit_t xa = *ya, xb = *yb, r0 = 1, r1 = (digit_t)1 << 32, ls = 0, swap, x;
+    int i = JACOBI_STEPS, zeros;
+
+    for (;;)
+    {
+        zeros = __builtin_ctzll(xa | ((digit_t)1 << i));
+        xa >>= zeros;
+        r1 <<= zeros;
+        i -= zeros;
+        if (zeros & 1)
+            ls ^= xb ^ (xb >> 1);                               // b = 3, 5 mod 8
+        if (i == 0)
+            break;
+
+        swap = (digit_t)(((uint128_t)xa - xb) >> RADIX);       // Masks, the branch would be taken half of the time
+        ls ^= swap & xa & xb;                                   // a = b = 3 mod 4
+        x = (xa ^ xb) & swap;
+        xa ^= x;
+        xb ^= x;
+        x = (r0 ^ r1) & swap;
+        r0 ^= x;
+        r1 ^= x;
+        xa -= xb;
+        r0 -= r1;
+    }
+
+    *ya = xa;
+    *yb = xb;
+    t->f0 = (int64_t)(r0 << 32) >> 32;
+    t->g0 = (int64_t)(r0 - (digit_t)t->f0) >> 32;
+    t->f1 = (int64_t)(r1 << 32) >> 32;
+    t->g1 = (int64_t)(r1 - (digit_t)t->f1) >> 32;
+    return ls;
+}
+
+
+// Variable-time binary GCD on single words until a = 0, the sign flips are accumulated in bit 1
+static digit_t jacobi_word_var(digit_t xa, digit_t xb)
+{
+    digit_t ls = 0, swap, x;
+    int zeros;
+
+    while (xa != 0)
+    {
+        zeros = __builtin_ctzll(xa);
+        xa >>= zeros;
+        if (zeros & 1)
+            ls ^= xb ^ (xb >> 1);
+        swap = (digit_t)(((uint128_t)xa - xb) >> RADIX);
+        ls ^= swap & xa & xb;
+        x = (xa ^ xb) & swap;
+        xa ^= x;
+        xb ^= x;
+        xa -= xb;
+    }
+    return ls;
+}
+
+
+#if WORDS_FIELD > 1
+// [a, b] = t [a, b] / 2^JACOBI_STEPS, exact, then both are made non-negative. Returns the sign mask of a
+static digit_t update_ab(digit_t *a, digit_t *b, const trans_jac_t *t)
+{
+    digit_t ta[WORDS_FIELD + 1], tb[WORDS_FIELD + 1], sa, sb, ca, cb;
+    int128_t xa = 0, xb = 0;
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+    {
+        xa += (int128_t)a[i] * t->f0 + (int128_t)b[i] * t->g0;
+        xb += (int128_t)a[i] * t->f1 + (int128_t)b[i] * t->g1;
+        ta[i] = (digit_t)xa;
+        tb[i] = (digit_t)xb;
+        xa >>= RADIX;
+        xb >>= RADIX;
+    }
+    ta[WORDS_FIELD] = (digit_t)xa;
+    tb[WORDS_FIELD] = (digit_t)xb;
+    sa = (digit_t)(xa >> (RADIX - 1));
+    sb = (digit_t)(xb >> (RADIX - 1));
+
+    ca = sa & 1;
+    cb = sb & 1;
+    for (int i = 0; i < WORDS_FIELD; i++)
+    {
+        ADDC(ca, ((ta[i] >> JACOBI_STEPS) | (ta[i + 1] << (RADIX - JACOBI_STEPS))) ^ sa, 0, a[i]);
+        ADDC(cb, ((tb[i] >> JACOBI_STEPS) | (tb[i + 1] << (RADIX - JACOBI_STEPS))) ^ sb, 0, b[i]);
+    }
+    return sa;
+}
+#endif
+
+
+// Jacobi symbol (a | p): 1 for a non-zero square, -1 for a non-square, 0 for a = 0
+int f_jacobi(const f_elm_t a)
+{
+    f_elm_t xa, xb;
+    trans_jac_t t;
+    digit_t ls = 0, z = 0;
+#if WORDS_FIELD > 1
+    digit_t sa, xa0, xb0;
+#endif
+
+    f_copy(a, xa);
+#if defined(REDUNDANT_FORM) || defined(MERSENNE_FORM)
+    f_red(xa);
+#endif
+    f_copy(p, xb);
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+        z |= xa[i];
+    z = (z | (0 - z)) >> (RADIX - 1);                           // a != 0
+
+    for (int i = 0; i < JACOBI_BATCHES; i++)
+    {
+#if WORDS_FIELD == 1
+        ls ^= jacobi_steps(xa, xb, &t);                         // Exact, a and b are updated in place
+#else
+        approx_ab(xa, xb, &xa0, &xb0);
+        ls ^= jacobi_steps(&xa0, &xb0, &t);
+        sa = update_ab(xa, xb, &t);
+        ls ^= sa & xb[0];                                       // (-1 | b) = -1 for b = 3 mod 4
+#endif
+    }
+
+    return (int)z - 2 * (int)(z & (ls >> 1) & 1);
+}
+
+
+// Jacobi symbol (a | p), 1, -1 or 0. Variable time, for public inputs only
+int f_jacobi_vartime(const f_elm_t a)
+{
+    f_elm_t xa, xb;
+    digit_t ls = 0, z = 0;
+#if WORDS_FIELD > 1
+    trans_jac_t t;
+    digit_t sa, xa0, xb0, hi;
+#endif
+
+    f_copy(a, xa);
+#if defined(REDUNDANT_FORM) || defined(MERSENNE_FORM)
+    f_red(xa);
+#endif
+    f_copy(p, xb);
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+        z |= xa[i];
+    if (z == 0)
+        return 0;
+
+#if WORDS_FIELD > 1
+    for (;;)
+    {
+        z = xa[0];
+        hi = 0;
+        for (int i = 1; i < WORDS_FIELD; i++)
+        {
+            z |= xa[i];
+            hi |= xa[i] | xb[i];
+        }
+        if (z == 0 || hi == 0)
+            break;
+
+        approx_ab(xa, xb, &xa0, &xb0);
+        ls ^= jacobi_steps_var(&xa0, &xb0, &t);
+        sa = update_ab(xa, xb, &t);
+        ls ^= sa & xb[0];
+    }
+#endif
+    ls ^= jacobi_word_var(xa[0], xb[0]);
+
+    return 1 - 2 * (int)((ls >> 1) & 1);
+}
+
+
+// Legendre symbol of a field element, 1 for a non-square and 0 otherwise. Variable time, for public inputs only
+void f_leg_vartime(const f_elm_t a, unsigned char *b)
+{
+    *b = (unsigned char)(f_jacobi_vartime(a) < 0);
+}
+
+
+// Square root of a field element, returns 0 and b = 0 when a is not a square. Variable time, for public inputs only
+int f_sqrt_vartime(const f_elm_t a, f_elm_t b)
+{
+    if (f_jacobi_vartime(a) < 0)
+    {
+        f_copy(Zero, b);
+        return 0;
+    }
+    f_sqrt(a, b);
+    return 1;
+}
+
+
+#ifndef EULER_LEGENDRE
+
+// Legendre symbol of a field element, 1 for a non-square and 0 otherwise
+void f_leg(const f_elm_t a, unsigned char *b)
+{
+    *b = (unsigned char)(f_jacobi(a) < 0);
+}
+
+#endif
@@ -47,6 +47,47 @@ inline void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c) {
     f_mul_asm(a, b, c); }
 
 
+// Squaring of a multiprecision word (without reduction)
+void mp_sqr(const digit_t *a, digit_t *c)
+{ // Product scanning squaring, the cross products a[i]*a[j] (i < j) are computed once and doubled
+    digit_t t = 0, u = 0, v = 0;
+    uint128_t uv, UV;
+
+    for (int k = 0; k < 2 * WORDS_FIELD - 1; k++)
+    {
+        for (int i = (k < WORDS_FIELD ? 0 : k - WORDS_FIELD + 1); i < k - i; i++)
+        {
+            UV = (uint128_t)a[i] * a[k - i];
+            t += (digit_t)(UV >> (2 * RADIX - 1));
+            UV <<= 1;
+            uv = (((uint128_t)u << RADIX) | v) + UV;
+            t += (uv < UV);
+            u = (digit_t)(uv >> RADIX);
+            v = (digit_t)uv;
+        }
+        if ((k & 1) == 0)
+        {
+            UV = (uint128_t)a[k / 2] * a[k / 2];
+            uv = (((uint128_t)u << RADIX) | v) + UV;
+            t += (uv < UV);
+            u = (digit_t)(uv >> RADIX);
+            v = (digit_t)uv;
+        }
+        c[k] = v;
+        v = u;
+        u = t;
+        t = 0;
+    }
+    c[2 * WORDS_FIELD - 1] = v;
+}
+
+
+// Squaring of a field element
+// Uses the assembly multiplier, which is still faster than mp_sqr followed by a reduction in C
+inline void f_sqr(const f_elm_t a, f_elm_t c) {
+    f_mul_asm(a, a, c); }
+
+
 
 // Convert a number from value to Montgomery form  (a -> aR)
 void to_mont(const digit_t *a, f_elm_t b)
@@ -63,13 +104,17 @@ void from_mont(const f_elm_t a, digit_t *b)
     mont_redc(t0, b);
 }
 
+#ifdef FERMAT_INVERSION
 // Multiplicative inverse of a field element
 void f_inv(const f_elm_t a, f_elm_t b){
     f_inv_asm(a, b); }
+#endif
 
+#ifdef EULER_LEGENDRE
 // Legendre symbol of a field element
 void f_leg(const f_elm_t a, unsigned char *b){
     f_leg_asm(a, b); }
+#endif
 
 // Square root of a field element
 void f_sqrt(const f_elm_t a, f_elm_t b){
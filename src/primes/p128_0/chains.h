@@ -0,0 +1,110 @@
+// Generated by tools/addchain.py, do not edit
+// Exponentiations by fixed powers of p = 0x7FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF
+
+#ifndef CHAINS_H
+#define CHAINS_H
+
+#ifdef FERMAT_INVERSION
+// b = a^(p - 2), 126 squarings and 10 multiplications
+static void f_pow_inv(const f_elm_t a, f_elm_t b)
+{
+    f_elm_t t[3];
+    unsigned int i;
+
+    f_sqr(a, t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^3
+    f_sqr(t[0], t[1]);
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^4 - 1)
+    f_sqr(t[1], t[0]);
+    for (i = 0; i < 3; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[1], t[0]);                // t[0] = a^(2^8 - 1)
+    f_sqr(t[0], t[1]);
+    for (i = 0; i < 7; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^16 - 1)
+    for (i = 0; i < 8; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^24 - 1)
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], a, t[1]);                   // t[1] = a^(2^25 - 1)
+    f_sqr(t[1], t[0]);
+    for (i = 0; i < 24; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[1], t[0]);                // t[0] = a^(2^50 - 1)
+    f_sqr(t[0], t[2]);
+    for (i = 0; i < 49; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[0], t[2]);                // t[2] = a^(2^100 - 1)
+    for (i = 0; i < 25; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[1], t[2]);                // t[2] = a^(2^125 - 1)
+
+    // bit 0
+    f_sqr(t[2], t[2]);
+    f_sqr(t[2], t[2]);
+    f_mul(t[2], a, t[2]);
+
+    f_copy(t[2], b);
+}
+#endif
+
+#ifdef EULER_LEGENDRE
+// b = a^((p - 1)/2), 125 squarings and 9 multiplications
+static void f_pow_leg(const f_elm_t a, f_elm_t b)
+{
+    f_elm_t t[4];
+    unsigned int i;
+
+    f_sqr(a, t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^3
+    f_sqr(t[0], t[1]);
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^4 - 1)
+    f_sqr(t[1], t[2]);
+    for (i = 0; i < 3; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[1], t[2]);                // t[2] = a^(2^8 - 1)
+    f_sqr(t[2], t[1]);
+    for (i = 0; i < 7; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[2], t[1]);                // t[1] = a^(2^16 - 1)
+    f_sqr(t[1], t[3]);
+    for (i = 0; i < 15; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[1], t[3]);                // t[3] = a^(2^32 - 1)
+    for (i = 0; i < 8; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[2], t[3]);                // t[3] = a^(2^40 - 1)
+    f_sqr(t[3], t[3]);
+    f_sqr(t[3], t[3]);
+    f_mul(t[3], t[0], t[3]);                // t[3] = a^(2^42 - 1)
+    f_sqr(t[3], t[0]);
+    for (i = 0; i < 41; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[3], t[0]);                // t[0] = a^(2^84 - 1)
+    for (i = 0; i < 42; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[3], t[0]);                // t[0] = a^(2^126 - 1)
+
+    f_copy(t[0], b);
+}
+#endif
+
+// b = a^((p + 1)/4), 125 squarings and 0 multiplications
+static void f_pow_sqrt(const f_elm_t a, f_elm_t b)
+{
+    f_elm_t t[1];
+    unsigned int i;
+
+
+    // bits 124 to 0, zeros
+    f_sqr(a, t[0]);
+    for (i = 0; i < 124; i++)
+        f_sqr(t[0], t[0]);
+
+    f_copy(t[0], b);
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "arith.h"
+#include "chains.h"
 
 
 // Correction, i.e., reduction modulo p
@@ -31,6 +32,54 @@ void f_rand(f_elm_t a)
     f_red(a);   // Not uniformly random, can use rejection sampling to fix, thought it's pretty close to uniform
 }
 
+#ifdef REDUNDANT_FORM
+// Addition of two field elements, inputs and output in [0, 2p)
+// The sum is below 4p < 2^129, the bits from 2^127 up are folded back with 2^127 = 1 (mod p)
+void f_add(const f_elm_t a, const f_elm_t b, f_elm_t c)
+{
+    digit_t top, carry = 0;
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+        ADDC(carry, a[i], b[i], c[i]);
+
+    top = (carry << 1) | (c[WORDS_FIELD - 1] >> 63);
+    c[WORDS_FIELD - 1] &= 0x7FFFFFFFFFFFFFFF;
+
+    carry = 0;
+    ADDC(carry, c[0], top, c[0]);
+    for (int i = 1; i < WORDS_FIELD; i++)
+        ADDC(carry, c[i], 0, c[i]);
+}
+
+// Subtraction of two field elements, inputs and output in [0, 2p)
+// A borrow adds 2p = R - Mont_one
+void f_sub(const f_elm_t a, const f_elm_t b, f_elm_t c)
+{
+    digit_t mask, borrow = 0;
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+        SUBC(borrow, a[i], b[i], c[i]);
+
+    mask = 0 - borrow;
+    borrow = 0;
+    for (int i = 0; i < WORDS_FIELD; i++)
+        SUBC(borrow, c[i], Mont_one[i] & mask, c[i]);
+}
+
+// Negation of a field element, input and output in [0, 2p)
+void f_neg(const f_elm_t a, f_elm_t b)
+{
+    digit_t mask, borrow = 0;
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+        SUBC(borrow, 0, a[i], b[i]);
+
+    mask = 0 - borrow;
+    borrow = 0;
+    for (int i = 0; i < WORDS_FIELD; i++)
+        SUBC(borrow, b[i], Mont_one[i] & mask, b[i]);
+}
+#else
 // Addition of two field elements
 void f_add(const f_elm_t a, const f_elm_t b, f_elm_t c)
 {
@@ -73,6 +122,7 @@ void f_neg(const f_elm_t a, f_elm_t b)
 
     f_red(b);
 }
+#endif
 
 // Multiplication of two multiprecision words (without reduction)
 void mp_mul(const digit_t *a, const digit_t *b, digit_t *c)
@@ -113,12 +163,46 @@ void mp_mul(const digit_t *a, const digit_t *b, digit_t *c)
     c[2 * WORDS_FIELD - 1] = v;
 }
 
+// Squaring of a multiprecision word (without reduction)
+void mp_sqr(const digit_t *a, digit_t *c)
+{ // Product scanning squaring, the cross products a[i]*a[j] (i < j) are computed once and doubled
+    digit_t t = 0, u = 0, v = 0;
+    uint128_t uv, UV;
+
+    for (int k = 0; k < 2 * WORDS_FIELD - 1; k++)
+    {
+        for (int i = (k < WORDS_FIELD ? 0 : k - WORDS_FIELD + 1); i < k - i; i++)
+        {
+            UV = (uint128_t)a[i] * a[k - i];
+            t += (digit_t)(UV >> (2 * RADIX - 1));
+            UV <<= 1;
+            uv = (((uint128_t)u << RADIX) | v) + UV;
+            t += (uv < UV);
+            u = (digit_t)(uv >> RADIX);
+            v = (digit_t)uv;
+        }
+        if ((k & 1) == 0)
+        {
+            UV = (uint128_t)a[k / 2] * a[k / 2];
+            uv = (((uint128_t)u << RADIX) | v) + UV;
+            t += (uv < UV);
+            u = (digit_t)(uv >> RADIX);
+            v = (digit_t)uv;
+        }
+        c[k] = v;
+        v = u;
+        u = t;
+        t = 0;
+    }
+    c[2 * WORDS_FIELD - 1] = v;
+}
+
 
 // Montgomery form reduction after multiplication
 void mont_redc(const digit_t *a, digit_t *c)
 {
     // c = a*R^-1 mod p, where R = 2^256.
-    // If a < 2^256*p, the output c is in the range [0, p).
+    // If a < 2^256*p, the output c is in the range [0, p), if a < 4p^2 it is in [0, 2p).
     // a is assumed to be in Montgomery representation.
     digit_t mask, carry = 0;
     digit_t t0[2 * WORDS_FIELD], t1[WORDS_FIELD];
@@ -143,322 +227,161 @@ void mont_redc(const digit_t *a, digit_t *c)
 
 
 
-// Multiplication of field elements
+#ifdef SPECIAL_FORM_REDUCTION
+// Reduction of a double-width product modulo p = 2^127 - 1
+// a < 2^254 -> c in [0, 2^127), 2^127 = 1 (mod p) so the high part is added to the low part
+// a < 2^256 (inputs in [0, 2p)) -> c in [0, 2^127 + 3), bit 255 and the carry out of the sum are both worth 2
+void mp_red(const digit_t *a, digit_t *c)
+{
+    uint128_t t0, t1;
+    digit_t carry;
+
+    t0 = ((uint128_t)(a[1] & p[1]) << RADIX) | a[0];
+    t0 += (a[3] >> 63) << 1;
+    t1 = ((uint128_t)a[3] << (RADIX + 1)) | ((uint128_t)a[2] << 1) | (a[1] >> 63);
+    t0 += t1;
+    carry = (t0 < t1);
+    t0 = (t0 & (((uint128_t)p[1] << RADIX) | p[0])) + (t0 >> 127) + (carry << 1);
+
+    c[0] = (digit_t)t0;
+    c[1] = (digit_t)(t0 >> RADIX);
+}
+
+
+// Multiplication of field elements, inputs and output in [0, 2^k)
 void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c)
 {
-    digit_t t0[2 * WORDS_FIELD] = {0};
+    digit_t t0[2 * WORDS_FIELD];
 
     mp_mul(a, b, t0);
-    mont_redc(t0, c);
+    mp_red(t0, c);
 }
 
 
-
-// Convert a number from value to Montgomery form  (a -> aR)
-void to_mont(const digit_t *a, f_elm_t b)
+// Squaring of a field element, input and output in [0, 2^k)
+void f_sqr(const f_elm_t a, f_elm_t c)
 {
-    f_mul(a, R2, b);
+    digit_t t0[2 * WORDS_FIELD];
+
+    mp_sqr(a, t0);
+    mp_red(t0, c);
 }
 
 
-// Convert a number from Montgomery form into value (aR -> a)
-void from_mont(const f_elm_t a, digit_t *b)
+// Multiplication of n pairs of field elements, c[i] = a[i] * b[i]
+void f_mul_vec(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
 {
-    digit_t t0[2 * WORDS_FIELD] = {0};
-    f_copy(a, t0);
-    mont_redc(t0, b);
+    digit_t t0[2 * WORDS_FIELD];
+
+    for (unsigned int i = 0; i < n; i++)
+    {
+        mp_mul(a[i], b[i], t0);
+        mp_red(t0, c[i]);
+    }
 }
 
 
-// Multiplicative inverse of a field element
-void f_inv(const f_elm_t a, f_elm_t b)
+// Squaring of n field elements, c[i] = a[i]^2
+void f_sqr_vec(const f_elm_t *a, f_elm_t *c, const unsigned int n)
 {
-    f_elm_t t[6];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
+    digit_t t0[2 * WORDS_FIELD];
 
+    for (unsigned int i = 0; i < n; i++)
+    {
+        mp_sqr(a[i], t0);
+        mp_red(t0, c[i]);
+    }
+}
+#elif !defined(BARRETT_FORM)
+// Multiplication of field elements
+void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c)
+{
+    digit_t t0[2 * WORDS_FIELD] = {0};
 
-    /* p - 2 =  01111111 11111111\
-                11111111 11111111\
-                11111111 11111111\
-                11111111 11111111\
+    mp_mul(a, b, t0);
+    mont_redc(t0, c);
+}
 
-                11111111 11111111\
-                11111111 11111111\
-                11111111 11111111\
-                111111111 1111 101\
-    */
 
 
-    // bit = 127 (=0)
+// Squaring of a field element
+void f_sqr(const f_elm_t a, f_elm_t c)
+{
+    digit_t t0[2 * WORDS_FIELD] = {0};
 
-    // First 64 bits = 2^6 bits
-    for(j = 0; j < 6; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 1) f_copy(t[0], t[2]);  // a^(2^4  - 1) = a^0b 1111
-        if(j == 2) f_copy(t[0], t[3]);  // a^(2^8  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[4]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        if(j == 4) f_copy(t[0], t[5]);  // a^(2^32 - 1) = a^0b 11111111 11111111 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-    
-    /* t[3] = a ^ 0b    11111111 11111111
-                        11111111 11111111
-    */
+    mp_sqr(a, t0);
+    mont_redc(t0, c);
+}
+#endif
 
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[5], t[0]);
 
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
 
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
+#ifdef CANONICAL_FORM
+// Elements are kept in canonical form, the conversions only apply the final correction
+void to_mont(const digit_t *a, f_elm_t b)
+{
+    f_copy(a, b);
+    f_red(b);
+}
 
-    // Next 4 bits
-    for (i = 0; i < 4; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
 
-    // Next 3 bits
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0],    a, t[0]);
+void from_mont(const f_elm_t a, digit_t *b)
+{
+    f_copy(a, b);
+    f_red(b);
+}
+#else
+// Convert a number from value to Montgomery form  (a -> aR)
+void to_mont(const digit_t *a, f_elm_t b)
+{
+    f_mul(a, R2, b);
+}
 
-    f_mul(t[0], t[0], t[0]);
 
+// Convert a number from Montgomery form into value (aR -> a)
+void from_mont(const f_elm_t a, digit_t *b)
+{
+    digit_t t0[2 * WORDS_FIELD] = {0};
+    f_copy(a, t0);
+    mont_redc(t0, b);
+}
+#endif
 
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0],    a, t[0]);
 
-    f_copy(t[0], b);
 
+#ifdef FERMAT_INVERSION
+// Multiplicative inverse of a field element
+void f_inv(const f_elm_t a, f_elm_t b)
+{
+    f_pow_inv(a, b);
 }
+#endif
 
 
+#ifdef EULER_LEGENDRE
 // Legendre symbol of a field element
 void f_leg(const f_elm_t a, unsigned char *b)
 {
-
-    f_elm_t t[6];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
-
-    /* (p - 1)/2 =  00111111 11111111\
-                    11111111 11111111\
-                    11111111 11111111\
-                    11111111 11111111\
-
-                    11111111 11111111\
-                    11111111 11111111\
-
-                    11111111 11111111\
-                    11 11111111 1111 11\
-    */
-
-
-    // bit = 127 (=0)
-    // bit = 126 (=0)
-
-    // First 64 bits = 2^6 bits
-    for(j = 0; j < 6; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 1) f_copy(t[0], t[2]);  // a^(2^4  - 1) = a^0b 1111
-        if(j == 2) f_copy(t[0], t[3]);  // a^(2^8  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[4]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        if(j == 4) f_copy(t[0], t[5]);  // a^(2^32 - 1) = a^0b 11111111 11111111 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-    
-    /* t[3] = a ^ 0b    11111111 11111111
-                        11111111 11111111
-    */
-
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[5], t[0]);
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 4 bits
-    for (i = 0; i < 4; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-    // Next 2 bits
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0],    a, t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0],    a, t[0]);
-
-
-    *b = ((*(unsigned char *)t[0]) & 0x01);
-
+    f_elm_t t0;
+
+    f_pow_leg(a, t0);                       // t0 = a^((p-1)/2) = 1, -1 or 0
+
+#ifdef CANONICAL_FORM
+    f_add(t0, One, t0);                     // t0 = 0 iff a^((p-1)/2) = -1
+    *b = 1 - f_eq(t0, Zero);
+#else
+#ifdef REDUNDANT_FORM
+    f_red(t0);                              // The parity test needs the canonical representative
+#endif
+    *b = ((*(unsigned char *)t0) & 0x01);
+#endif
 }
+#endif
 
 
 // Legendre symbol of a field element
 void f_sqrt(const f_elm_t a, f_elm_t b)
 {
-
-    /* (p + 1)/4 = 0b   0010000000000000\
-                        0000000000000000\
-                        0000000000000000\
-                        0000000000000000\
-                        0000000000000000\
-                        0000000000000000\
-                        0000000000000000\
-                        0000000000000000
-        =2^125 = (2^127 - 1 + 1)/4
-    */
-
-    f_mul(a, a, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-
+    f_pow_sqrt(a, b);
 }
 
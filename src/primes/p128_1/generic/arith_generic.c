@@ -1,4 +1,5 @@
 #include "arith.h"
+#include "chains.h"
 
 
 // Correction, i.e., reduction modulo p
@@ -105,47 +106,198 @@ void mp_mul(const digit_t *a, const digit_t *b, digit_t *c)
     c[2 * WORDS_FIELD - 1] = v;
 }
 
+// Squaring of a multiprecision word (without reduction)
+void mp_sqr(const digit_t *a, digit_t *c)
+{ // Product scanning squaring, the cross products a[i]*a[j] (i < j) are computed once and doubled
+    digit_t t = 0, u = 0, v = 0;
+    uint128_t uv, UV;
+
+    for (int k = 0; k < 2 * WORDS_FIELD - 1; k++)
+    {
+        for (int i = (k < WORDS_FIELD ? 0 : k - WORDS_FIELD + 1); i < k - i; i++)
+        {
+            UV = (uint128_t)a[i] * a[k - i];
+            t += (digit_t)(UV >> (2 * RADIX - 1));
+            UV <<= 1;
+            uv = (((uint128_t)u << RADIX) | v) + UV;
+            t += (uv < UV);
+            u = (digit_t)(uv >> RADIX);
+            v = (digit_t)uv;
+        }
+        if ((k & 1) == 0)
+        {
+            UV = (uint128_t)a[k / 2] * a[k / 2];
+            uv = (((uint128_t)u << RADIX) | v) + UV;
+            t += (uv < UV);
+            u = (digit_t)(uv >> RADIX);
+            v = (digit_t)uv;
+        }
+        c[k] = v;
+        v = u;
+        u = t;
+        t = 0;
+    }
+    c[2 * WORDS_FIELD - 1] = v;
+}
+
 
 // Montgomery form reduction after multiplication
 void mont_redc(const digit_t *a, digit_t *c)
 {
     // c = a*R^-1 mod p, where R = 2^256.
     // If a < 2^256*p, the output c is in the range [0, p).
-    // a is assumed to be in Montgomery representation.
-    digit_t mask, carry = 0;
-    digit_t t0[2 * WORDS_FIELD], t1[WORDS_FIELD];
+    // Word-by-word: each step adds m*p with m = t[i]*pp[0] mod 2^64, which clears t[i].
+    digit_t t[2 * WORDS_FIELD], mask, carry, top = 0, m;
+    uint128_t uv;
+
+    for (int i = 0; i < 2 * WORDS_FIELD; i++)
+        t[i] = a[i];
 
     for (int i = 0; i < WORDS_FIELD; i++)
-        c[i] = a[i];
+    {
+        m = t[i] * pp[0];
+        uv = 0;
+        for (int j = 0; j < WORDS_FIELD; j++)
+        {
+            uv = (uint128_t)m * p[j] + t[i + j] + (digit_t)(uv >> RADIX);
+            t[i + j] = (digit_t)uv;
+        }
+        uv = (uint128_t)t[i + WORDS_FIELD] + (digit_t)(uv >> RADIX) + top;
+        t[i + WORDS_FIELD] = (digit_t)uv;
+        top = (digit_t)(uv >> RADIX);
+    }
 
-    mp_mul(c, ip, t0);
-    f_copy(t0, t1);
-    mp_mul(t1, p, t0);
+    // t / R < 2p, subtract p and add it back if that borrows
+    carry = 0;
+    for (int i = 0; i < WORDS_FIELD; i++)
+        SUBC(carry, t[WORDS_FIELD + i], p[i], c[i]);
+    SUBC(carry, top, 0, mask);
 
-    for (int i = WORDS_FIELD; i < 2 * WORDS_FIELD; i++)
-        SUBC(carry, a[i], t0[i], t0[i]);
+    carry = 0;
+    for (int i = 0; i < WORDS_FIELD; i++)
+        ADDC(carry, c[i], p[i] & mask, c[i]);
+}
 
 
-    mask = 0 - carry;
-    carry = 0;
+
+#ifdef SPECIAL_FORM_REDUCTION
+// Reduction of a double-width product modulo p = 2^k - c (canonical form)
+// Folds the high half with 2^(64*WORDS_FIELD) = Mont_one[0] (mod p), Mont_one[0] is a single word
+void mp_red(const digit_t *a, digit_t *c)
+{
+    digit_t carry;
+    uint128_t uv = 0;
+
     for (int i = 0; i < WORDS_FIELD; i++)
-        ADDC(carry, t0[WORDS_FIELD + i], p[i] & mask, c[i]);
+    {
+        uv = (uint128_t)a[WORDS_FIELD + i] * Mont_one[0] + a[i] + (digit_t)(uv >> RADIX);
+        c[i] = (digit_t)uv;
+    }
 
-}
+    // Fold the top word, if this carries out the low words are left below Mont_one[0]^2
+    uv = (uint128_t)(digit_t)(uv >> RADIX) * Mont_one[0] + c[0];
+    c[0] = (digit_t)uv;
+    carry = (digit_t)(uv >> RADIX);
+    for (int i = 1; i < WORDS_FIELD; i++)
+        ADDC(carry, c[i], 0, c[i]);
+    c[0] += Mont_one[0] & (0 - carry);
 
+    f_red(c);
+}
 
 
 // Multiplication of field elements
 void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c)
 {
-    digit_t t0[2 * WORDS_FIELD] = {0};
+    digit_t t0[2 * WORDS_FIELD];
 
     mp_mul(a, b, t0);
-    mont_redc(t0, c);
+    mp_red(t0, c);
 }
 
 
+// Squaring of a field element
+void f_sqr(const f_elm_t a, f_elm_t c)
+{
+    digit_t t0[2 * WORDS_FIELD];
 
+    mp_sqr(a, t0);
+    mp_red(t0, c);
+}
+#elif !defined(BARRETT_FORM)
+// Multiplication of field elements
+// Montgomery multiplication with coarsely integrated operand scanning (CIOS):
+// each iteration adds a*b[i] and then m*p with m = t[0]*pp[0] mod 2^64, which
+// clears the lowest word, so the product and the reduction share one pass.
+void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c)
+{
+    digit_t t[WORDS_FIELD + 2] = {0};
+    digit_t mask, carry, m;
+    uint128_t uv;
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+    {
+        // t = t + a*b[i]
+        uv = 0;
+        for (int j = 0; j < WORDS_FIELD; j++)
+        {
+            uv = (uint128_t)a[j] * b[i] + t[j] + (digit_t)(uv >> RADIX);
+            t[j] = (digit_t)uv;
+        }
+        uv = (uint128_t)t[WORDS_FIELD] + (digit_t)(uv >> RADIX);
+        t[WORDS_FIELD] = (digit_t)uv;
+        t[WORDS_FIELD + 1] = (digit_t)(uv >> RADIX);
+
+        // t = (t + m*p) / 2^64
+        m = t[0] * pp[0];
+        uv = (uint128_t)m * p[0] + t[0];
+        for (int j = 1; j < WORDS_FIELD; j++)
+        {
+            uv = (uint128_t)m * p[j] + t[j] + (digit_t)(uv >> RADIX);
+            t[j - 1] = (digit_t)uv;
+        }
+        uv = (uint128_t)t[WORDS_FIELD] + (digit_t)(uv >> RADIX);
+        t[WORDS_FIELD - 1] = (digit_t)uv;
+        t[WORDS_FIELD] = t[WORDS_FIELD + 1] + (digit_t)(uv >> RADIX);
+    }
+
+    // t < 2p, subtract p and add it back if that borrows
+    carry = 0;
+    for (int i = 0; i < WORDS_FIELD; i++)
+        SUBC(carry, t[i], p[i], c[i]);
+    SUBC(carry, t[WORDS_FIELD], 0, mask);
+
+    carry = 0;
+    for (int i = 0; i < WORDS_FIELD; i++)
+        ADDC(carry, c[i], p[i] & mask, c[i]);
+}
+
+
+
+// Squaring of a field element
+// The fused CIOS loop in f_mul beats mp_sqr followed by mont_redc here, the saved
+// cross products do not make up for the extra pass over the double-width product
+void f_sqr(const f_elm_t a, f_elm_t c)
+{
+    f_mul(a, a, c);
+}
+#endif
+
+
+
+#ifdef CANONICAL_FORM
+// Elements are kept in canonical form, the conversions are copies
+void to_mont(const digit_t *a, f_elm_t b)
+{
+    f_copy(a, b);
+}
+
+
+void from_mont(const f_elm_t a, digit_t *b)
+{
+    f_copy(a, b);
+}
+#else
 // Convert a number from value to Montgomery form  (a -> aR)
 void to_mont(const digit_t *a, f_elm_t b)
 {
@@ -160,237 +312,38 @@ void from_mont(const f_elm_t a, digit_t *b)
     f_copy(a, t0);
     mont_redc(t0, b);
 }
+#endif
 
 
 
-
-
-
+#ifdef FERMAT_INVERSION
 // Multiplicative inverse of a field element
 void f_inv(const f_elm_t a, f_elm_t b)
 {
-
-    f_elm_t t[5];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
-
-    /* p - 2 = 0b   11111111 11111111
-                    11111111 11111111
-                    11111111 11111111
-                    11111111 11111111
-
-                    11111111 11111111
-                    11111111 11111111
-
-                    11111111 11111111
-
-                    11111111 01010001
-    */
-
-    // First 64 bits = 2^6 bits
-    for(j = 0; j < 6; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 2) f_copy(t[0], t[2]);  // a^(2^8  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[3]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        if(j == 4) f_copy(t[0], t[4]);  // a^(2^32 - 1) = a^0b 11111111 11111111 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-    
-    /* t[4] = a ^ 0b    11111111 11111111
-                        11111111 11111111
-    */
-
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-    // bit = 7
-    f_mul(t[0], t[0], t[0]);
-    // bit = 6
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-    // bit = 5
-    f_mul(t[0], t[0], t[0]);
-    // bit = 4
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-    // Last 4 bits
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-
-    f_copy(t[0], b);
-
+    f_pow_inv(a, b);
 }
+#endif
 
 
+#ifdef EULER_LEGENDRE
 // Legendre symbol of a field element
 void f_leg(const f_elm_t a, unsigned char *b)
 {
+    f_elm_t t0;
 
-    f_elm_t t[5];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
-
-    /* (p - 1)/2 = 0b   0 1111111 11111111
-                        11111111 11111111
-                        11111111 11111111
-                        11111111 11111111
-
-                        11111111 11111111
-                        11111111 11111111
-
-                        11111111 11111111
-
-                        11111111 1 0101001\
-    */
-
-
-    // bit = 128 (=0)
-
-    // First 64 bits = 2^6 bits
-    for(j = 0; j < 6; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 2) f_copy(t[0], t[2]);  // a^(2^8  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[3]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        if(j == 4) f_copy(t[0], t[4]);  // a^(2^32 - 1) = a^0b 11111111 11111111 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-    
-    /* t[4] = a ^ 0b    11111111 11111111
-                        11111111 11111111
-    */
-
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-    // Bit = 6
-    f_mul(t[0], t[0], t[0]);
-    // Bit = 5
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-    // Bit = 4
-    f_mul(t[0], t[0], t[0]);
-    // Bit = 3
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-    // Bit = 2
-    f_mul(t[0], t[0], t[0]);
-    // Bit = 1
-    f_mul(t[0], t[0], t[0]);
-    // Bit = 0
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-
-
-    *b = ((*(unsigned char *)t[0]) & 0x02) >> 1;
+    f_pow_leg(a, t0);                       // t0 = a^((p-1)/2) = 1, -1 or 0
 
+#ifdef CANONICAL_FORM
+    f_add(t0, One, t0);                     // t0 = 0 iff a^((p-1)/2) = -1
+    *b = 1 - f_eq(t0, Zero);
+#else
+    *b = ((*(unsigned char *)t0) & 0x02) >> 1;
+#endif
 }
+#endif
 
 
 void f_sqrt(const f_elm_t a, f_elm_t b)
 {
-
-    f_elm_t t[5];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
-
-    /* p - 2 = 0b   00 111111 11111111
-                    11111111 11111111
-                    11111111 11111111
-                    11111111 11111111
-
-                    11111111 11111111
-                    11111111 11111111
-
-                    11111111 11111111
-
-                    11111111 11 010101
-    */
-
-    // First 64 bits = 2^6 bits
-    for(j = 0; j < 6; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 2) f_copy(t[0], t[2]);  // a^(2^8  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[3]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        if(j == 4) f_copy(t[0], t[4]);  // a^(2^32 - 1) = a^0b 11111111 11111111 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-    
-    /* t[4] = a ^ 0b    11111111 11111111
-                        11111111 11111111
-    */
-
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-    // Bit = 5
-    f_mul(t[0], t[0], t[0]);
-    // Bit = 4
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-
-    // Bit = 3
-    f_mul(t[0], t[0], t[0]);
-    // Bit = 2
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-
-    // Bit = 1
-    f_mul(t[0], t[0], t[0]);
-    // Bit = 0
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-
-    f_copy(t[0], b);
-
+    f_pow_sqrt(a, b);
 }
@@ -9,3 +9,4 @@ const digit_t pp[WORDS_FIELD]        = {0x882383B30D516325, 0x133CABA736C05EB4};
 const digit_t ip[WORDS_FIELD]        = {0x77DC7C4CF2AE9CDB, 0xECC35458C93FA14B};
 const digit_t Zero[WORDS_FIELD]      = {0x0000000000000000, 0x0000000000000000};
 const digit_t One[WORDS_FIELD]       = {0x0000000000000001, 0x0000000000000000};
+const digit_t mu[WORDS_FIELD + 1]    = {0x00000000000000AD, 0x0000000000000000, 0x0000000000000001};
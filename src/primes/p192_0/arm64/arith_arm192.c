@@ -1,4 +1,5 @@
 #include "arith.h"
+#include "chains.h"
 
 extern void f_red_asm(f_elm_t a);
 extern void f_add_asm(const digit_t* a, const digit_t* b, digit_t* c);
@@ -46,6 +47,47 @@ inline void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c){
     f_mul_asm(a, b, c); }
 
 
+// Squaring of a multiprecision word (without reduction)
+void mp_sqr(const digit_t *a, digit_t *c)
+{ // Product scanning squaring, the cross products a[i]*a[j] (i < j) are computed once and doubled
+    digit_t t = 0, u = 0, v = 0;
+    uint128_t uv, UV;
+
+    for (int k = 0; k < 2 * WORDS_FIELD - 1; k++)
+    {
+        for (int i = (k < WORDS_FIELD ? 0 : k - WORDS_FIELD + 1); i < k - i; i++)
+        {
+            UV = (uint128_t)a[i] * a[k - i];
+            t += (digit_t)(UV >> (2 * RADIX - 1));
+            UV <<= 1;
+            uv = (((uint128_t)u << RADIX) | v) + UV;
+            t += (uv < UV);
+            u = (digit_t)(uv >> RADIX);
+            v = (digit_t)uv;
+        }
+        if ((k & 1) == 0)
+        {
+            UV = (uint128_t)a[k / 2] * a[k / 2];
+            uv = (((uint128_t)u << RADIX) | v) + UV;
+            t += (uv < UV);
+            u = (digit_t)(uv >> RADIX);
+            v = (digit_t)uv;
+        }
+        c[k] = v;
+        v = u;
+        u = t;
+        t = 0;
+    }
+    c[2 * WORDS_FIELD - 1] = v;
+}
+
+
+// Squaring of a field element
+// Uses the assembly multiplier, which is still faster than mp_sqr followed by a reduction in C
+inline void f_sqr(const f_elm_t a, f_elm_t c) {
+    f_mul_asm(a, a, c); }
+
+
 // Convert a number from value to Montgomery form  (a -> aR)
 void to_mont(const digit_t *a, f_elm_t b)
 {
@@ -62,248 +104,28 @@ void from_mont(const f_elm_t a, digit_t *b)
 }
 
 
+#ifdef FERMAT_INVERSION
 // Multiplicative inverse of a field element
 void f_inv(const f_elm_t a, f_elm_t b)
 {
-    f_elm_t t[5];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
-
-    /* p - 2 =     0b   11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-
-                        11111111 11111111\
-                        11111111 11111111\
-
-                        11111111 11111111\
-
-                        11111111 00010001\
-    */
-
-    // First 128 bits = 2^7 bits
-    for(j = 0; j < 7; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 2) f_copy(t[0], t[2]);  // a^(2^8  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[3]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        if(j == 4) f_copy(t[0], t[4]);  // a^(2^32 - 1) = a^0b 11111111 11111111 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-    
-    /* t[3] = a ^ 0b 11111111 11111111
-                     11111111 11111111
-                     11111111 11111111
-                     11111111 11111111
-                     11111111 11111111
-                     11111111 11111111
-                     11111111 11111111
-                     11111111 11111111
-    */
-
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-    // Next 8 bits
-    // bit = 7
-    f_mul(t[0], t[0], t[0]);
-    // bit = 6
-    f_mul(t[0], t[0], t[0]);
-    // bit = 5
-    f_mul(t[0], t[0], t[0]);
-    // bit = 4
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-    // bit = 3
-    f_mul(t[0], t[0], t[0]);
-    // bit = 2
-    f_mul(t[0], t[0], t[0]);
-    // bit = 1
-    f_mul(t[0], t[0], t[0]);
-    // bit = 0
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-
-    f_copy(t[0], b);
-
+    f_pow_inv(a, b);
 }
+#endif
 
+#ifdef EULER_LEGENDRE
 // Legendre symbol of a field element
 void f_leg(const f_elm_t a, unsigned char *b)
 {
+    f_elm_t t0;
 
-    f_elm_t t[5];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
-
-    /* (p - 1)/2 = 0b   0 1111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 1 0001001\
-    */   
-
-    // First 128 bits = 2^7 bits
-    for(j = 0; j < 7; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 2) f_copy(t[0], t[2]);  // t[2] = a^(2^8  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[3]);  // t[3] = a^(2^16 - 1) = a^0b 11111111 11111111
-        if(j == 4) f_copy(t[0], t[4]);  // t[4] = a^(2^32 - 1) = a^0b 11111111 11111111 11111111 11111111
-        f_copy(t[0], t[1]);             // = a^(2^(2^(j+1)) - 1)
-    }
-    
-    /* t[3] = a ^ 0b 11111111 11111111
-                     11111111 11111111
-                     11111111 11111111
-                     11111111 11111111
-                     11111111 11111111
-                     11111111 11111111
-                     11111111 11111111
-                     11111111 11111111
-    */
-
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-
-    // bit = 6
-    f_mul(t[0], t[0], t[0]);
-    // bit = 5
-    f_mul(t[0], t[0], t[0]);
-    // bit = 4
-    f_mul(t[0], t[0], t[0]);
-    // bit = 3
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-    // bit = 2
-    f_mul(t[0], t[0], t[0]);
-    // bit = 1
-    f_mul(t[0], t[0], t[0]);
-    // bit = 0
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-
-    *b = ((*(unsigned char *)(t[0])) & 0x02) >> 1;
+    f_pow_leg(a, t0);                       // t0 = a^((p-1)/2) = 1, -1 or 0
 
+    *b = ((*(unsigned char *)t0) & 0x02) >> 1;
 }
+#endif
 
 // Multiplicative inverse of a field element
 void f_sqrt(const f_elm_t a, f_elm_t b)
 {
-    f_elm_t t[5];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
-
-    /* (p + 1)/4 = 0b   00 111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-
-                        11111111 11111111\
-                        11111111 11111111\
-
-                        11111111 11111111\
-
-                        11111111 11 000101\
-    */
-
-    // First 128 bits = 2^7 bits
-    for(j = 0; j < 7; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 2) f_copy(t[0], t[2]);  // a^(2^4  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[3]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        if(j == 4) f_copy(t[0], t[4]);  // a^(2^32 - 1) = a^0b 11111111 11111111 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-    
-    /* t[4] = a ^ 0b 11111111 11111111
-                     11111111 11111111
-    */
-
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-    // Next 6 bits
-    // Bit = 5
-    f_mul(t[0], t[0], t[0]);
-    // Bit = 4
-    f_mul(t[0], t[0], t[0]);
-    // Bit = 3
-    f_mul(t[0], t[0], t[0]);
-    // Bit = 2
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-    // Bit = 1
-    f_mul(t[0], t[0], t[0]);
-    // Bit = 0
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-
-    f_copy(t[0], b);
-
+    f_pow_sqrt(a, b);
 }
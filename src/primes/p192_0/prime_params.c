@@ -9,3 +9,4 @@ const digit_t pp[WORDS_FIELD]        = {0xDE83C7D4CB125CE5, 0xF1F532C497393FBA,
 const digit_t ip[WORDS_FIELD]        = {0x217C382B34EDA31B, 0x0E0ACD3B68C6C045, 0xB34EDA31B011485F};
 const digit_t Zero[WORDS_FIELD]      = {0x0000000000000000, 0x0000000000000000, 0x0000000000000000};
 const digit_t One[WORDS_FIELD]       = {0x0000000000000001, 0x0000000000000000, 0x0000000000000000};
+const digit_t mu[WORDS_FIELD + 1]    = {0x00000000000000ED, 0x0000000000000000, 0x0000000000000000, 0x0000000000000001};
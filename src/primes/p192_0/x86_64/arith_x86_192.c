@@ -0,0 +1,115 @@
+#include "arith.h"
+#include "chains.h"
+
+extern void f_red_asm(f_elm_t a);
+extern void f_add_asm(const f_elm_t a, const f_elm_t b, f_elm_t c);
+extern void f_neg_asm(const f_elm_t a, f_elm_t b);
+extern void f_sub_asm(const f_elm_t a, const f_elm_t b, f_elm_t c);
+extern void mp_mul_asm(const digit_t* a, const digit_t* b, digit_t* c);
+extern void mont_redc_asm(const digit_t* a, digit_t* c);
+extern void f_mul_asm(const f_elm_t a, const f_elm_t b, f_elm_t c);
+extern void mp_sqr_asm(const digit_t* a, digit_t* c);
+extern void f_sqr_asm(const f_elm_t a, f_elm_t c);
+
+
+// Reduction modulo p
+// a in [0, R - 1] -> a in [0, p-1]
+inline void f_red(f_elm_t a) {
+    f_red_asm(a); }
+
+
+// Generate a random field element
+void f_rand(f_elm_t a)
+{
+    randombytes((unsigned char *)a, sizeof(digit_t) * WORDS_FIELD);
+    f_red(a); // Not uniformly random, can use rejection sampling to fix, thought it's pretty close to uniform
+}
+
+
+// Addition of two field elements
+inline void f_add(const f_elm_t a, const f_elm_t b, f_elm_t c) {
+    f_add_asm(a, b, c); }
+
+
+// Negation of a field element
+inline void f_neg(const f_elm_t a, f_elm_t b) {
+    f_neg_asm(a, b); }
+
+
+// Subtraction of two field elements
+inline void f_sub(const f_elm_t a, const f_elm_t b, f_elm_t c) {
+    f_sub_asm(a, b, c); }
+
+
+// Multiplication of two multiprecision words (without reduction)
+inline void mp_mul(const digit_t *a, const digit_t *b, digit_t *c) {
+    mp_mul_asm(a, b, c); }
+
+
+// Montgomery form reduction after multiplication
+// a < p * R -> c = a * R^-1 mod p in [0, p-1]
+inline void mont_redc(const digit_t *a, digit_t *c) {
+    mont_redc_asm(a, c); }
+
+
+// Multiplication of field elements
+inline void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c) {
+    f_mul_asm(a, b, c); }
+
+
+// Squaring of a multiprecision word (without reduction)
+inline void mp_sqr(const digit_t *a, digit_t *c) {
+    mp_sqr_asm(a, c); }
+
+
+// Squaring of a field element
+inline void f_sqr(const f_elm_t a, f_elm_t c) {
+    f_sqr_asm(a, c); }
+
+
+
+// Convert a number from value to Montgomery form  (a -> aR)
+void to_mont(const digit_t *a, f_elm_t b)
+{
+    f_mul(a, R2, b);
+}
+
+
+// Convert a number from Montgomery form into value (aR -> a)
+void from_mont(const f_elm_t a, digit_t *b)
+{
+    digit_t t0[2 * WORDS_FIELD] = {0};
+    f_copy(a, t0);
+    mont_redc(t0, b);
+}
+
+
+
+
+
+#ifdef FERMAT_INVERSION
+// Multiplicative inverse of a field element
+void f_inv(const f_elm_t a, f_elm_t b)
+{
+    f_pow_inv(a, b);
+}
+#endif
+
+#ifdef EULER_LEGENDRE
+// Legendre symbol of a field element
+void f_leg(const f_elm_t a, unsigned char *b)
+{
+    f_elm_t t0;
+
+    f_pow_leg(a, t0);                       // t0 = a^((p-1)/2) = 1, -1 or 0
+
+    *b = ((*(unsigned char *)t0) & 0x02) >> 1;
+}
+#endif
+
+// Multiplicative inverse of a field element
+void f_sqrt(const f_elm_t a, f_elm_t b)
+{
+    f_pow_sqrt(a, b);
+}
+
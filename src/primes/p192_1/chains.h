@@ -0,0 +1,169 @@
+// Generated by tools/addchain.py, do not edit
+// Exponentiations by fixed powers of p = 0x7FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFED
+
+#ifndef CHAINS_H
+#define CHAINS_H
+
+#ifdef FERMAT_INVERSION
+// b = a^(p - 2), 190 squarings and 12 multiplications
+static void f_pow_inv(const f_elm_t a, f_elm_t b)
+{
+    f_elm_t t[4];
+    unsigned int i;
+
+    f_sqr(a, t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^3
+    f_sqr(t[0], t[1]);
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^4 - 1)
+    f_sqr(t[1], t[2]);
+    for (i = 0; i < 3; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[1], t[2]);                // t[2] = a^(2^8 - 1)
+    f_sqr(t[2], t[1]);
+    for (i = 0; i < 7; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[2], t[1]);                // t[1] = a^(2^16 - 1)
+    f_sqr(t[1], t[3]);
+    for (i = 0; i < 15; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[1], t[3]);                // t[3] = a^(2^32 - 1)
+    f_sqr(t[3], t[1]);
+    for (i = 0; i < 7; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[2], t[1]);                // t[1] = a^(2^40 - 1)
+    f_sqr(t[1], t[2]);
+    for (i = 0; i < 31; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[3], t[2]);                // t[2] = a^(2^72 - 1)
+    f_sqr(t[2], t[3]);
+    for (i = 0; i < 71; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[2], t[3]);                // t[3] = a^(2^144 - 1)
+    for (i = 0; i < 40; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[1], t[3]);                // t[3] = a^(2^184 - 1)
+    f_sqr(t[3], t[3]);
+    f_sqr(t[3], t[3]);
+    f_mul(t[3], t[0], t[3]);                // t[3] = a^(2^186 - 1)
+
+    // bit 3
+    f_sqr(t[3], t[3]);
+    f_sqr(t[3], t[3]);
+    f_mul(t[3], a, t[3]);
+
+    // bits 1 to 0, 2 ones
+    for (i = 0; i < 3; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[0], t[3]);
+
+    f_copy(t[3], b);
+}
+#endif
+
+#ifdef EULER_LEGENDRE
+// b = a^((p - 1)/2), 189 squarings and 11 multiplications
+static void f_pow_leg(const f_elm_t a, f_elm_t b)
+{
+    f_elm_t t[4];
+    unsigned int i;
+
+    f_sqr(a, t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^3
+    f_sqr(t[0], t[1]);
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^4 - 1)
+    f_sqr(t[1], t[2]);
+    for (i = 0; i < 3; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[1], t[2]);                // t[2] = a^(2^8 - 1)
+    f_sqr(t[2], t[1]);
+    for (i = 0; i < 7; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[2], t[1]);                // t[1] = a^(2^16 - 1)
+    f_sqr(t[1], t[3]);
+    for (i = 0; i < 15; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[1], t[3]);                // t[3] = a^(2^32 - 1)
+    f_sqr(t[3], t[1]);
+    for (i = 0; i < 7; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[2], t[1]);                // t[1] = a^(2^40 - 1)
+    f_sqr(t[1], t[2]);
+    for (i = 0; i < 31; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[3], t[2]);                // t[2] = a^(2^72 - 1)
+    f_sqr(t[2], t[3]);
+    for (i = 0; i < 71; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[2], t[3]);                // t[3] = a^(2^144 - 1)
+    for (i = 0; i < 40; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[1], t[3]);                // t[3] = a^(2^184 - 1)
+    f_sqr(t[3], t[3]);
+    f_sqr(t[3], t[3]);
+    f_mul(t[3], t[0], t[3]);                // t[3] = a^(2^186 - 1)
+
+    // bits 2 to 1, 2 ones
+    for (i = 0; i < 3; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[0], t[3]);
+
+    // bits 0 to 0, zeros
+    f_sqr(t[3], t[3]);
+
+    f_copy(t[3], b);
+}
+#endif
+
+// b = a^((p - 5)/8), 187 squarings and 11 multiplications
+static void f_pow_sqrt(const f_elm_t a, f_elm_t b)
+{
+    f_elm_t t[4];
+    unsigned int i;
+
+    f_sqr(a, t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^3
+    f_sqr(t[0], t[1]);
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^4 - 1)
+    f_sqr(t[1], t[2]);
+    for (i = 0; i < 3; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[1], t[2]);                // t[2] = a^(2^8 - 1)
+    f_sqr(t[2], t[1]);
+    for (i = 0; i < 7; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[2], t[1]);                // t[1] = a^(2^16 - 1)
+    f_sqr(t[1], t[3]);
+    for (i = 0; i < 15; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[1], t[3]);                // t[3] = a^(2^32 - 1)
+    f_sqr(t[3], t[1]);
+    for (i = 0; i < 7; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[2], t[1]);                // t[1] = a^(2^40 - 1)
+    f_sqr(t[1], t[2]);
+    for (i = 0; i < 31; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[3], t[2]);                // t[2] = a^(2^72 - 1)
+    f_sqr(t[2], t[3]);
+    for (i = 0; i < 71; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[2], t[3]);                // t[3] = a^(2^144 - 1)
+    for (i = 0; i < 40; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[1], t[3]);                // t[3] = a^(2^184 - 1)
+    f_sqr(t[3], t[3]);
+    f_sqr(t[3], t[3]);
+    f_mul(t[3], t[0], t[3]);                // t[3] = a^(2^186 - 1)
+
+    // bit 0
+    f_sqr(t[3], t[3]);
+    f_sqr(t[3], t[3]);
+    f_mul(t[3], a, t[3]);
+
+    f_copy(t[3], b);
+}
+
+#endif
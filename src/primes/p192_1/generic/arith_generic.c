@@ -1,4 +1,5 @@
 #include "arith.h"
+#include "chains.h"
 
 
 // Reduction modulo p
@@ -35,6 +36,54 @@ void f_rand(f_elm_t a)
     f_red(a); // Not uniformly random, can use rejection sampling to fix, thought it's pretty close to uniform
 }
 
+#ifdef REDUNDANT_FORM
+// Addition of two field elements, inputs and output in [0, 2p)
+// The sum is below 4p < 2^193, the bits from 2^191 up are folded back with 2^191 = 19 (mod p)
+void f_add(const f_elm_t a, const f_elm_t b, f_elm_t c)
+{
+    digit_t top, carry = 0;
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+        ADDC(carry, a[i], b[i], c[i]);
+
+    top = (carry << 1) | (c[WORDS_FIELD - 1] >> 63);
+    c[WORDS_FIELD - 1] &= 0x7FFFFFFFFFFFFFFF;
+
+    carry = 0;
+    ADDC(carry, c[0], top * 0x0000000000000013, c[0]);
+    for (int i = 1; i < WORDS_FIELD; i++)
+        ADDC(carry, c[i], 0, c[i]);
+}
+
+// Subtraction of two field elements, inputs and output in [0, 2p)
+// A borrow adds 2p = R - Mont_one
+void f_sub(const f_elm_t a, const f_elm_t b, f_elm_t c)
+{
+    digit_t mask, borrow = 0;
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+        SUBC(borrow, a[i], b[i], c[i]);
+
+    mask = 0 - borrow;
+    borrow = 0;
+    for (int i = 0; i < WORDS_FIELD; i++)
+        SUBC(borrow, c[i], Mont_one[i] & mask, c[i]);
+}
+
+// Negation of a field element, input and output in [0, 2p)
+void f_neg(const f_elm_t a, f_elm_t b)
+{
+    digit_t mask, borrow = 0;
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+        SUBC(borrow, 0, a[i], b[i]);
+
+    mask = 0 - borrow;
+    borrow = 0;
+    for (int i = 0; i < WORDS_FIELD; i++)
+        SUBC(borrow, b[i], Mont_one[i] & mask, b[i]);
+}
+#else
 // Addition of two field elements
 void f_add(const f_elm_t a, const f_elm_t b, f_elm_t c)
 {
@@ -77,6 +126,7 @@ void f_neg(const f_elm_t a, f_elm_t b)
 
     f_red(b);
 }
+#endif
 
 // Multiplication of two multiprecision words (without reduction)
 void mp_mul(const digit_t *a, const digit_t *b, digit_t *c)
@@ -117,32 +167,124 @@ void mp_mul(const digit_t *a, const digit_t *b, digit_t *c)
     c[2 * WORDS_FIELD - 1] = v;
 }
 
+// Squaring of a multiprecision word (without reduction)
+void mp_sqr(const digit_t *a, digit_t *c)
+{ // Product scanning squaring, the cross products a[i]*a[j] (i < j) are computed once and doubled
+    digit_t t = 0, u = 0, v = 0;
+    uint128_t uv, UV;
+
+    for (int k = 0; k < 2 * WORDS_FIELD - 1; k++)
+    {
+        for (int i = (k < WORDS_FIELD ? 0 : k - WORDS_FIELD + 1); i < k - i; i++)
+        {
+            UV = (uint128_t)a[i] * a[k - i];
+            t += (digit_t)(UV >> (2 * RADIX - 1));
+            UV <<= 1;
+            uv = (((uint128_t)u << RADIX) | v) + UV;
+            t += (uv < UV);
+            u = (digit_t)(uv >> RADIX);
+            v = (digit_t)uv;
+        }
+        if ((k & 1) == 0)
+        {
+            UV = (uint128_t)a[k / 2] * a[k / 2];
+            uv = (((uint128_t)u << RADIX) | v) + UV;
+            t += (uv < UV);
+            u = (digit_t)(uv >> RADIX);
+            v = (digit_t)uv;
+        }
+        c[k] = v;
+        v = u;
+        u = t;
+        t = 0;
+    }
+    c[2 * WORDS_FIELD - 1] = v;
+}
+
 
 // Montgomery form reduction after multiplication
 void mont_redc(const digit_t *a, digit_t *c)
 {
     // c = a*R^-1 mod p, where R = 2^256.
-    // If a < 2^256*p, the output c is in the range [0, p).
-    // a is assumed to be in Montgomery representation.
-    digit_t mask, carry = 0;
-    digit_t t0[2 * WORDS_FIELD], t1[WORDS_FIELD];
+    // If a < 2^256*p, the output c is in the range [0, p), if a < 4p^2 it is in [0, 2p).
+    // Word-by-word: each step adds m*p with m = t[i]*pp[0] mod 2^64, which clears t[i].
+    digit_t t[2 * WORDS_FIELD], mask, carry, top = 0, m;
+    uint128_t uv;
 
-    mp_mul(a, ip, t0);
-    f_copy(t0, t1);
-    mp_mul(t1, p, t0);
+    for (int i = 0; i < 2 * WORDS_FIELD; i++)
+        t[i] = a[i];
 
-    for (int i = WORDS_FIELD; i < 2 * WORDS_FIELD; i++)
-        SUBC(carry, a[i], t0[i], t0[i]);
+    for (int i = 0; i < WORDS_FIELD; i++)
+    {
+        m = t[i] * pp[0];
+        uv = 0;
+        for (int j = 0; j < WORDS_FIELD; j++)
+        {
+            uv = (uint128_t)m * p[j] + t[i + j] + (digit_t)(uv >> RADIX);
+            t[i + j] = (digit_t)uv;
+        }
+        uv = (uint128_t)t[i + WORDS_FIELD] + (digit_t)(uv >> RADIX) + top;
+        t[i + WORDS_FIELD] = (digit_t)uv;
+        top = (digit_t)(uv >> RADIX);
+    }
 
+    // t / R < 2p (3p for a < 4p^2), subtract p and add it back if that borrows
+    carry = 0;
+    for (int i = 0; i < WORDS_FIELD; i++)
+        SUBC(carry, t[WORDS_FIELD + i], p[i], c[i]);
+    SUBC(carry, top, 0, mask);
 
-    mask = 0 - carry;
     carry = 0;
     for (int i = 0; i < WORDS_FIELD; i++)
-        ADDC(carry, t0[WORDS_FIELD + i], p[i] & mask, c[i]);
+        ADDC(carry, c[i], p[i] & mask, c[i]);
+}
+
+
+#ifdef SPECIAL_FORM_REDUCTION
+// Reduction of a double-width product modulo p = 2^k - c (canonical form)
+// Folds the high half with 2^(64*WORDS_FIELD) = Mont_one[0] (mod p), Mont_one[0] is a single word
+void mp_red(const digit_t *a, digit_t *c)
+{
+    digit_t carry;
+    uint128_t uv = 0;
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+    {
+        uv = (uint128_t)a[WORDS_FIELD + i] * Mont_one[0] + a[i] + (digit_t)(uv >> RADIX);
+        c[i] = (digit_t)uv;
+    }
+
+    // Fold the top word, if this carries out the low words are left below Mont_one[0]^2
+    uv = (uint128_t)(digit_t)(uv >> RADIX) * Mont_one[0] + c[0];
+    c[0] = (digit_t)uv;
+    carry = (digit_t)(uv >> RADIX);
+    for (int i = 1; i < WORDS_FIELD; i++)
+        ADDC(carry, c[i], 0, c[i]);
+    c[0] += Mont_one[0] & (0 - carry);
+
+    f_red(c);
+}
 
+
+// Multiplication of field elements
+void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c)
+{
+    digit_t t0[2 * WORDS_FIELD];
+
+    mp_mul(a, b, t0);
+    mp_red(t0, c);
 }
 
 
+// Squaring of a field element
+void f_sqr(const f_elm_t a, f_elm_t c)
+{
+    digit_t t0[2 * WORDS_FIELD];
+
+    mp_sqr(a, t0);
+    mp_red(t0, c);
+}
+#elif !defined(BARRETT_FORM)
 // Multiplication of field elements
 void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c)
 {
@@ -154,6 +296,34 @@ void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c)
 
 
 
+// Squaring of a field element
+void f_sqr(const f_elm_t a, f_elm_t c)
+{
+    digit_t t0[2 * WORDS_FIELD] = {0};
+
+    mp_sqr(a, t0);
+    mont_redc(t0, c);
+}
+#endif
+
+
+
+#ifdef CANONICAL_FORM
+// Elements are kept in canonical form (products only with REDUNDANT_FORM), the conversions are copies
+void to_mont(const digit_t *a, f_elm_t b)
+{
+    f_copy(a, b);
+}
+
+
+void from_mont(const f_elm_t a, digit_t *b)
+{
+    f_copy(a, b);
+#ifdef REDUNDANT_FORM
+    f_red(b);
+#endif
+}
+#else
 // Convert a number from value to Montgomery form  (a -> aR)
 void to_mont(const digit_t *a, f_elm_t b)
 {
@@ -168,273 +338,68 @@ void from_mont(const f_elm_t a, digit_t *b)
     f_copy(a, t0);
     mont_redc(t0, b);
 }
+#endif
+
+
 
+#ifdef FERMAT_INVERSION
 // Multiplicative inverse of a field element
 void f_inv(const f_elm_t a, f_elm_t b)
 {
-    f_elm_t t[6];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
-
-    /* p - 2 =     0b   01111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-                        
-                        11111111 11111111\
-                        11111111 11111111\
-                        
-                        11111111 11111111\
-                        
-                        11111111 1 1101011
-    */
-
-    // First 128 bits = 2^7 bits
-    for(j = 0; j < 7; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 0) f_copy(t[0], t[5]);  // a^(2^2  - 1) = a^0b 11
-        if(j == 2) f_copy(t[0], t[2]);  // a^(2^8  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[3]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        if(j == 4) f_copy(t[0], t[4]);  // a^(2^32 - 1) = a^0b 11111111 11111111 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-    
-    /* t[4] = a ^ 0b 11111111 11111111
-                     11111111 11111111
-    */
-
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-    // Next 7 bits
-    // Bit = 6, 5
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[5], t[0]);
-    // Bit = 4
-    f_mul(t[0], t[0], t[0]);
-    // Bit = 3
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-    // Bit = 2
-    f_mul(t[0], t[0], t[0]);
-    // Bits = 1, 0
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[5], t[0]);
-
-    f_copy(t[0], b);
-
+    f_pow_inv(a, b);
 }
+#endif
 
 
+#ifdef EULER_LEGENDRE
 // Legendre symbol of a field element
 void f_leg(const f_elm_t a, unsigned char *b)
 {
-
-    f_elm_t t[6];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
-
-    /* (p - 1)/2 = 0b   00111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-                        11111111 11111111\
-                        
-                        11111111 11111111\
-                        11111111 11111111\
-                        
-                        11111111 11111111\
-                        
-                        11111111 11 110110
-    */
-
-    // First 128 bits = 2^7 bits
-    for(j = 0; j < 7; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 0) f_copy(t[0], t[5]);  // a^(2^2  - 1) = a^0b 11
-        if(j == 2) f_copy(t[0], t[2]);  // a^(2^8  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[3]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        if(j == 4) f_copy(t[0], t[4]);  // a^(2^32 - 1) = a^0b 11111111 11111111 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-    
-    /* t[4] = a ^ 0b 11111111 11111111
-                     11111111 11111111
-    */
-
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-    // Bits = 5, 4
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[5], t[0]);
-    // Bit = 3
-    f_mul(t[0], t[0], t[0]);
-    // Bits = 2, 1
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[5], t[0]);
-    // Bit = 0
-    f_mul(t[0], t[0], t[0]);
-
-    *b = ((*(unsigned char *)(t[0])) & 0x01);
-
+    f_elm_t t0;
+
+    f_pow_leg(a, t0);                       // t0 = a^((p-1)/2) = 1, -1 or 0
+
+#ifdef CANONICAL_FORM
+    f_add(t0, One, t0);                     // t0 = 0 iff a^((p-1)/2) = -1
+    *b = 1 - f_eq(t0, Zero);
+#else
+#ifdef REDUNDANT_FORM
+    f_red(t0);                              // The parity test needs the canonical representative
+#endif
+    *b = ((*(unsigned char *)t0) & 0x01);
+#endif
 }
+#endif
 
 
 
 // Multiplicative inverse of a field element
 void f_sqrt(const f_elm_t a, f_elm_t b)
 {
-    f_elm_t t[6];
+
+    f_elm_t t[3];
+#ifdef CANONICAL_FORM
+    f_elm_t psi = {0xBD7E9EFA2231B635, 0xEA189A3A6CF80B5C, 0x67097B812847D61C}; // psi = sqrt(-1)
+#else
     f_elm_t psi = {0x20CB992113610E18, 0xBFA6E4AC2CD1AFC4, 0x4B68552BFAA9C84A};
-    unsigned int i, j;
+#endif
+    unsigned int i;
     digit_t mask = 0;
 
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
-
-    /* d = (p - 1)/4 = 0b   000 11111 11111111\
-                            11111111 11111111\
-                            11111111 11111111\
-                            11111111 11111111\
-
-                            11111111 11111111\
-                            11111111 11111111\
-                            11111111 11111111\
-                            11111111 11111111\
-
-                            11111111 11111111\
-                            11111111 11111111\
-
-                            11111111 11111111\
-
-                            11111111 111 11 011
-    */
-
-    /* (d + 1)/2     = 0b   0000 1111 11111111\
-                            11111111 11111111\
-                            11111111 11111111\
-                            11111111 11111111\
-
-                            11111111 11111111\
-                            11111111 11111111\
-                            11111111 11111111\
-                            11111111 11111111\
-
-                            11111111 11111111\
-                            11111111 11111111\
-
-                            11111111 11111111\
-
-                            11111111 1111 11 10
-    */
-
-    // First 128 bits = 2^7 bits
-    for(j = 0; j < 7; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 0) f_copy(t[0], t[5]);  // a^(2^2  - 1) = a^0b 11
-        if(j == 2) f_copy(t[0], t[2]);  // a^(2^4  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[3]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        if(j == 4) f_copy(t[0], t[4]);  // a^(2^32 - 1) = a^0b 11111111 11111111 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-    
-    /* t[4] = a ^ 0b 11111111 11111111
-                     11111111 11111111
-    */
-
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-    // Next 2 bits
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[5], t[0]);
-
-    // Next 1 bit
-    f_mul(t[0], t[0], t[0]);
-
-
-    // t[1] = a^d
-    f_mul(t[0], t[0], t[1]);
-    f_mul(t[1], t[1], t[1]);
-    f_mul(t[1], t[5], t[1]);
-
-
-    // t[0] = a^(d+1)/2
-    f_mul(t[0], a, t[0]);
-    f_mul(t[0], t[0], t[0]);
+    f_pow_sqrt(a, t[0]);                    // t[0] = a^((p-5)/8)
+    f_sqr(t[0], t[1]);
+    f_mul(t[1], a, t[1]);                   // t[1] = a^((p-1)/4) = 1 or -1 for a square
+    f_mul(t[0], a, t[0]);                   // t[0] = a^((p+3)/8)
 
     // t[0] has to be multiplied with 1 if t[1] is 1, and with psi if t[1] is -1
-    mask = 0 - (((digit_t) f_eq(t[1], Mont_one)) & 0x01);
+    mask = 0 - (((digit_t) f_eq(t[1], F_ONE)) & 0x01);
     
     for(i = 0; i < WORDS_FIELD; i++){
-        psi[i] = (psi[i] ^ Mont_one[i]) & mask;
-        psi[i] ^= Mont_one[i];
+        psi[i] = (psi[i] ^ F_ONE[i]) & mask;
+        psi[i] ^= F_ONE[i];
     }
 
     f_mul(t[0], psi, t[0]);
 
     f_copy(t[0], b);
-
-
 }
\ No newline at end of file
@@ -9,3 +9,4 @@ const digit_t pp[WORDS_FIELD]        = {0x86BCA1AF286BCA1B, 0xBCA1AF286BCA1AF2,
 const digit_t ip[WORDS_FIELD]        = {0x79435E50D79435E5, 0x435E50D79435E50D, 0xDE50D79435E50D79};
 const digit_t Zero[WORDS_FIELD]      = {0x0000000000000000, 0x0000000000000000, 0x0000000000000000};
 const digit_t One[WORDS_FIELD]       = {0x0000000000000001, 0x0000000000000000, 0x0000000000000000};
+const digit_t mu[WORDS_FIELD + 1]    = {0x000000000000004C, 0x0000000000000000, 0x0000000000000000, 0x0000000000000002};
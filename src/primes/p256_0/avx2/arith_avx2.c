@@ -0,0 +1,313 @@
+#include "arith.h"
+#include "dispatch.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #include <immintrin.h>
+    #define X4_AVX2
+#endif
+
+// Four p256_0 elements in radix 2^25.5, limb-major with one 64-bit lane per element: a[i][k] is limb i of element k
+// Limb i sits at bit ceil(25.5*i), even limbs have 26 bits and odd limbs 25, values are plain (no Montgomery form).
+// f_mul_x4/f_sqr_x4 return reduced elements, limbs below 2^26 (even) and 2^25 (odd) except limb 1, which stays below 2^25 + 2^18.
+// f_sub_x4 takes reduced elements, one f_add_x4 or f_sub_x4 of reduced elements can be fed back into f_mul_x4/f_sqr_x4.
+// Every limb product uses the low 32 bits of each 64-bit lane, 19*g stays below 2^32 within these bounds.
+
+#define MASK26  MASK(26, 0)
+#define MASK25  MASK(25, 0)
+
+static const int limb_pos[10]   = {0, 26, 51, 77, 102, 128, 153, 179, 204, 230};
+static const int limb_bits[10]  = {26, 25, 26, 25, 26, 25, 26, 25, 26, 25};
+
+// 2p in radix 2^25.5, f_sub_x4 adds it so that the limbs stay positive
+static const digit_t p2_limb[10] = {0x7FFFFDA, 0x3FFFFFE, 0x7FFFFFE, 0x3FFFFFE, 0x7FFFFFE, 0x3FFFFFE, 0x7FFFFFE, 0x3FFFFFE, 0x7FFFFFE, 0x3FFFFFE};
+
+
+// Four field elements -> vector layout, through their plain values
+void f_pack_x4(const f_elm_t a[4], f_elm_x4_t b)
+{
+    f_elm_t t;
+
+    for (int k = 0; k < 4; k++)
+    {
+        from_mont(a[k], t);
+        for (int i = 0; i < 10; i++)
+        {
+            int w = limb_pos[i] >> 6, s = limb_pos[i] & 63;
+            digit_t x = t[w] >> s;
+            if (s + limb_bits[i] > 64 && w < WORDS_FIELD - 1)
+                x |= t[w + 1] << (64 - s);
+            b[i][k] = (i == 9) ? x : x & MASK(limb_bits[i], 0);     // bit 255 stays in the top limb
+        }
+    }
+}
+
+
+// Carry limb i into limb i + 1, the top limb is folded back with 2^255 = 19 (mod p)
+static inline void x4_carry_lane(digit_t *h)
+{
+    for (int i = 0; i < 9; i++)
+    {
+        h[i + 1] += h[i] >> limb_bits[i];
+        h[i] &= MASK(limb_bits[i], 0);
+    }
+    h[0] += (h[9] >> 25) * 19;
+    h[9] &= MASK25;
+}
+
+
+// Vector layout -> four field elements, each lane is reduced to its canonical value first
+void f_unpack_x4(const f_elm_x4_t a, f_elm_t b[4])
+{
+    digit_t h[10];
+    f_elm_t t;
+
+    for (int k = 0; k < 4; k++)
+    {
+        for (int i = 0; i < 10; i++)
+            h[i] = a[i][k];
+
+        // h in [0, 2^255) with every limb in range
+        x4_carry_lane(h);
+        x4_carry_lane(h);
+
+        // h + 19 is at least 2^255 iff h >= p, add 19 and carry, then subtract the 19 again modulo 2^255
+        h[0] += 19;
+        x4_carry_lane(h);
+        h[0] += (1ULL << 26) - 19;
+        for (int i = 1; i < 10; i++)
+            h[i] += (1ULL << limb_bits[i]) - 1;
+        for (int i = 0; i < 9; i++)
+        {
+            h[i + 1] += h[i] >> limb_bits[i];
+            h[i] &= MASK(limb_bits[i], 0);
+        }
+        h[9] &= MASK25;
+
+        for (int i = 0; i < WORDS_FIELD; i++)
+            t[i] = 0;
+        for (int i = 0; i < 10; i++)
+        {
+            int w = limb_pos[i] >> 6, s = limb_pos[i] & 63;
+            t[w] |= h[i] << s;
+            if (s + limb_bits[i] > 64)
+                t[w + 1] |= h[i] >> (64 - s);
+        }
+        to_mont(t, b[k]);
+    }
+}
+
+
+// Portable kernels, used when AVX2 is not available
+
+static void f_add_x4_generic(const f_elm_x4_t a, const f_elm_x4_t b, f_elm_x4_t c)
+{
+    for (int i = 0; i < 10; i++)
+        for (int k = 0; k < 4; k++)
+            c[i][k] = a[i][k] + b[i][k];
+}
+
+
+static void f_sub_x4_generic(const f_elm_x4_t a, const f_elm_x4_t b, f_elm_x4_t c)
+{
+    for (int i = 0; i < 10; i++)
+        for (int k = 0; k < 4; k++)
+            c[i][k] = a[i][k] + p2_limb[i] - b[i][k];
+}
+
+
+// h[(i + j) mod 10] += f[i]*g[j], doubled when i and j are both odd, times 19 when i + j >= 10
+static void f_mul_x4_generic(const f_elm_x4_t a, const f_elm_x4_t b, f_elm_x4_t c)
+{
+    digit_t f[10], f2[10], g[10], g19[10], h[10];
+
+    for (int k = 0; k < 4; k++)
+    {
+        for (int i = 0; i < 10; i++)
+        {
+            f[i] = a[i][k];
+            f2[i] = (i & 1) ? 2 * f[i] : f[i];
+            g[i] = b[i][k];
+            g19[i] = 19 * g[i];
+            h[i] = 0;
+        }
+
+        for (int i = 0; i < 10; i++)
+            for (int j = 0; j < 10; j++)
+                h[(i + j) % 10] += (j & 1 ? f2[i] : f[i]) * (i + j >= 10 ? g19[j] : g[j]);
+
+        x4_carry_lane(h);
+        h[1] += h[0] >> 26;
+        h[0] &= MASK26;
+
+        for (int i = 0; i < 10; i++)
+            c[i][k] = h[i];
+    }
+}
+
+
+#ifdef X4_AVX2
+__attribute__((target("avx2")))
+static void f_add_x4_avx2(const f_elm_x4_t a, const f_elm_x4_t b, f_elm_x4_t c)
+{
+    #pragma GCC unroll 10
+    for (int i = 0; i < 10; i++)
+        _mm256_storeu_si256((__m256i *)c[i], _mm256_add_epi64(_mm256_loadu_si256((const __m256i *)a[i]), _mm256_loadu_si256((const __m256i *)b[i])));
+}
+
+
+__attribute__((target("avx2")))
+static void f_sub_x4_avx2(const f_elm_x4_t a, const f_elm_x4_t b, f_elm_x4_t c)
+{
+    #pragma GCC unroll 10
+    for (int i = 0; i < 10; i++)
+    {
+        __m256i t = _mm256_add_epi64(_mm256_loadu_si256((const __m256i *)a[i]), _mm256_set1_epi64x(p2_limb[i]));
+        _mm256_storeu_si256((__m256i *)c[i], _mm256_sub_epi64(t, _mm256_loadu_si256((const __m256i *)b[i])));
+    }
+}
+
+
+// Carry chain on four lanes at once, limb 1 takes the carry of the folded limb 0 last
+__attribute__((target("avx2")))
+static inline void x4_carry_avx2(__m256i *h, f_elm_x4_t c)
+{
+    const __m256i m26 = _mm256_set1_epi64x(MASK26), m25 = _mm256_set1_epi64x(MASK25);
+    __m256i t;
+
+    #pragma GCC unroll 10
+    for (int i = 0; i < 9; i++)
+    {
+        h[i + 1] = _mm256_add_epi64(h[i + 1], _mm256_srli_epi64(h[i], limb_bits[i]));
+        h[i] = _mm256_and_si256(h[i], (i & 1) ? m25 : m26);
+    }
+    t = _mm256_srli_epi64(h[9], 25);
+    h[9] = _mm256_and_si256(h[9], m25);
+    t = _mm256_add_epi64(t, _mm256_add_epi64(_mm256_slli_epi64(t, 4), _mm256_slli_epi64(t, 1)));    // 19*t
+    h[0] = _mm256_add_epi64(h[0], t);
+    h[1] = _mm256_add_epi64(h[1], _mm256_srli_epi64(h[0], 26));
+    h[0] = _mm256_and_si256(h[0], m26);
+
+    #pragma GCC unroll 10
+    for (int i = 0; i < 10; i++)
+        _mm256_storeu_si256((__m256i *)c[i], h[i]);
+}
+
+
+__attribute__((target("avx2")))
+static void f_mul_x4_avx2(const f_elm_x4_t a, const f_elm_x4_t b, f_elm_x4_t c)
+{
+    __m256i f[10], f2[10], g[10], g19[10], h[10];
+    const __m256i n19 = _mm256_set1_epi64x(19);
+
+    #pragma GCC unroll 10
+    for (int i = 0; i < 10; i++)
+    {
+        f[i] = _mm256_loadu_si256((const __m256i *)a[i]);
+        f2[i] = (i & 1) ? _mm256_add_epi64(f[i], f[i]) : f[i];
+        g[i] = _mm256_loadu_si256((const __m256i *)b[i]);
+        g19[i] = _mm256_mul_epu32(g[i], n19);
+        h[i] = _mm256_setzero_si256();
+    }
+
+    #pragma GCC unroll 10
+    for (int i = 0; i < 10; i++)
+        #pragma GCC unroll 10
+        for (int j = 0; j < 10; j++)
+            h[(i + j) % 10] = _mm256_add_epi64(h[(i + j) % 10], _mm256_mul_epu32(j & 1 ? f2[i] : f[i], i + j >= 10 ? g19[j] : g[j]));
+
+    x4_carry_avx2(h, c);
+}
+
+
+// Squaring, the cross products f[i]*f[j] (i < j) are computed once from a doubled operand
+__attribute__((target("avx2")))
+static void f_sqr_x4_avx2(const f_elm_x4_t a, f_elm_x4_t c)
+{
+    __m256i f[10], f2[10], f19[10], h[10];
+    const __m256i n19 = _mm256_set1_epi64x(19);
+
+    #pragma GCC unroll 10
+    for (int i = 0; i < 10; i++)
+    {
+        f[i] = _mm256_loadu_si256((const __m256i *)a[i]);
+        f2[i] = _mm256_add_epi64(f[i], f[i]);
+        f19[i] = _mm256_mul_epu32(f[i], n19);
+        h[i] = _mm256_setzero_si256();
+    }
+
+    #pragma GCC unroll 10
+    for (int i = 0; i < 10; i++)
+    {
+        // i = j, doubled when i is odd
+        h[(2 * i) % 10] = _mm256_add_epi64(h[(2 * i) % 10], _mm256_mul_epu32((i & 1) ? f2[i] : f[i], 2 * i >= 10 ? f19[i] : f[i]));
+        // i < j, doubled once more when both are odd
+        #pragma GCC unroll 10
+        for (int j = i + 1; j < 10; j++)
+        {
+            __m256i t = _mm256_mul_epu32((i & j & 1) ? _mm256_add_epi64(f2[i], f2[i]) : f2[i], i + j >= 10 ? f19[j] : f[j]);
+            h[(i + j) % 10] = _mm256_add_epi64(h[(i + j) % 10], t);
+        }
+    }
+
+    x4_carry_avx2(h, c);
+}
+
+
+// AVX2 is checked once through CPUID (cpu_features), FF_DISPATCH can turn it off
+static int x4_use_avx2(void)
+{
+    return (cpu_features() & CPU_AVX2) != 0;
+}
+#endif
+
+
+void f_add_x4(const f_elm_x4_t a, const f_elm_x4_t b, f_elm_x4_t c)
+{
+#ifdef X4_AVX2
+    if (x4_use_avx2())
+    {
+        f_add_x4_avx2(a, b, c);
+        return;
+    }
+#endif
+    f_add_x4_generic(a, b, c);
+}
+
+
+void f_sub_x4(const f_elm_x4_t a, const f_elm_x4_t b, f_elm_x4_t c)
+{
+#ifdef X4_AVX2
+    if (x4_use_avx2())
+    {
+        f_sub_x4_avx2(a, b, c);
+        return;
+    }
+#endif
+    f_sub_x4_generic(a, b, c);
+}
+
+
+void f_mul_x4(const f_elm_x4_t a, const f_elm_x4_t b, f_elm_x4_t c)
+{
+#ifdef X4_AVX2
+    if (x4_use_avx2())
+    {
+        f_mul_x4_avx2(a, b, c);
+        return;
+    }
+#endif
+    f_mul_x4_generic(a, b, c);
+}
+
+
+void f_sqr_x4(const f_elm_x4_t a, f_elm_x4_t c)
+{
+#ifdef X4_AVX2
+    if (x4_use_avx2())
+    {
+        f_sqr_x4_avx2(a, c);
+        return;
+    }
+#endif
+    f_mul_x4_generic(a, a, c);
+}
@@ -0,0 +1,264 @@
+#include "arith.h"
+
+// Unsaturated radix-2^51 arithmetic modulo p = 2^255 - 19 (USE_RADIX51)
+// An element is a0 + a1*2^51 + a2*2^102 + a3*2^153 + a4*2^204 with 64-bit limbs, values are plain (no Montgomery form).
+// f51_mul/f51_sqr accept limbs below 2^54 and return limbs below 2^51 + 2^15.
+// f51_add and f51_sub do not carry, one addition or subtraction of such outputs can be fed back into f51_mul/f51_sqr.
+
+#define MASK51  MASK(51, 0)
+
+
+// 4x64 -> 5x51, a < 2^256 (bit 255 is left in the top limb)
+void f51_unpack(const f_elm_t a, f51_elm_t b)
+{
+    b[0] = a[0] & MASK51;
+    b[1] = ((a[0] >> 51) | (a[1] << 13)) & MASK51;
+    b[2] = ((a[1] >> 38) | (a[2] << 26)) & MASK51;
+    b[3] = ((a[2] >> 25) | (a[3] << 39)) & MASK51;
+    b[4] = a[3] >> 12;
+}
+
+
+// Carry every limb into the next one, the top limb is folded back with 2^255 = 19 (mod p)
+static inline void f51_carry(f51_elm_t a)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        a[i + 1] += a[i] >> 51;
+        a[i] &= MASK51;
+    }
+    a[0] += (a[4] >> 51) * 19;
+    a[4] &= MASK51;
+}
+
+
+// 5x51 -> 4x64, the output is the canonical value in [0, p)
+void f51_pack(const f51_elm_t a, f_elm_t b)
+{
+    f51_elm_t t;
+
+    for (int i = 0; i < 5; i++)
+        t[i] = a[i];
+
+    // t in [0, 2^255) with limbs below 2^51
+    f51_carry(t);
+    f51_carry(t);
+
+    // t + 19 is at least 2^255 iff t >= p, add 19 and carry, then subtract the 19 again modulo 2^255
+    t[0] += 19;
+    f51_carry(t);
+    t[0] += (1ULL << 51) - 19;
+    for (int i = 1; i < 5; i++)
+        t[i] += (1ULL << 51) - 1;
+    for (int i = 0; i < 4; i++)
+    {
+        t[i + 1] += t[i] >> 51;
+        t[i] &= MASK51;
+    }
+    t[4] &= MASK51;
+
+    b[0] = t[0] | (t[1] << 51);
+    b[1] = (t[1] >> 13) | (t[2] << 38);
+    b[2] = (t[2] >> 26) | (t[3] << 25);
+    b[3] = (t[3] >> 39) | (t[4] << 12);
+}
+
+
+// Addition, limb by limb without carries
+void f51_add(const f51_elm_t a, const f51_elm_t b, f51_elm_t c)
+{
+    for (int i = 0; i < 5; i++)
+        c[i] = a[i] + b[i];
+}
+
+
+// Subtraction, c = a + 4p - b limb by limb, b must have limbs below 2^53 - 76
+void f51_sub(const f51_elm_t a, const f51_elm_t b, f51_elm_t c)
+{
+    c[0] = a[0] + 0x1FFFFFFFFFFFB4 - b[0];
+    for (int i = 1; i < 5; i++)
+        c[i] = a[i] + 0x1FFFFFFFFFFFFC - b[i];
+}
+
+
+// Carry the five column sums into limbs below 2^51 + 2^15
+static inline void f51_carry_wide(uint128_t *t, f51_elm_t c)
+{
+    uint128_t uv;
+
+    for (int i = 0; i < 4; i++)
+    {
+        t[i + 1] += t[i] >> 51;
+        c[i] = (digit_t)t[i] & MASK51;
+    }
+    c[4] = (digit_t)t[4] & MASK51;
+
+    uv = (uint128_t)(digit_t)(t[4] >> 51) * 19 + c[0];
+    c[0] = (digit_t)uv & MASK51;
+    c[1] += (digit_t)(uv >> 51);
+}
+
+
+// Multiplication, the columns above 2^255 are folded in with 19 before any carry
+void f51_mul(const f51_elm_t a, const f51_elm_t b, f51_elm_t c)
+{
+    uint128_t t[5];
+    digit_t b19[5];
+
+    for (int i = 1; i < 5; i++)
+        b19[i] = b[i] * 19;
+
+    t[0] = (uint128_t)a[0] * b[0] + (uint128_t)a[1] * b19[4] + (uint128_t)a[2] * b19[3] + (uint128_t)a[3] * b19[2] + (uint128_t)a[4] * b19[1];
+    t[1] = (uint128_t)a[0] * b[1] + (uint128_t)a[1] * b[0]   + (uint128_t)a[2] * b19[4] + (uint128_t)a[3] * b19[3] + (uint128_t)a[4] * b19[2];
+    t[2] = (uint128_t)a[0] * b[2] + (uint128_t)a[1] * b[1]   + (uint128_t)a[2] * b[0]   + (uint128_t)a[3] * b19[4] + (uint128_t)a[4] * b19[3];
+    t[3] = (uint128_t)a[0] * b[3] + (uint128_t)a[1] * b[2]   + (uint128_t)a[2] * b[1]   + (uint128_t)a[3] * b[0]   + (uint128_t)a[4] * b19[4];
+    t[4] = (uint128_t)a[0] * b[4] + (uint128_t)a[1] * b[3]   + (uint128_t)a[2] * b[2]   + (uint128_t)a[3] * b[1]   + (uint128_t)a[4] * b[0];
+
+    f51_carry_wide(t, c);
+}
+
+
+// Squaring, the cross products are computed once with a doubled operand
+void f51_sqr(const f51_elm_t a, f51_elm_t c)
+{
+    uint128_t t[5];
+    digit_t d0 = 2 * a[0], d1 = 2 * a[1], d2_19 = 2 * 19 * a[2], d3_19 = 2 * 19 * a[3], a3_19 = 19 * a[3], a4_19 = 19 * a[4];
+
+    t[0] = (uint128_t)a[0] * a[0] + (uint128_t)d1 * a4_19 + (uint128_t)d2_19 * a[3];
+    t[1] = (uint128_t)d0 * a[1]   + (uint128_t)d2_19 * a[4] + (uint128_t)a3_19 * a[3];
+    t[2] = (uint128_t)d0 * a[2]   + (uint128_t)a[1] * a[1] + (uint128_t)d3_19 * a[4];
+    t[3] = (uint128_t)d0 * a[3]   + (uint128_t)d1 * a[2]   + (uint128_t)a4_19 * a[4];
+    t[4] = (uint128_t)d0 * a[4]   + (uint128_t)d1 * a[3]   + (uint128_t)a[2] * a[2];
+
+    f51_carry_wide(t, c);
+}
+
+
+static inline void f51_copy(const f51_elm_t a, f51_elm_t b)
+{
+    for (int i = 0; i < 5; i++)
+        b[i] = a[i];
+}
+
+
+// Multiplicative inverse, a^(p-2) with the addition chain of f_inv
+void f51_inv(const f51_elm_t a, f51_elm_t b)
+{
+    f51_elm_t t[6];
+    unsigned int i, j;
+
+    f51_copy(a, t[0]);
+    f51_copy(a, t[1]);
+
+    // First 128 bits = 2^7 bits
+    for (j = 0; j < 7; j++)
+    {
+        for (i = 0; i < (1u << j); i++)
+            f51_sqr(t[0], t[0]);
+        f51_mul(t[0], t[1], t[0]);
+        if (j == 2) f51_copy(t[0], t[2]);   // t[2] = a^(2^8  - 1)
+        if (j == 3) f51_copy(t[0], t[3]);   // t[3] = a^(2^16 - 1)
+        if (j == 4) f51_copy(t[0], t[4]);   // t[4] = a^(2^32 - 1)
+        if (j == 5) f51_copy(t[0], t[5]);   // t[5] = a^(2^64 - 1)
+        f51_copy(t[0], t[1]);               // = a^(2^(2^(j+1)) - 1)
+    }
+
+    // Next 64, 32, 16 and 8 bits
+    for (i = 0; i < 64; i++)
+        f51_sqr(t[0], t[0]);
+    f51_mul(t[0], t[5], t[0]);
+    for (i = 0; i < 32; i++)
+        f51_sqr(t[0], t[0]);
+    f51_mul(t[0], t[4], t[0]);
+    for (i = 0; i < 16; i++)
+        f51_sqr(t[0], t[0]);
+    f51_mul(t[0], t[3], t[0]);
+    for (i = 0; i < 8; i++)
+        f51_sqr(t[0], t[0]);
+    f51_mul(t[0], t[2], t[0]);
+
+    // Last 7 bits 1101011
+    f51_sqr(t[0], t[0]);
+    f51_mul(t[0], a, t[0]);
+    f51_sqr(t[0], t[0]);
+    f51_mul(t[0], a, t[0]);
+    f51_sqr(t[0], t[0]);
+    f51_sqr(t[0], t[0]);
+    f51_mul(t[0], a, t[0]);
+    f51_sqr(t[0], t[0]);
+    f51_sqr(t[0], t[0]);
+    f51_mul(t[0], a, t[0]);
+    f51_sqr(t[0], t[0]);
+    f51_mul(t[0], a, t[0]);
+
+    f51_copy(t[0], b);
+}
+
+
+// Square root, a^((p+3)/8) times 1 or sqrt(-1) with the addition chain of f_sqrt
+void f51_sqrt(const f51_elm_t a, f51_elm_t b)
+{
+    const f_elm_t psi = {0xC4EE1B274A0EA0B0, 0x2F431806AD2FE478, 0x2B4D00993DFBD7A7, 0x2B8324804FC1DF0B}; // psi = sqrt(-1)
+    f51_elm_t t[7];
+    f_elm_t s;
+    digit_t mask, diff = 0;
+    unsigned int i, j;
+
+    f51_copy(a, t[0]);
+    f51_copy(a, t[1]);
+
+    // First 128 bits = 2^7 bits
+    for (j = 0; j < 7; j++)
+    {
+        for (i = 0; i < (1u << j); i++)
+            f51_sqr(t[0], t[0]);
+        f51_mul(t[0], t[1], t[0]);
+        if (j == 0) f51_copy(t[0], t[6]);   // t[6] = a^(2^2  - 1)
+        if (j == 2) f51_copy(t[0], t[2]);   // t[2] = a^(2^8  - 1)
+        if (j == 3) f51_copy(t[0], t[3]);   // t[3] = a^(2^16 - 1)
+        if (j == 4) f51_copy(t[0], t[4]);   // t[4] = a^(2^32 - 1)
+        if (j == 5) f51_copy(t[0], t[5]);   // t[5] = a^(2^64 - 1)
+        f51_copy(t[0], t[1]);               // = a^(2^(2^(j+1)) - 1)
+    }
+
+    // Next 64, 32, 16 and 8 bits
+    for (i = 0; i < 64; i++)
+        f51_sqr(t[0], t[0]);
+    f51_mul(t[0], t[5], t[0]);
+    for (i = 0; i < 32; i++)
+        f51_sqr(t[0], t[0]);
+    f51_mul(t[0], t[4], t[0]);
+    for (i = 0; i < 16; i++)
+        f51_sqr(t[0], t[0]);
+    f51_mul(t[0], t[3], t[0]);
+    for (i = 0; i < 8; i++)
+        f51_sqr(t[0], t[0]);
+    f51_mul(t[0], t[2], t[0]);
+
+    // Next 2 bits, then 1 bit
+    f51_sqr(t[0], t[0]);
+    f51_sqr(t[0], t[0]);
+    f51_mul(t[0], t[6], t[0]);
+    f51_sqr(t[0], t[0]);
+
+    // t[1] = a^d
+    f51_sqr(t[0], t[1]);
+    f51_sqr(t[1], t[1]);
+    f51_mul(t[1], t[6], t[1]);
+
+    // t[0] = a^(d+1)/2
+    f51_mul(t[0], a, t[0]);
+    f51_sqr(t[0], t[0]);
+
+    // t[0] has to be multiplied with 1 if t[1] is 1, and with psi if t[1] is -1
+    f51_pack(t[1], s);
+    for (i = 0; i < WORDS_FIELD; i++)
+        diff |= s[i] ^ One[i];
+    mask = 0 - ((diff | (0 - diff)) >> 63);
+    f51_unpack(psi, t[2]);
+    t[2][0] = (t[2][0] & mask) | (1 & ~mask);
+    for (i = 1; i < 5; i++)
+        t[2][i] &= mask;
+
+    f51_mul(t[0], t[2], b);
+}
@@ -0,0 +1,156 @@
+// Generated by tools/addchain.py, do not edit
+// Exponentiations by fixed powers of p = 0xFFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFF
+
+#ifndef CHAINS_H
+#define CHAINS_H
+
+#ifdef FERMAT_INVERSION
+// b = a^(p - 2), 255 squarings and 12 multiplications
+static void f_pow_inv(const f_elm_t a, f_elm_t b)
+{
+    f_elm_t t[3];
+    unsigned int i;
+
+    f_sqr(a, t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^3
+    f_sqr(t[0], t[1]);
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^4 - 1)
+    f_sqr(t[1], t[2]);
+    for (i = 0; i < 3; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[1], t[2]);                // t[2] = a^(2^8 - 1)
+    f_sqr(t[2], t[2]);
+    f_sqr(t[2], t[2]);
+    f_mul(t[2], t[0], t[2]);                // t[2] = a^(2^10 - 1)
+    f_sqr(t[2], t[1]);
+    for (i = 0; i < 9; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[2], t[1]);                // t[1] = a^(2^20 - 1)
+    for (i = 0; i < 10; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[2], t[1]);                // t[1] = a^(2^30 - 1)
+    f_sqr(t[1], t[2]);
+    f_sqr(t[2], t[2]);
+    f_mul(t[2], t[0], t[2]);                // t[2] = a^(2^32 - 1)
+
+    // bit 192
+    f_sqr(t[2], t[0]);
+    for (i = 0; i < 31; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], a, t[0]);
+
+    // bits 95 to 2, 94 ones
+    for (i = 0; i < 128; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[2], t[0]);
+    for (i = 0; i < 32; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[2], t[0]);
+    for (i = 0; i < 30; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[1], t[0]);
+
+    // bit 0
+    f_sqr(t[0], t[0]);
+    f_sqr(t[0], t[0]);
+    f_mul(t[0], a, t[0]);
+
+    f_copy(t[0], b);
+}
+#endif
+
+#ifdef EULER_LEGENDRE
+// b = a^((p - 1)/2), 254 squarings and 12 multiplications
+static void f_pow_leg(const f_elm_t a, f_elm_t b)
+{
+    f_elm_t t[3];
+    unsigned int i;
+
+    f_sqr(a, t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^3
+    f_sqr(t[0], t[1]);
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^4 - 1)
+    f_sqr(t[1], t[2]);
+    for (i = 0; i < 3; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[1], t[2]);                // t[2] = a^(2^8 - 1)
+    f_sqr(t[2], t[2]);
+    f_sqr(t[2], t[2]);
+    f_mul(t[2], t[0], t[2]);                // t[2] = a^(2^10 - 1)
+    f_sqr(t[2], t[0]);
+    for (i = 0; i < 9; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[2], t[0]);                // t[0] = a^(2^20 - 1)
+    for (i = 0; i < 10; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[2], t[0]);                // t[0] = a^(2^30 - 1)
+    f_sqr(t[0], t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^(2^31 - 1)
+    f_sqr(t[0], t[1]);
+    f_mul(t[1], a, t[1]);                   // t[1] = a^(2^32 - 1)
+
+    // bit 191
+    f_sqr(t[1], t[2]);
+    for (i = 0; i < 31; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], a, t[2]);
+
+    // bits 94 to 0, 95 ones
+    for (i = 0; i < 128; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[1], t[2]);
+    for (i = 0; i < 32; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[1], t[2]);
+    for (i = 0; i < 31; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[0], t[2]);
+
+    f_copy(t[2], b);
+}
+#endif
+
+// b = a^((p + 1)/4), 253 squarings and 7 multiplications
+static void f_pow_sqrt(const f_elm_t a, f_elm_t b)
+{
+    f_elm_t t[2];
+    unsigned int i;
+
+    f_sqr(a, t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^3
+    f_sqr(t[0], t[1]);
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^4 - 1)
+    f_sqr(t[1], t[0]);
+    for (i = 0; i < 3; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[1], t[0]);                // t[0] = a^(2^8 - 1)
+    f_sqr(t[0], t[1]);
+    for (i = 0; i < 7; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^16 - 1)
+    f_sqr(t[1], t[0]);
+    for (i = 0; i < 15; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[1], t[0]);                // t[0] = a^(2^32 - 1)
+
+    // bit 190
+    for (i = 0; i < 32; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], a, t[0]);
+
+    // bit 94
+    for (i = 0; i < 96; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], a, t[0]);
+
+    // bits 93 to 0, zeros
+    for (i = 0; i < 94; i++)
+        f_sqr(t[0], t[0]);
+
+    f_copy(t[0], b);
+}
+
+#endif
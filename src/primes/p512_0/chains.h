@@ -0,0 +1,178 @@
+// Generated by tools/addchain.py, do not edit
+// Exponentiations by fixed powers of p = 0xFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF0000000000000000FFFFFFFFFFFFFFFEFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF
+
+#ifndef CHAINS_H
+#define CHAINS_H
+
+#ifdef FERMAT_INVERSION
+// b = a^(p - 2), 511 squarings and 14 multiplications
+static void f_pow_inv(const f_elm_t a, f_elm_t b)
+{
+    f_elm_t t[4];
+    unsigned int i;
+
+    f_sqr(a, t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^3
+    f_sqr(t[0], t[1]);
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^4 - 1)
+    f_sqr(t[1], t[0]);
+    for (i = 0; i < 3; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[1], t[0]);                // t[0] = a^(2^8 - 1)
+    f_sqr(t[0], t[2]);
+    for (i = 0; i < 7; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[0], t[2]);                // t[2] = a^(2^16 - 1)
+    for (i = 0; i < 4; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[1], t[2]);                // t[2] = a^(2^20 - 1)
+    f_sqr(t[2], t[2]);
+    f_mul(t[2], a, t[2]);                   // t[2] = a^(2^21 - 1)
+    f_sqr(t[2], t[0]);
+    for (i = 0; i < 20; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[2], t[0]);                // t[0] = a^(2^42 - 1)
+    for (i = 0; i < 21; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[2], t[0]);                // t[0] = a^(2^63 - 1)
+    f_sqr(t[0], t[2]);
+    for (i = 0; i < 62; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[0], t[2]);                // t[2] = a^(2^126 - 1)
+    f_sqr(t[2], t[3]);
+    for (i = 0; i < 125; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[2], t[3]);                // t[3] = a^(2^252 - 1)
+    for (i = 0; i < 4; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[1], t[3]);                // t[3] = a^(2^256 - 1)
+
+    // bits 191 to 129, 63 ones
+    for (i = 0; i < 127; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[0], t[3]);
+
+    // bits 127 to 2, 126 ones
+    for (i = 0; i < 127; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[2], t[3]);
+
+    // bit 0
+    f_sqr(t[3], t[3]);
+    f_sqr(t[3], t[3]);
+    f_mul(t[3], a, t[3]);
+
+    f_copy(t[3], b);
+}
+#endif
+
+#ifdef EULER_LEGENDRE
+// b = a^((p - 1)/2), 510 squarings and 14 multiplications
+static void f_pow_leg(const f_elm_t a, f_elm_t b)
+{
+    f_elm_t t[4];
+    unsigned int i;
+
+    f_sqr(a, t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^3
+    f_sqr(t[0], t[1]);
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^4 - 1)
+    f_sqr(t[1], t[0]);
+    for (i = 0; i < 3; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[1], t[0]);                // t[0] = a^(2^8 - 1)
+    f_sqr(t[0], t[2]);
+    for (i = 0; i < 7; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[0], t[2]);                // t[2] = a^(2^16 - 1)
+    for (i = 0; i < 4; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[1], t[2]);                // t[2] = a^(2^20 - 1)
+    f_sqr(t[2], t[2]);
+    f_mul(t[2], a, t[2]);                   // t[2] = a^(2^21 - 1)
+    f_sqr(t[2], t[0]);
+    for (i = 0; i < 20; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[2], t[0]);                // t[0] = a^(2^42 - 1)
+    for (i = 0; i < 21; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[2], t[0]);                // t[0] = a^(2^63 - 1)
+    f_sqr(t[0], t[2]);
+    for (i = 0; i < 62; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[0], t[2]);                // t[2] = a^(2^126 - 1)
+    f_sqr(t[2], t[3]);
+    for (i = 0; i < 125; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[2], t[3]);                // t[3] = a^(2^252 - 1)
+    for (i = 0; i < 4; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[1], t[3]);                // t[3] = a^(2^256 - 1)
+
+    // bits 190 to 128, 63 ones
+    for (i = 0; i < 127; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[0], t[3]);
+
+    // bits 126 to 0, 127 ones
+    for (i = 0; i < 127; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[2], t[3]);
+    f_sqr(t[3], t[3]);
+    f_mul(t[3], a, t[3]);
+
+    f_copy(t[3], b);
+}
+#endif
+
+// b = a^((p + 1)/4), 509 squarings and 9 multiplications
+static void f_pow_sqrt(const f_elm_t a, f_elm_t b)
+{
+    f_elm_t t[3];
+    unsigned int i;
+
+    f_sqr(a, t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^3
+    f_sqr(t[0], t[1]);
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^4 - 1)
+    f_sqr(t[1], t[0]);
+    for (i = 0; i < 3; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[1], t[0]);                // t[0] = a^(2^8 - 1)
+    f_sqr(t[0], t[1]);
+    for (i = 0; i < 7; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^16 - 1)
+    f_sqr(t[1], t[0]);
+    for (i = 0; i < 15; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[1], t[0]);                // t[0] = a^(2^32 - 1)
+    f_sqr(t[0], t[1]);
+    for (i = 0; i < 31; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^64 - 1)
+    f_sqr(t[1], t[0]);
+    for (i = 0; i < 63; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[1], t[0]);                // t[0] = a^(2^128 - 1)
+    f_sqr(t[0], t[2]);
+    for (i = 0; i < 127; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[0], t[2]);                // t[2] = a^(2^256 - 1)
+
+    // bits 189 to 126, 64 ones
+    for (i = 0; i < 128; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[1], t[2]);
+
+    // bits 125 to 0, zeros
+    for (i = 0; i < 126; i++)
+        f_sqr(t[2], t[2]);
+
+    f_copy(t[2], b);
+}
+
+#endif
@@ -1,4 +1,11 @@
 #include "arith.h"
+#include "chains.h"
+
+// Operands of at least KARATSUBA_THRESHOLD words use Karatsuba multiplication, set by CMake
+// (8: one level with 4x4 schoolbook leaves, 4: two levels, 16: schoolbook only)
+#ifndef KARATSUBA_THRESHOLD
+    #define KARATSUBA_THRESHOLD 16
+#endif
 
 
 // Reduction modulo p
@@ -69,43 +76,162 @@ void f_neg(const f_elm_t a, f_elm_t b)
     f_red(b);
 }
 
-// Multiplication of two multiprecision words (without reduction)
-void mp_mul(const digit_t *a, const digit_t *b, digit_t *c)
-{ // Schoolbook multiplication
-    digit_t carry, UV[2], t = 0, u = 0, v = 0;
+// Schoolbook multiplication of n-word integers, operand scanning with one row a*b[i] per iteration
+static inline void mp_mul_school(const digit_t *a, const digit_t *b, digit_t *c, const int n)
+{
+    uint128_t uv = 0;
 
-    for (int i = 0; i < WORDS_FIELD; i++)
+    for (int j = 0; j < n; j++)
+    {
+        uv = (uint128_t)a[j] * b[0] + (digit_t)(uv >> RADIX);
+        c[j] = (digit_t)uv;
+    }
+    c[n] = (digit_t)(uv >> RADIX);
+
+    for (int i = 1; i < n; i++)
     {
-        for (int j = 0; j <= i; j++)
+        uv = 0;
+        for (int j = 0; j < n; j++)
         {
-            carry = 0;
-            MUL(a[j], b[i - j], UV + 1, UV[0]);
-            ADDC(carry, UV[0], v, v);
-            ADDC(carry, UV[1], u, u);
-            t += carry;
+            uv = (uint128_t)a[j] * b[i] + c[i + j] + (digit_t)(uv >> RADIX);
+            c[i + j] = (digit_t)uv;
         }
-        c[i] = v;
-        v = u;
-        u = t;
-        t = 0;
+        c[i + n] = (digit_t)(uv >> RADIX);
     }
+}
+
+// Schoolbook squaring of n-word integers, the cross products a[i]*a[j] (i < j) are computed once and doubled
+static inline void mp_sqr_school(const digit_t *a, digit_t *c, const int n)
+{
+    digit_t t = 0, u = 0, v = 0;
+    uint128_t uv, UV;
 
-    for (int i = WORDS_FIELD; i < 2 * WORDS_FIELD - 1; i++)
+    for (int k = 0; k < 2 * n - 1; k++)
     {
-        for (int j = i - WORDS_FIELD + 1; j < WORDS_FIELD; j++)
+        for (int i = (k < n ? 0 : k - n + 1); i < k - i; i++)
+        {
+            UV = (uint128_t)a[i] * a[k - i];
+            t += (digit_t)(UV >> (2 * RADIX - 1));
+            UV <<= 1;
+            uv = (((uint128_t)u << RADIX) | v) + UV;
+            t += (uv < UV);
+            u = (digit_t)(uv >> RADIX);
+            v = (digit_t)uv;
+        }
+        if ((k & 1) == 0)
         {
-            carry = 0;
-            MUL(a[j], b[i - j], UV + 1, UV[0]);
-            ADDC(carry, UV[0], v, v);
-            ADDC(carry, UV[1], u, u);
-            t += carry;
+            UV = (uint128_t)a[k / 2] * a[k / 2];
+            uv = (((uint128_t)u << RADIX) | v) + UV;
+            t += (uv < UV);
+            u = (digit_t)(uv >> RADIX);
+            v = (digit_t)uv;
         }
-        c[i] = v;
+        c[k] = v;
         v = u;
         u = t;
         t = 0;
     }
-    c[2 * WORDS_FIELD - 1] = v;
+    c[2 * n - 1] = v;
+}
+
+// Adds the Karatsuba middle term to z = z0 + z2*2^(64n), where d = |a0 - a1|*|b1 - b0| and mask is all ones
+// if (a0 - a1)*(b1 - b0) is negative: z += (z0 + z2 +- d)*2^(64n/2)
+static inline void mp_kara_middle(digit_t *z, const digit_t *d, const digit_t mask, const int n)
+{
+    digit_t s[WORDS_FIELD], carry = 0, top;
+
+    for (int i = 0; i < n; i++)
+        ADDC(carry, z[i], z[n + i], s[i]);
+    top = carry;
+
+    carry = mask & 1;
+    for (int i = 0; i < n; i++)
+        ADDC(carry, s[i], d[i] ^ mask, s[i]);
+    top += carry + mask;
+
+    carry = 0;
+    for (int i = 0; i < n; i++)
+        ADDC(carry, z[n / 2 + i], s[i], z[n / 2 + i]);
+    for (int i = n + n / 2; i < 2 * n; i++)
+    {
+        ADDC(carry, z[i], top, z[i]);
+        top = 0;
+    }
+}
+
+// Karatsuba multiplication of n-word integers, operands below KARATSUBA_THRESHOLD words use schoolbook
+// a*b = z2*2^(64n) + (z0 + z2 + (a0 - a1)*(b1 - b0))*2^(64n/2) + z0, with z0 = a0*b0 and z2 = a1*b1
+static void mp_mul_karatsuba(const digit_t *a, const digit_t *b, digit_t *c, const int n)
+{
+    const int h = n / 2;
+    digit_t da[WORDS_FIELD / 2], db[WORDS_FIELD / 2], d[WORDS_FIELD], ma, mb, carry;
+
+    if (n < KARATSUBA_THRESHOLD || (n & 1))
+    {
+        mp_mul_school(a, b, c, n);
+        return;
+    }
+
+    // da = |a0 - a1| and db = |b1 - b0|, ma and mb are all ones if the difference is negative
+    carry = 0;
+    for (int i = 0; i < h; i++)
+        SUBC(carry, a[i], a[h + i], da[i]);
+    ma = 0 - carry;
+    carry = 0;
+    for (int i = 0; i < h; i++)
+        SUBC(carry, b[h + i], b[i], db[i]);
+    mb = 0 - carry;
+
+    carry = ma & 1;
+    for (int i = 0; i < h; i++)
+        ADDC(carry, da[i] ^ ma, 0, da[i]);
+    carry = mb & 1;
+    for (int i = 0; i < h; i++)
+        ADDC(carry, db[i] ^ mb, 0, db[i]);
+
+    mp_mul_karatsuba(a, b, c, h);
+    mp_mul_karatsuba(a + h, b + h, c + n, h);
+    mp_mul_karatsuba(da, db, d, h);
+    mp_kara_middle(c, d, ma ^ mb, n);
+}
+
+// Karatsuba squaring of n-word integers, a^2 = z2*2^(64n) + (z0 + z2 - (a0 - a1)^2)*2^(64n/2) + z0
+static void mp_sqr_karatsuba(const digit_t *a, digit_t *c, const int n)
+{
+    const int h = n / 2;
+    digit_t da[WORDS_FIELD / 2], d[WORDS_FIELD], ma, carry;
+
+    if (n < KARATSUBA_THRESHOLD || (n & 1))
+    {
+        mp_sqr_school(a, c, n);
+        return;
+    }
+
+    // da = |a0 - a1|
+    carry = 0;
+    for (int i = 0; i < h; i++)
+        SUBC(carry, a[i], a[h + i], da[i]);
+    ma = 0 - carry;
+    carry = ma & 1;
+    for (int i = 0; i < h; i++)
+        ADDC(carry, da[i] ^ ma, 0, da[i]);
+
+    mp_sqr_karatsuba(a, c, h);
+    mp_sqr_karatsuba(a + h, c + n, h);
+    mp_sqr_karatsuba(da, d, h);
+    mp_kara_middle(c, d, 0 - (digit_t)1, n);
+}
+
+// Multiplication of two multiprecision words (without reduction), c must not overlap a or b
+void mp_mul(const digit_t *a, const digit_t *b, digit_t *c)
+{
+    mp_mul_karatsuba(a, b, c, WORDS_FIELD);
+}
+
+// Squaring of a multiprecision word (without reduction), c must not overlap a
+void mp_sqr(const digit_t *a, digit_t *c)
+{
+    mp_sqr_karatsuba(a, c, WORDS_FIELD);
 }
 
 // // Montgomery form reduction after multiplication
@@ -143,397 +269,222 @@ void mont_redc(const digit_t *a, digit_t *c)
 {
     // c = a*R^-1 mod p, where R = 2^256.
     // If a < 2^256*p, the output c is in the range [0, p).
-    // a is assumed to be in Montgomery representation.
-    digit_t mask, carry = 0;
-    digit_t t0[2 * WORDS_FIELD], t1[WORDS_FIELD];
-
-    mp_mul(a, ip, t0);
-    f_copy(t0, t1);
-    mp_mul(t1, p, t0);
+    // Word-by-word: each step adds m*p with m = t[i]*pp[0] mod 2^64, which clears t[i].
+    digit_t t[2 * WORDS_FIELD], mask, carry, top = 0, m;
+    uint128_t uv;
 
-    for (int i = WORDS_FIELD; i < 2 * WORDS_FIELD; i++)
-        SUBC(carry, a[i], t0[i], t0[i]);
+    for (int i = 0; i < 2 * WORDS_FIELD; i++)
+        t[i] = a[i];
 
+    for (int i = 0; i < WORDS_FIELD; i++)
+    {
+        m = t[i] * pp[0];
+        uv = 0;
+        for (int j = 0; j < WORDS_FIELD; j++)
+        {
+            uv = (uint128_t)m * p[j] + t[i + j] + (digit_t)(uv >> RADIX);
+            t[i + j] = (digit_t)uv;
+        }
+        uv = (uint128_t)t[i + WORDS_FIELD] + (digit_t)(uv >> RADIX) + top;
+        t[i + WORDS_FIELD] = (digit_t)uv;
+        top = (digit_t)(uv >> RADIX);
+    }
 
-    mask = 0 - carry;
+    // t / R < 2p, subtract p and add it back if that borrows
     carry = 0;
     for (int i = 0; i < WORDS_FIELD; i++)
-        ADDC(carry, t0[WORDS_FIELD + i], p[i] & mask, c[i]);
+        SUBC(carry, t[WORDS_FIELD + i], p[i], c[i]);
+    SUBC(carry, top, 0, mask);
 
+    carry = 0;
+    for (int i = 0; i < WORDS_FIELD; i++)
+        ADDC(carry, c[i], p[i] & mask, c[i]);
 }
 
 
-// Multiplication of field elements
-void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c)
+#ifdef SOLINAS_REDUCTION
+// Solinas reduction of a double-width product, p = 2^512 - 2^256 + 2^192 - 2^128 - 1
+// a < 2^1024 -> c in [0, p-1], on 64-bit words with 2^512 = 2^256 - 2^192 + 2^128 + 1 (mod p)
+void mp_red(const digit_t *a, digit_t *c)
 {
-    digit_t t0[2 * WORDS_FIELD] = {0};
-
-    mp_mul(a, b, t0);
-    mont_redc(t0, c);
-}
+    int128_t w[2 * WORDS_FIELD], k = 0;
 
+    for (int i = 0; i < 2 * WORDS_FIELD; i++)
+        w[i] = a[i];
 
+    // Fold the high words from the top, word j >= 8 moves to j-4, j-5, j-6 and j-8
+    for (int j = 2 * WORDS_FIELD - 1; j >= WORDS_FIELD; j--)
+    {
+        w[j - 4] += w[j];
+        w[j - 5] -= w[j];
+        w[j - 6] += w[j];
+        w[j - 8] += w[j];
+    }
 
-// Convert a number from value to Montgomery form  (a -> aR)
-void to_mont(const digit_t *a, f_elm_t b)
-{
-    f_mul(a, R2, b);
-}
+    // Signed carry propagation, the carry out k is folded back until it vanishes
+    for (int r = 0; r < 3; r++)
+    {
+        w[0] += k;
+        w[2] += k;
+        w[3] -= k;
+        w[4] += k;
+        k = 0;
+        for (int i = 0; i < WORDS_FIELD; i++)
+        {
+            k += w[i];
+            w[i] = (digit_t)k;
+            k >>= RADIX;
+        }
+    }
 
+    for (int i = 0; i < WORDS_FIELD; i++)
+        c[i] = (digit_t)w[i];
 
-// Convert a number from Montgomery form into value (aR -> a)
-void from_mont(const f_elm_t a, digit_t *b)
-{
-    digit_t t0[2 * WORDS_FIELD] = {0};
-    f_copy(a, t0);
-    mont_redc(t0, b);
+    f_red(c);
 }
 
+// Multiplication of field elements
+void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c)
+{
+    digit_t t0[2 * WORDS_FIELD];
 
+    mp_mul(a, b, t0);
+    mp_red(t0, c);
+}
 
 
+// Squaring of a field element
+void f_sqr(const f_elm_t a, f_elm_t c)
+{
+    digit_t t0[2 * WORDS_FIELD];
 
-// Multiplicative inverse of a field element
-void f_inv(const f_elm_t a, f_elm_t b)
+    mp_sqr(a, t0);
+    mp_red(t0, c);
+}
+#elif !defined(BARRETT_FORM)
+// Multiplication of field elements
+// Montgomery multiplication with coarsely integrated operand scanning (CIOS):
+// each iteration adds a*b[i] and then m*p with m = t[0]*pp[0] mod 2^64, which
+// clears the lowest word, so the product and the reduction share one pass.
+void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c)
 {
+    digit_t t[WORDS_FIELD + 2] = {0};
+    digit_t mask, carry, m;
+    uint128_t uv;
 
-    f_elm_t t[8];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
- 
-    /* p - 2 =     0b   11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111110
-
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111101    
-    */
-
-
-    // Compute a^(p-2)
-
-    // First 256 bits = 2^8 bits
-    for(j = 0; j < 8; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 0) f_copy(t[0], t[2]);  // a^(2^2  - 1) = a^0b 11
-        if(j == 1) f_copy(t[0], t[3]);  // a^(2^4  - 1) = a^0b 1111
-        if(j == 2) f_copy(t[0], t[4]);  // a^(2^8  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[5]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        if(j == 4) f_copy(t[0], t[6]);  // a^(2^32 - 1) = a^0b 11111111 11111111 11111111 11111111
-        if(j == 5) f_copy(t[0], t[7]);  // a^(2^64 - 1) = a^0b 11111111 11111111 11111111 11111111 11111111 11111111 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
+    for (int i = 0; i < WORDS_FIELD; i++)
+    {
+        // t = t + a*b[i]
+        uv = 0;
+        for (int j = 0; j < WORDS_FIELD; j++)
+        {
+            uv = (uint128_t)a[j] * b[i] + t[j] + (digit_t)(uv >> RADIX);
+            t[j] = (digit_t)uv;
+        }
+        uv = (uint128_t)t[WORDS_FIELD] + (digit_t)(uv >> RADIX);
+        t[WORDS_FIELD] = (digit_t)uv;
+        t[WORDS_FIELD + 1] = (digit_t)(uv >> RADIX);
+
+        // t = (t + m*p) / 2^64
+        m = t[0] * pp[0];
+        uv = (uint128_t)m * p[0] + t[0];
+        for (int j = 1; j < WORDS_FIELD; j++)
+        {
+            uv = (uint128_t)m * p[j] + t[j] + (digit_t)(uv >> RADIX);
+            t[j - 1] = (digit_t)uv;
+        }
+        uv = (uint128_t)t[WORDS_FIELD] + (digit_t)(uv >> RADIX);
+        t[WORDS_FIELD - 1] = (digit_t)uv;
+        t[WORDS_FIELD] = t[WORDS_FIELD + 1] + (digit_t)(uv >> RADIX);
     }
 
+    // t < 2p, subtract p and add it back if that borrows
+    carry = 0;
+    for (int i = 0; i < WORDS_FIELD; i++)
+        SUBC(carry, t[i], p[i], c[i]);
+    SUBC(carry, t[WORDS_FIELD], 0, mask);
 
-
-    // Next 64 bits
-    for (i = 0; i < 64; i++)
-        f_mul(t[0], t[0], t[0]);
-
-
-
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[6], t[0]);
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[5], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
-
-    // Next 4 bits
-    for (i = 0; i < 4; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 2 bits
-    for (i = 0; i < 2; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-    // Next 1 bit
-    for (i = 0; i < 1; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-
-    // Next 1 bit
-    for (i = 0; i < 1; i++)
-        f_mul(t[0], t[0], t[0]);
-
-
-
-    // Next 64 bits
-    for (i = 0; i < 64; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[7], t[0]);
-
-
+    carry = 0;
+    for (int i = 0; i < WORDS_FIELD; i++)
+        ADDC(carry, c[i], p[i] & mask, c[i]);
+}
 
 
 
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[6], t[0]);
+// Squaring of a field element
+// The fused CIOS loop in f_mul beats mp_sqr followed by mont_redc here, the saved
+// cross products do not make up for the extra pass over the double-width product
+void f_sqr(const f_elm_t a, f_elm_t c)
+{
+    f_mul(a, a, c);
+}
+#endif
 
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[5], t[0]);
 
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
 
-    // Next 4 bits
-    for (i = 0; i < 4; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
+#ifdef CANONICAL_FORM
+// Elements are kept in canonical form, the conversions only reduce the input
+void to_mont(const digit_t *a, f_elm_t b)
+{
+    f_copy(a, b);
+    f_red(b);
+}
 
-    // Next 2 bits
-    for (i = 0; i < 2; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
 
-    // Next 1 bit
-    for (i = 0; i < 1; i++)
-        f_mul(t[0], t[0], t[0]);
+void from_mont(const f_elm_t a, digit_t *b)
+{
+    f_copy(a, b);
+    f_red(b);
+}
+#else
+// Convert a number from value to Montgomery form  (a -> aR)
+void to_mont(const digit_t *a, f_elm_t b)
+{
+    f_mul(a, R2, b);
+}
 
-    // Next 1 bit
-    for (i = 0; i < 1; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
 
+// Convert a number from Montgomery form into value (aR -> a)
+void from_mont(const f_elm_t a, digit_t *b)
+{
+    digit_t t0[2 * WORDS_FIELD] = {0};
+    f_copy(a, t0);
+    mont_redc(t0, b);
+}
+#endif
 
 
-    f_copy(t[0], b);  
 
+#ifdef FERMAT_INVERSION
+// Multiplicative inverse of a field element
+void f_inv(const f_elm_t a, f_elm_t b)
+{
+    f_pow_inv(a, b);
 }
+#endif
 
 
+#ifdef EULER_LEGENDRE
 // Legendre symbol of a field element
 void f_leg(const f_elm_t a, unsigned char *b)
 {
+    f_elm_t t0;
 
-    f_elm_t t[8];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
-
-    /* (p - 1)/2 = 0b   01111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-
-                        10000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-
-                        01111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-
-                        01111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111  
-    */
-
-
-    // Compute a^((p - 1)/2)
-
-    // First 256 bits = 2^8 bits
-    for(j = 0; j < 8; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 0) f_copy(t[0], t[2]);  // a^(2^2  - 1) = a^0b 11
-        if(j == 1) f_copy(t[0], t[3]);  // a^(2^4  - 1) = a^0b 1111
-        if(j == 2) f_copy(t[0], t[4]);  // a^(2^8  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[5]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        if(j == 4) f_copy(t[0], t[6]);  // a^(2^32 - 1) = a^0b 11111111 11111111 11111111 11111111
-        if(j == 5) f_copy(t[0], t[7]);  // a^(2^64 - 1) = a^0b 11111111 11111111 11111111 11111111 11111111 11111111 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-
-
-
-    // Next 64 bits
-    for (i = 0; i < 64; i++)
-        f_mul(t[0], t[0], t[0]);
-
-
-
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[6], t[0]);
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[5], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
-
-    // Next 4 bits
-    for (i = 0; i < 4; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 2 bits
-    for (i = 0; i < 2; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-    // Next 1 bit
-    for (i = 0; i < 1; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-
-    // Next 1 bit
-    for (i = 0; i < 1; i++)
-        f_mul(t[0], t[0], t[0]);
-
-
-
-    // Next 64 bits
-    for (i = 0; i < 64; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[7], t[0]);
-
-
-
-
-
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[6], t[0]);
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[5], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
-
-    // Next 4 bits
-    for (i = 0; i < 4; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 2 bits
-    for (i = 0; i < 2; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-    // Next 1 bit
-    for (i = 0; i < 1; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-
-    *b = ((*(unsigned char *)t[0]) & 0x02) >> 0x01;
+    f_pow_leg(a, t0);                       // t0 = a^((p-1)/2) = 1, -1 or 0
 
+#ifdef CANONICAL_FORM
+    f_add(t0, One, t0);                     // t0 = 0 iff a^((p-1)/2) = -1
+    *b = 1 - f_eq(t0, Zero);
+#else
+    *b = ((*(unsigned char *)t0) & 0x02) >> 0x01;
+#endif
 }
+#endif
 
 
-void f_sqrt(const f_elm_t a, f_elm_t b){
-
-
-    f_elm_t t[3];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
-
-    /* (p + 1)/4 = 0b   00111111111111111111111111111111
-                        11111111111111111111111111111111
-                        11111111111111111111111111111111
-                        11111111111111111111111111111111
-
-                        11111111111111111111111111111111
-                        11111111111111111111111111111111
-                        11111111111111111111111111111111
-                        11111111111111111111111111111111
-
-                        11000000000000000000000000000000
-                        00000000000000000000000000000000
-
-                        00111111111111111111111111111111
-                        11111111111111111111111111111111
-
-                        11000000000000000000000000000000
-                        00000000000000000000000000000000
-                        00000000000000000000000000000000
-                        00000000000000000000000000000000  
-    */
-
-
-    // Compute a^((p - 1)/2)
-
-    // First 256 bits = 2^8 bits
-    for(j = 0; j < 8; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 5) f_copy(t[0], t[2]);  // a^(2^64 - 1) = a^0b 11111111 11111111 11111111 11111111 11111111 11111111 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-
-
-    // Next 64 bits
-    for (i = 0; i < 64; i++)
-        f_mul(t[0], t[0], t[0]);
-
-    // Next 64 bits
-    for (i = 0; i < 64; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-    // Next 126 bits
-    for (i = 0; i < 126; i++)
-        f_mul(t[0], t[0], t[0]);
-
-
-    f_copy(t[0], b);
-
+void f_sqrt(const f_elm_t a, f_elm_t b)
+{
+    f_pow_sqrt(a, b);
 }
 
 
@@ -1,4 +1,5 @@
 #include "arith.h"
+#include "chains.h"
 
 extern void f_red_asm(f_elm_t a);
 extern void f_add_asm(const digit_t* a, const digit_t* b, digit_t* c);
@@ -105,6 +106,47 @@ void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c){
     f_mul_asm(a, b, c); }
 
 
+// Squaring of a multiprecision word (without reduction)
+void mp_sqr(const digit_t *a, digit_t *c)
+{ // Product scanning squaring, the cross products a[i]*a[j] (i < j) are computed once and doubled
+    digit_t t = 0, u = 0, v = 0;
+    uint128_t uv, UV;
+
+    for (int k = 0; k < 2 * WORDS_FIELD - 1; k++)
+    {
+        for (int i = (k < WORDS_FIELD ? 0 : k - WORDS_FIELD + 1); i < k - i; i++)
+        {
+            UV = (uint128_t)a[i] * a[k - i];
+            t += (digit_t)(UV >> (2 * RADIX - 1));
+            UV <<= 1;
+            uv = (((uint128_t)u << RADIX) | v) + UV;
+            t += (uv < UV);
+            u = (digit_t)(uv >> RADIX);
+            v = (digit_t)uv;
+        }
+        if ((k & 1) == 0)
+        {
+            UV = (uint128_t)a[k / 2] * a[k / 2];
+            uv = (((uint128_t)u << RADIX) | v) + UV;
+            t += (uv < UV);
+            u = (digit_t)(uv >> RADIX);
+            v = (digit_t)uv;
+        }
+        c[k] = v;
+        v = u;
+        u = t;
+        t = 0;
+    }
+    c[2 * WORDS_FIELD - 1] = v;
+}
+
+
+// Squaring of a field element
+// Uses the assembly multiplier, which is still faster than mp_sqr followed by a reduction in C
+inline void f_sqr(const f_elm_t a, f_elm_t c) {
+    f_mul_asm(a, a, c); }
+
+
 // Convert a number from value to Montgomery form  (a -> aR)
 void to_mont(const digit_t *a, f_elm_t b)
 {
@@ -120,183 +162,28 @@ void from_mont(const f_elm_t a, digit_t *b)
     mont_redc(t0, b);
 }
 
+#ifdef FERMAT_INVERSION
 // Multiplicative inverse of a field element
 void f_inv(const f_elm_t a, f_elm_t b)
 {
-
-    f_elm_t t[7];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
- 
-    /* p - 2 =     0b   01111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111110
-
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111\
-    */
-
-    // Compute a^(p-2)
-
-    // First 128 bits = 2^7 bits
-    for(j = 0; j < 7; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 1) f_copy(t[0], t[2]);  // a^(2^4  - 1) = a^0b 1111
-        if(j == 2) f_copy(t[0], t[3]);  // a^(2^8  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[4]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        if(j == 4) f_copy(t[0], t[5]);  // a^(2^32 - 1) = a^0b 11111111 11111111 11111111 11111111
-        if(j == 5) f_copy(t[0], t[6]);  // a^(2^64 - 1) = a^0b 11111111 11111111 11111111 11111111 11111111 11111111 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[5], t[0]);
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 4 bits
-    for (i = 0; i < 4; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-    // Next 2 bits
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-
-    // Next 1 bit
-    f_mul(t[0], t[0], t[0]);
-
-    // Next 128 bits
-    for (i = 0; i < 128; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[1], t[0]);
-
-    // Next 128 bits
-    for (i = 0; i < 128; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[1], t[0]);
-
-    // Next 64 bits
-    for (i = 0; i < 64; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[6], t[0]);
-
-
-    f_copy(t[0], b);  
-
+    f_pow_inv(a, b);
 }
+#endif
 
 
 
 
+#ifdef EULER_LEGENDRE
 // Legendre symbol of a field element
 void f_leg(const f_elm_t a, unsigned char *b)
 {
+    f_elm_t t0;
 
-    f_elm_t t[7];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
-
-    /* (p - 1)/2 = 0b   00111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        10000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-    */
-
-    // First 128 bits = 2^7 bits
-    for(j = 0; j < 7; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 0) f_copy(t[0], t[2]);  // a^(2^2  - 1) = a^0b 11
-        if(j == 1) f_copy(t[0], t[3]);  // a^(2^4  - 1) = a^0b 1111
-        if(j == 2) f_copy(t[0], t[4]);  // a^(2^8  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[5]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        if(j == 4) f_copy(t[0], t[6]);  // a^(2^32 - 1) = a^0b 11111111 11111111 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[6], t[0]);
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[5], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
-
-    // Next 4 bits
-    for (i = 0; i < 4; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 2 bits
-    for (i = 0; i < 2; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-    // Next 1 bit
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-
-    // Next 319 bits
-    for (i = 0; i < 319; i++)
-        f_mul(t[0], t[0], t[0]);
-
-    *b = ((*(unsigned char *)t[0]) & 0x01);
+    f_pow_leg(a, t0);                       // t0 = a^((p-1)/2) = 1, -1 or 0
 
+    *b = ((*(unsigned char *)t0) & 0x01);
 }
+#endif
 
 
 
@@ -307,7 +194,7 @@ void fp_2_sqr(const f_elm_t a[3], f_elm_t b[3]){
 
     f_elm_t t0, t1, t2;
 
-    f_mul(a[0], a[0], t0);  // t0 = a0^2
+    f_sqr(a[0], t0);  // t0 = a0^2
     f_mul(a[0], a[1], t1);  // t1 = a0 * a1
     f_mul(t0, a[2], t2);    // t2 = a0^2 * a1^2 * w
     
@@ -345,7 +232,7 @@ void fp_2_mul(const f_elm_t a[3], const f_elm_t b[3], f_elm_t c[3], const f_elm_
 
     f_add(t0, t1, c[0]);
 
-    f_mul(c[1], c[1], c[2]);
+    f_sqr(c[1], c[2]);
     f_mul(c[2], w, c[2]);
 
 }
@@ -386,11 +273,10 @@ void fp_2_mul(const f_elm_t a[3], const f_elm_t b[3], f_elm_t c[3], const f_elm_
 // Given that r is random, algorithm doesn't depend on a, but the run time is still not constant
 void f_sqrt(const f_elm_t a, f_elm_t b){
 
-    f_elm_t t[8][3] = {0};
+    f_elm_t t[2][3] = {0};
     f_elm_t a_temp[2];
     f_elm_t w;
 
-    int i, j;
     unsigned char s[1];
 
 
@@ -402,7 +288,7 @@ void f_sqrt(const f_elm_t a, f_elm_t b){
 
     do {// w = r^2 - a  AND non-square
         f_rand(t[0][0]);                    // r
-        f_mul(t[0][0], t[0][0], w);         // r^2
+        f_sqr(t[0][0], w);         // r^2
         f_sub(w, a_temp[0], w);             // w = r^2 - a
         f_leg(w, s);
     } while (1 - *s);
@@ -415,86 +301,10 @@ void f_sqrt(const f_elm_t a, f_elm_t b){
     f_neg(Mont_one, t[0][1]);
     f_copy(w, t[0][2]);
 
-    // t[1] = t[0]
-    f_copy(t[0][0], t[1][0]);
-    f_copy(t[0][1], t[1][1]);
-
-    // t[7] = t[0]
-    f_copy(t[0][0], t[7][0]);
-    f_copy(t[0][1], t[7][1]);
-
-
-    /* (p + 1)/2 = 0b   00111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        10000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000001
-    */
-
-    // (r - x)^(p + 1)/2 = sqrt(a) + 0 * x
-
-
-    // First 128 bits = 2^7 bits
-    for(j = 0; j < 7; j++){
-        for (i = 0; i < (1 << j); i++)
-            fp_2_sqr(t[0], t[0]);
-        fp_2_mul(t[0], t[1], t[0], w);
-        if(j == 0)  {f_copy(t[0][0], t[2][0]); f_copy(t[0][1], t[2][1]); }  // a^(2^2  - 1) = a^0b 11
-        if(j == 1)  {f_copy(t[0][0], t[3][0]); f_copy(t[0][1], t[3][1]); }  // a^(2^4  - 1) = a^0b 1111
-        if(j == 2)  {f_copy(t[0][0], t[4][0]); f_copy(t[0][1], t[4][1]); }  // a^(2^8  - 1) = a^0b 11111111
-        if(j == 3)  {f_copy(t[0][0], t[5][0]); f_copy(t[0][1], t[5][1]); }  // a^(2^16 - 1) = a^0b 11111111 11111111
-        if(j == 4)  {f_copy(t[0][0], t[6][0]); f_copy(t[0][1], t[6][1]); }  // a^(2^32 - 1) = a^0b 11111111 11111111 11111111 11111111
-                    {f_copy(t[0][0], t[1][0]); f_copy(t[0][1], t[1][1]); }  // a^(2^(2^(j+1)) - 1)
-    }
-
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        fp_2_sqr(t[0], t[0]);
-    fp_2_mul(t[0], t[6], t[0], w);
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        fp_2_sqr(t[0], t[0]);
-    fp_2_mul(t[0], t[5], t[0], w);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        fp_2_sqr(t[0], t[0]);
-    fp_2_mul(t[0], t[4], t[0], w);
-
-    // Next 4 bits
-    for (i = 0; i < 4; i++)
-        fp_2_sqr(t[0], t[0]);
-    fp_2_mul(t[0], t[3], t[0], w);
-
-    // Next 2 bits
-    for (i = 0; i < 2; i++)
-        fp_2_sqr(t[0], t[0]);
-    fp_2_mul(t[0], t[2], t[0], w);
-
-    // Next 1 bit
-        fp_2_sqr(t[0], t[0]);
-    fp_2_mul(t[0], t[7], t[0], w);
-
-    // Next 319 bits
-    for(i = 0; i < 319; i++)
-        fp_2_sqr(t[0], t[0]);
-    fp_2_mul(t[0], t[7], t[0], w);
-
-
-    cond_select(a, t[0][0], b, f_eq(a, Zero));
+    // (r - x)^((p + 1)/2) = sqrt(a) + 0 * x
+    fp_2_pow_sqrt(t[0], t[1], w);
 
+    cond_select(a, t[1][0], b, f_eq(a, Zero));
 }
 
 
@@ -536,7 +346,7 @@ void f_sqrt(const f_elm_t a, f_elm_t b){
 //     // First 128 bits = 2^7 bits
 //     for(j = 0; j < 7; j++){
 //         for (i = 0; i < (1u << j); i++)
-//             f_mul(t[0], t[0], t[0]);
+//             f_sqr(t[0], t[0]);
 //         f_mul(t[0], t[1], t[0]);
 //         if(j == 0) f_copy(t[0], t[2]);  // a^(2^2  - 1) = a^0b 11
 //         if(j == 1) f_copy(t[0], t[3]);  // a^(2^4  - 1) = a^0b 1111
@@ -548,31 +358,31 @@ void f_sqrt(const f_elm_t a, f_elm_t b){
 
 //     // Next 32 bits
 //     for (i = 0; i < 32; i++)
-//         f_mul(t[0], t[0], t[0]);
+//         f_sqr(t[0], t[0]);
 //     f_mul(t[0], t[6], t[0]);
 
 //     // Next 16 bits
 //     for (i = 0; i < 16; i++)
-//         f_mul(t[0], t[0], t[0]);
+//         f_sqr(t[0], t[0]);
 //     f_mul(t[0], t[5], t[0]);
 
 //     // Next 8 bits
 //     for (i = 0; i < 8; i++)
-//         f_mul(t[0], t[0], t[0]);
+//         f_sqr(t[0], t[0]);
 //     f_mul(t[0], t[4], t[0]);
 
 //     // Next 4 bits
 //     for (i = 0; i < 4; i++)
-//         f_mul(t[0], t[0], t[0]);
+//         f_sqr(t[0], t[0]);
 //     f_mul(t[0], t[3], t[0]);
 
 //     // Next 2 bits
 //     for (i = 0; i < 2; i++)
-//         f_mul(t[0], t[0], t[0]);
+//         f_sqr(t[0], t[0]);
 //     f_mul(t[0], t[2], t[0]);
 
 //     // Next 1 bit
-//     f_mul(t[0], t[0], t[0]);
+//     f_sqr(t[0], t[0]);
 //     f_mul(t[0], a, t[0]);
 
 //     // t[0] = a^d
@@ -580,18 +390,18 @@ void f_sqrt(const f_elm_t a, f_elm_t b){
 //     // t[1] = a^((d+1)/2)
 //     f_copy(a, t[1]);
 //     for(i = 0; i < 190; i++)
-//         f_mul(t[1], t[1], t[1]);
+//         f_sqr(t[1], t[1]);
 
 
 //     for(i = 318; i >= 0; i--){
 
 //         f_copy(psi, psi_old);
-//         f_mul(psi, psi, psi);
+//         f_sqr(psi, psi);
 
 
 //         f_copy(t[0], t[2]);
 //         for(j = 0; j < i; j++)
-//             f_mul(t[2], t[2], t[2]);
+//             f_sqr(t[2], t[2]);
 
 //         cond_select(psi_old, Mont_one, t[3], f_neq(t[2], Mont_one));
 //         cond_select(psi,     Mont_one, t[4], f_neq(t[2], Mont_one));
@@ -0,0 +1,163 @@
+// Generated by tools/addchain.py, do not edit
+// Exponentiations by fixed powers of p = 0x7FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF00000000000000000000000000000000000000000000000000000000000000000000000000000001
+
+#ifndef CHAINS_H
+#define CHAINS_H
+
+#ifdef FERMAT_INVERSION
+// b = a^(p - 2), 510 squarings and 12 multiplications
+static void f_pow_inv(const f_elm_t a, f_elm_t b)
+{
+    f_elm_t t[3];
+    unsigned int i;
+
+    f_sqr(a, t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^3
+    f_sqr(t[0], t[1]);
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^4 - 1)
+    f_sqr(t[1], t[2]);
+    for (i = 0; i < 3; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[1], t[2]);                // t[2] = a^(2^8 - 1)
+    f_sqr(t[2], t[2]);
+    f_sqr(t[2], t[2]);
+    f_mul(t[2], t[0], t[2]);                // t[2] = a^(2^10 - 1)
+    f_sqr(t[2], t[0]);
+    for (i = 0; i < 9; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[2], t[0]);                // t[0] = a^(2^20 - 1)
+    f_sqr(t[0], t[1]);
+    for (i = 0; i < 19; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^40 - 1)
+    for (i = 0; i < 20; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^60 - 1)
+    f_sqr(t[1], t[0]);
+    for (i = 0; i < 59; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[1], t[0]);                // t[0] = a^(2^120 - 1)
+    for (i = 0; i < 10; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[2], t[0]);                // t[0] = a^(2^130 - 1)
+    f_sqr(t[0], t[2]);
+    for (i = 0; i < 59; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[1], t[2]);                // t[2] = a^(2^190 - 1)
+
+    // bits 319 to 0, 320 ones
+    f_sqr(t[2], t[1]);
+    for (i = 0; i < 190; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[2], t[1]);
+    for (i = 0; i < 130; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);
+
+    f_copy(t[1], b);
+}
+#endif
+
+#ifdef EULER_LEGENDRE
+// b = a^((p - 1)/2), 509 squarings and 11 multiplications
+static void f_pow_leg(const f_elm_t a, f_elm_t b)
+{
+    f_elm_t t[4];
+    unsigned int i;
+
+    f_sqr(a, t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^3
+    f_sqr(t[0], t[1]);
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^4 - 1)
+    f_sqr(t[1], t[0]);
+    for (i = 0; i < 3; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[1], t[0]);                // t[0] = a^(2^8 - 1)
+    f_sqr(t[0], t[2]);
+    for (i = 0; i < 7; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[0], t[2]);                // t[2] = a^(2^16 - 1)
+    f_sqr(t[2], t[0]);
+    for (i = 0; i < 15; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[2], t[0]);                // t[0] = a^(2^32 - 1)
+    f_sqr(t[0], t[3]);
+    for (i = 0; i < 15; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[2], t[3]);                // t[3] = a^(2^48 - 1)
+    for (i = 0; i < 4; i++)
+        f_sqr(t[3], t[3]);
+    f_mul(t[3], t[1], t[3]);                // t[3] = a^(2^52 - 1)
+    f_sqr(t[3], t[3]);
+    f_mul(t[3], a, t[3]);                   // t[3] = a^(2^53 - 1)
+    f_sqr(t[3], t[1]);
+    for (i = 0; i < 52; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[3], t[1]);                // t[1] = a^(2^106 - 1)
+    for (i = 0; i < 53; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[3], t[1]);                // t[1] = a^(2^159 - 1)
+    for (i = 0; i < 32; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^191 - 1)
+
+    // bits 318 to 0, zeros
+    for (i = 0; i < 319; i++)
+        f_sqr(t[1], t[1]);
+
+    f_copy(t[1], b);
+}
+#endif
+
+// b = a^((p + 1)/2) in Fp2, 509 squarings and 12 multiplications
+static void fp_2_pow_sqrt(const f_elm_t a[3], f_elm_t b[3], const f_elm_t w)
+{
+    f_elm_t t[4][3];
+    unsigned int i;
+
+    fp_2_sqr(a, t[0]);
+    fp_2_mul(t[0], a, t[0], w);             // t[0] = a^3
+    fp_2_sqr(t[0], t[1]);
+    fp_2_sqr(t[1], t[1]);
+    fp_2_mul(t[1], t[0], t[1], w);          // t[1] = a^(2^4 - 1)
+    fp_2_sqr(t[1], t[0]);
+    for (i = 0; i < 3; i++)
+        fp_2_sqr(t[0], t[0]);
+    fp_2_mul(t[0], t[1], t[0], w);          // t[0] = a^(2^8 - 1)
+    fp_2_sqr(t[0], t[2]);
+    for (i = 0; i < 7; i++)
+        fp_2_sqr(t[2], t[2]);
+    fp_2_mul(t[2], t[0], t[2], w);          // t[2] = a^(2^16 - 1)
+    fp_2_sqr(t[2], t[0]);
+    for (i = 0; i < 15; i++)
+        fp_2_sqr(t[0], t[0]);
+    fp_2_mul(t[0], t[2], t[0], w);          // t[0] = a^(2^32 - 1)
+    fp_2_sqr(t[0], t[3]);
+    for (i = 0; i < 15; i++)
+        fp_2_sqr(t[3], t[3]);
+    fp_2_mul(t[3], t[2], t[3], w);          // t[3] = a^(2^48 - 1)
+    for (i = 0; i < 4; i++)
+        fp_2_sqr(t[3], t[3]);
+    fp_2_mul(t[3], t[1], t[3], w);          // t[3] = a^(2^52 - 1)
+    fp_2_sqr(t[3], t[3]);
+    fp_2_mul(t[3], a, t[3], w);             // t[3] = a^(2^53 - 1)
+    fp_2_sqr(t[3], t[1]);
+    for (i = 0; i < 52; i++)
+        fp_2_sqr(t[1], t[1]);
+    fp_2_mul(t[1], t[3], t[1], w);          // t[1] = a^(2^106 - 1)
+    for (i = 0; i < 53; i++)
+        fp_2_sqr(t[1], t[1]);
+    fp_2_mul(t[1], t[3], t[1], w);          // t[1] = a^(2^159 - 1)
+    for (i = 0; i < 32; i++)
+        fp_2_sqr(t[1], t[1]);
+    fp_2_mul(t[1], t[0], t[1], w);          // t[1] = a^(2^191 - 1)
+
+    // bit 0
+    for (i = 0; i < 319; i++)
+        fp_2_sqr(t[1], t[1]);
+    fp_2_mul(t[1], a, b, w);
+}
+
+#endif
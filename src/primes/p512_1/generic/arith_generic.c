@@ -1,4 +1,11 @@
 #include "arith.h"
+#include "chains.h"
+
+// Operands of at least KARATSUBA_THRESHOLD words use Karatsuba multiplication, set by CMake
+// (8: one level with 4x4 schoolbook leaves, 4: two levels, 16: schoolbook only)
+#ifndef KARATSUBA_THRESHOLD
+    #define KARATSUBA_THRESHOLD 16
+#endif
 
 
 // Reduction modulo p
@@ -35,6 +42,58 @@ void f_rand(f_elm_t a)
     f_red(a); // Not uniformly random, can use rejection sampling to fix, thought it's pretty close to uniform
 }
 
+#ifdef REDUNDANT_FORM
+// Addition of two field elements, inputs and output in [0, 2p)
+// The sum is below 4p < 2^513, the bits from 2^511 up are folded back with 2^511 = 2^320 - 1 (mod p)
+void f_add(const f_elm_t a, const f_elm_t b, f_elm_t c)
+{
+    digit_t top, carry = 0;
+    int128_t acc;
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+        ADDC(carry, a[i], b[i], c[i]);
+
+    top = (carry << 1) | (c[WORDS_FIELD - 1] >> 63);
+    c[WORDS_FIELD - 1] &= 0x7FFFFFFFFFFFFFFF;
+
+    acc = -(int128_t)top;
+    for (int i = 0; i < WORDS_FIELD; i++)
+    {
+        acc += (int128_t)c[i] + (i == 5 ? top : 0);
+        c[i] = (digit_t)acc;
+        acc >>= RADIX;
+    }
+}
+
+// Subtraction of two field elements, inputs and output in [0, 2p)
+// A borrow adds 2p = R - Mont_one
+void f_sub(const f_elm_t a, const f_elm_t b, f_elm_t c)
+{
+    digit_t mask, borrow = 0;
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+        SUBC(borrow, a[i], b[i], c[i]);
+
+    mask = 0 - borrow;
+    borrow = 0;
+    for (int i = 0; i < WORDS_FIELD; i++)
+        SUBC(borrow, c[i], Mont_one[i] & mask, c[i]);
+}
+
+// Negation of a field element, input and output in [0, 2p)
+void f_neg(const f_elm_t a, f_elm_t b)
+{
+    digit_t mask, borrow = 0;
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+        SUBC(borrow, 0, a[i], b[i]);
+
+    mask = 0 - borrow;
+    borrow = 0;
+    for (int i = 0; i < WORDS_FIELD; i++)
+        SUBC(borrow, b[i], Mont_one[i] & mask, b[i]);
+}
+#else
 // Addition of two field elements
 void f_add(const f_elm_t a, const f_elm_t b, f_elm_t c)
 {
@@ -77,44 +136,164 @@ void f_neg(const f_elm_t a, f_elm_t b)
 
     f_red(b);
 }
+#endif
 
-// Multiplication of two multiprecision words (without reduction)
-void mp_mul(const digit_t *a, const digit_t *b, digit_t *c)
-{ // Schoolbook multiplication
-    digit_t carry, UV[2], t = 0, u = 0, v = 0;
+// Schoolbook multiplication of n-word integers, operand scanning with one row a*b[i] per iteration
+static inline void mp_mul_school(const digit_t *a, const digit_t *b, digit_t *c, const int n)
+{
+    uint128_t uv = 0;
 
-    for (int i = 0; i < WORDS_FIELD; i++)
+    for (int j = 0; j < n; j++)
     {
-        for (int j = 0; j <= i; j++)
+        uv = (uint128_t)a[j] * b[0] + (digit_t)(uv >> RADIX);
+        c[j] = (digit_t)uv;
+    }
+    c[n] = (digit_t)(uv >> RADIX);
+
+    for (int i = 1; i < n; i++)
+    {
+        uv = 0;
+        for (int j = 0; j < n; j++)
         {
-            carry = 0;
-            MUL(a[j], b[i - j], UV + 1, UV[0]);
-            ADDC(carry, UV[0], v, v);
-            ADDC(carry, UV[1], u, u);
-            t += carry;
+            uv = (uint128_t)a[j] * b[i] + c[i + j] + (digit_t)(uv >> RADIX);
+            c[i + j] = (digit_t)uv;
         }
-        c[i] = v;
-        v = u;
-        u = t;
-        t = 0;
+        c[i + n] = (digit_t)(uv >> RADIX);
     }
+}
 
-    for (int i = WORDS_FIELD; i < 2 * WORDS_FIELD - 1; i++)
+// Schoolbook squaring of n-word integers, the cross products a[i]*a[j] (i < j) are computed once and doubled
+static inline void mp_sqr_school(const digit_t *a, digit_t *c, const int n)
+{
+    digit_t t = 0, u = 0, v = 0;
+    uint128_t uv, UV;
+
+    for (int k = 0; k < 2 * n - 1; k++)
     {
-        for (int j = i - WORDS_FIELD + 1; j < WORDS_FIELD; j++)
+        for (int i = (k < n ? 0 : k - n + 1); i < k - i; i++)
+        {
+            UV = (uint128_t)a[i] * a[k - i];
+            t += (digit_t)(UV >> (2 * RADIX - 1));
+            UV <<= 1;
+            uv = (((uint128_t)u << RADIX) | v) + UV;
+            t += (uv < UV);
+            u = (digit_t)(uv >> RADIX);
+            v = (digit_t)uv;
+        }
+        if ((k & 1) == 0)
         {
-            carry = 0;
-            MUL(a[j], b[i - j], UV + 1, UV[0]);
-            ADDC(carry, UV[0], v, v);
-            ADDC(carry, UV[1], u, u);
-            t += carry;
+            UV = (uint128_t)a[k / 2] * a[k / 2];
+            uv = (((uint128_t)u << RADIX) | v) + UV;
+            t += (uv < UV);
+            u = (digit_t)(uv >> RADIX);
+            v = (digit_t)uv;
         }
-        c[i] = v;
+        c[k] = v;
         v = u;
         u = t;
         t = 0;
     }
-    c[2 * WORDS_FIELD - 1] = v;
+    c[2 * n - 1] = v;
+}
+
+// Adds the Karatsuba middle term to z = z0 + z2*2^(64n), where d = |a0 - a1|*|b1 - b0| and mask is all ones
+// if (a0 - a1)*(b1 - b0) is negative: z += (z0 + z2 +- d)*2^(64n/2)
+static inline void mp_kara_middle(digit_t *z, const digit_t *d, const digit_t mask, const int n)
+{
+    digit_t s[WORDS_FIELD], carry = 0, top;
+
+    for (int i = 0; i < n; i++)
+        ADDC(carry, z[i], z[n + i], s[i]);
+    top = carry;
+
+    carry = mask & 1;
+    for (int i = 0; i < n; i++)
+        ADDC(carry, s[i], d[i] ^ mask, s[i]);
+    top += carry + mask;
+
+    carry = 0;
+    for (int i = 0; i < n; i++)
+        ADDC(carry, z[n / 2 + i], s[i], z[n / 2 + i]);
+    for (int i = n + n / 2; i < 2 * n; i++)
+    {
+        ADDC(carry, z[i], top, z[i]);
+        top = 0;
+    }
+}
+
+// Karatsuba multiplication of n-word integers, operands below KARATSUBA_THRESHOLD words use schoolbook
+// a*b = z2*2^(64n) + (z0 + z2 + (a0 - a1)*(b1 - b0))*2^(64n/2) + z0, with z0 = a0*b0 and z2 = a1*b1
+static void mp_mul_karatsuba(const digit_t *a, const digit_t *b, digit_t *c, const int n)
+{
+    const int h = n / 2;
+    digit_t da[WORDS_FIELD / 2], db[WORDS_FIELD / 2], d[WORDS_FIELD], ma, mb, carry;
+
+    if (n < KARATSUBA_THRESHOLD || (n & 1))
+    {
+        mp_mul_school(a, b, c, n);
+        return;
+    }
+
+    // da = |a0 - a1| and db = |b1 - b0|, ma and mb are all ones if the difference is negative
+    carry = 0;
+    for (int i = 0; i < h; i++)
+        SUBC(carry, a[i], a[h + i], da[i]);
+    ma = 0 - carry;
+    carry = 0;
+    for (int i = 0; i < h; i++)
+        SUBC(carry, b[h + i], b[i], db[i]);
+    mb = 0 - carry;
+
+    carry = ma & 1;
+    for (int i = 0; i < h; i++)
+        ADDC(carry, da[i] ^ ma, 0, da[i]);
+    carry = mb & 1;
+    for (int i = 0; i < h; i++)
+        ADDC(carry, db[i] ^ mb, 0, db[i]);
+
+    mp_mul_karatsuba(a, b, c, h);
+    mp_mul_karatsuba(a + h, b + h, c + n, h);
+    mp_mul_karatsuba(da, db, d, h);
+    mp_kara_middle(c, d, ma ^ mb, n);
+}
+
+// Karatsuba squaring of n-word integers, a^2 = z2*2^(64n) + (z0 + z2 - (a0 - a1)^2)*2^(64n/2) + z0
+static void mp_sqr_karatsuba(const digit_t *a, digit_t *c, const int n)
+{
+    const int h = n / 2;
+    digit_t da[WORDS_FIELD / 2], d[WORDS_FIELD], ma, carry;
+
+    if (n < KARATSUBA_THRESHOLD || (n & 1))
+    {
+        mp_sqr_school(a, c, n);
+        return;
+    }
+
+    // da = |a0 - a1|
+    carry = 0;
+    for (int i = 0; i < h; i++)
+        SUBC(carry, a[i], a[h + i], da[i]);
+    ma = 0 - carry;
+    carry = ma & 1;
+    for (int i = 0; i < h; i++)
+        ADDC(carry, da[i] ^ ma, 0, da[i]);
+
+    mp_sqr_karatsuba(a, c, h);
+    mp_sqr_karatsuba(a + h, c + n, h);
+    mp_sqr_karatsuba(da, d, h);
+    mp_kara_middle(c, d, 0 - (digit_t)1, n);
+}
+
+// Multiplication of two multiprecision words (without reduction), c must not overlap a or b
+void mp_mul(const digit_t *a, const digit_t *b, digit_t *c)
+{
+    mp_mul_karatsuba(a, b, c, WORDS_FIELD);
+}
+
+// Squaring of a multiprecision word (without reduction), c must not overlap a
+void mp_sqr(const digit_t *a, digit_t *c)
+{
+    mp_sqr_karatsuba(a, c, WORDS_FIELD);
 }
 
 // // Montgomery form reduction after multiplication
@@ -150,28 +329,66 @@ void mp_mul(const digit_t *a, const digit_t *b, digit_t *c)
 // Montgomery form reduction after multiplication
 void mont_redc(const digit_t *a, digit_t *c)
 {
-    // c = a*R^-1 mod p, where R = 2^256.
-    // If a < 2^256*p, the output c is in the range [0, p).
-    // a is assumed to be in Montgomery representation.
-    digit_t mask, carry = 0;
-    digit_t t0[2 * WORDS_FIELD], t1[WORDS_FIELD];
+    // c = a*R^-1 mod p, where R = 2^512.
+    // If a < 2^512*p, the output c is in the range [0, p), if a < 4p^2 it is in [0, 2p).
+    // p = 2^511 - 2^320 + 1 = 1 mod 2^320, so the quotient is m = -a mod 2^320 without any multiplication,
+    // and m*p = m*2^511 - m*2^320 + m is added with shifts. R is cleared in two steps of 320 and 192 bits.
+    digit_t t[11], m[11] = {0}, s[11] = {0}, mask, top, borrow = 0, carry = 0;
+    int128_t acc;
+
+    // m = -a mod 2^320, so a + m = borrow*2^320
+    for (int i = 0; i < 5; i++)
+        SUBC(borrow, 0, a[i], m[i]);
 
-    mp_mul(a, ip, t0);
-    f_copy(t0, t1);
-    mp_mul(t1, p, t0);
+    // s = m*2^191
+    s[2] = m[0] << 63;
+    for (int i = 3; i < 8; i++)
+        s[i] = (m[i - 2] << 63) | (m[i - 3] >> 1);
 
-    for (int i = WORDS_FIELD; i < 2 * WORDS_FIELD; i++)
-        SUBC(carry, a[i], t0[i], t0[i]);
+    // t = (a + m*p) / 2^320 = a / 2^320 + borrow + m*2^191 - m
+    acc = borrow;
+    for (int i = 0; i < 11; i++)
+    {
+        acc += (int128_t)a[5 + i] + s[i] - m[i];
+        t[i] = (digit_t)acc;
+        acc >>= RADIX;
+    }
 
+    // m = -t mod 2^192, so t + m = borrow*2^192
+    borrow = 0;
+    for (int i = 0; i < 3; i++)
+        SUBC(borrow, 0, t[i], m[i]);
 
-    mask = 0 - carry;
-    carry = 0;
+    // s = m*2^319 - m*2^128
+    for (int i = 0; i < WORDS_FIELD; i++)
+        s[i] = 0;
+    s[4] = m[0] << 63;
+    s[5] = (m[1] << 63) | (m[0] >> 1);
+    s[6] = (m[2] << 63) | (m[1] >> 1);
+    s[7] = m[2] >> 1;
+
+    // c = (t + m*p) / 2^192 = t / 2^192 + borrow + m*2^319 - m*2^128 < 2p (3p for a < 4p^2, top holds bit 512)
+    acc = borrow;
+    for (int i = 0; i < WORDS_FIELD; i++)
+    {
+        acc += (int128_t)t[3 + i] + s[i] - (i >= 2 && i < 5 ? m[i - 2] : 0);
+        c[i] = (digit_t)acc;
+        acc >>= RADIX;
+    }
+    top = (digit_t)acc;
+
+    // Subtract p and add it back if that borrows
+    borrow = 0;
     for (int i = 0; i < WORDS_FIELD; i++)
-        ADDC(carry, t0[WORDS_FIELD + i], p[i] & mask, c[i]);
+        SUBC(borrow, c[i], p[i], c[i]);
+    SUBC(borrow, top, 0, mask);
 
+    for (int i = 0; i < WORDS_FIELD; i++)
+        ADDC(carry, c[i], p[i] & mask, c[i]);
 }
 
 
+#ifndef BARRETT_FORM
 // Multiplication of field elements
 void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c)
 {
@@ -183,6 +400,33 @@ void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c)
 
 
 
+// Squaring of a field element
+void f_sqr(const f_elm_t a, f_elm_t c)
+{
+    digit_t t0[2 * WORDS_FIELD] = {0};
+
+    mp_sqr(a, t0);
+    mont_redc(t0, c);
+}
+#endif
+
+
+
+#ifdef CANONICAL_FORM
+// Elements are kept in canonical form, the conversions only apply the final correction
+void to_mont(const digit_t *a, f_elm_t b)
+{
+    f_copy(a, b);
+    f_red(b);
+}
+
+
+void from_mont(const f_elm_t a, digit_t *b)
+{
+    f_copy(a, b);
+    f_red(b);
+}
+#else
 // Convert a number from value to Montgomery form  (a -> aR)
 void to_mont(const digit_t *a, f_elm_t b)
 {
@@ -197,196 +441,50 @@ void from_mont(const f_elm_t a, digit_t *b)
     f_copy(a, t0);
     mont_redc(t0, b);
 }
+#endif
 
 
+#ifdef FERMAT_INVERSION
 // Multiplicative inverse of a field element
 void f_inv(const f_elm_t a, f_elm_t b)
 {
-
-    f_elm_t t[7];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
- 
-    /* p - 2 =     0b   01111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111110
-
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111\
-    */
-
-    // Compute a^(p-2)
-
-    // First 128 bits = 2^7 bits
-    for(j = 0; j < 7; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 1) f_copy(t[0], t[2]);  // a^(2^4  - 1) = a^0b 1111
-        if(j == 2) f_copy(t[0], t[3]);  // a^(2^8  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[4]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        if(j == 4) f_copy(t[0], t[5]);  // a^(2^32 - 1) = a^0b 11111111 11111111 11111111 11111111
-        if(j == 5) f_copy(t[0], t[6]);  // a^(2^64 - 1) = a^0b 11111111 11111111 11111111 11111111 11111111 11111111 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[5], t[0]);
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 4 bits
-    for (i = 0; i < 4; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-    // Next 2 bits
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-
-    // Next 1 bit
-    f_mul(t[0], t[0], t[0]);
-
-    // Next 128 bits
-    for (i = 0; i < 128; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[1], t[0]);
-
-    // Next 128 bits
-    for (i = 0; i < 128; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[1], t[0]);
-
-    // Next 64 bits
-    for (i = 0; i < 64; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[6], t[0]);
-
-
-    f_copy(t[0], b);  
-
+    f_pow_inv(a, b);
 }
+#endif
 
 
 
 
+#ifdef EULER_LEGENDRE
 // Legendre symbol of a field element
 void f_leg(const f_elm_t a, unsigned char *b)
 {
-
-    f_elm_t t[7];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
-
-    /* (p - 1)/2 = 0b   00111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        10000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-    */
-
-    // First 128 bits = 2^7 bits
-    for(j = 0; j < 7; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 0) f_copy(t[0], t[2]);  // a^(2^2  - 1) = a^0b 11
-        if(j == 1) f_copy(t[0], t[3]);  // a^(2^4  - 1) = a^0b 1111
-        if(j == 2) f_copy(t[0], t[4]);  // a^(2^8  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[5]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        if(j == 4) f_copy(t[0], t[6]);  // a^(2^32 - 1) = a^0b 11111111 11111111 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[6], t[0]);
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[5], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
-
-    // Next 4 bits
-    for (i = 0; i < 4; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 2 bits
-    for (i = 0; i < 2; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-    // Next 1 bit
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-
-    // Next 319 bits
-    for (i = 0; i < 319; i++)
-        f_mul(t[0], t[0], t[0]);
-
-    *b = ((*(unsigned char *)t[0]) & 0x01);
-
+    f_elm_t t0;
+
+    f_pow_leg(a, t0);                       // t0 = a^((p-1)/2) = 1, -1 or 0
+
+#ifdef CANONICAL_FORM
+    f_add(t0, One, t0);                     // t0 = 0 iff a^((p-1)/2) = -1
+    *b = 1 - f_eq(t0, Zero);
+#else
+#ifdef REDUNDANT_FORM
+    f_red(t0);                              // The parity test needs the canonical representative
+#endif
+    *b = ((*(unsigned char *)t0) & 0x01);
+#endif
 }
+#endif
 
 
 
 
 // a = a0 + a1*a;   a[0] = a0, a[1] = a1, a[2] = a1^2 * w
 // b = a^2 mod x^2 - w
-void fp_2_sqr(const f_elm_t* a, f_elm_t* b){
+void fp_2_sqr(const f_elm_t a[3], f_elm_t b[3]){
 
     f_elm_t t0, t1, t2;
 
-    f_mul(a[0], a[0], t0);  // t0 = a0^2
+    f_sqr(a[0], t0);  // t0 = a0^2
     f_mul(a[0], a[1], t1);  // t1 = a0 * a1
     f_mul(t0, a[2], t2);    // t2 = a0^2 * a1^2 * w
     
@@ -424,7 +522,7 @@ void fp_2_mul(const f_elm_t a[3], const f_elm_t b[3], f_elm_t c[3], const f_elm_
 
     f_add(t0, t1, c[0]);
 
-    f_mul(c[1], c[1], c[2]);
+    f_sqr(c[1], c[2]);
     f_mul(c[2], w, c[2]);
 
 }
@@ -464,23 +562,22 @@ void fp_2_mul(const f_elm_t a[3], const f_elm_t b[3], f_elm_t c[3], const f_elm_
 // Given that r is random, algorithm doesn't depend on a, but the run time is still not constant
 void f_sqrt(const f_elm_t a, f_elm_t b){
 
-    f_elm_t t[8][3] = {0};
+    f_elm_t t[2][3] = {0};
     f_elm_t a_temp[2];
     f_elm_t w;
 
-    unsigned int i, j;
     unsigned char s[1];
 
 
     // IF a = 0 the algorithm doesn't work. 
     // In that case set a = 1, and return 0 only at the end.
-    cond_select(Mont_one, a, a_temp[0], f_eq(a, Zero));
+    cond_select(F_ONE, a, a_temp[0], f_eq(a, Zero));
     f_copy(Zero, a_temp[1]);
 
 
     do {// w = r^2 - a  AND non-square
         f_rand(t[0][0]);                    // r
-        f_mul(t[0][0], t[0][0], w);         // r^2
+        f_sqr(t[0][0], w);         // r^2
         f_sub(w, a_temp[0], w);             // w = r^2 - a
         f_leg(w, s);
     } while (1 - *s);
@@ -490,93 +587,13 @@ void f_sqrt(const f_elm_t a, f_elm_t b){
     // t[0] = t0 + t1 * x
     // t[0] is represented as a triple; 
     // t[0] = (t0, t1, t1^2 * w)
-    f_neg(Mont_one, t[0][1]);
+    f_neg(F_ONE, t[0][1]);
     f_copy(w, t[0][2]);
 
-    // t[1] = t[0]
-    f_copy(t[0][0], t[1][0]);
-    f_copy(t[0][1], t[1][1]);
-
-    // t[7] = t[0]
-    f_copy(t[0][0], t[7][0]);
-    f_copy(t[0][1], t[7][1]);
-
-
-    /* (p + 1)/2 = 0b   00111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-
-                        11111111 11111111 11111111 11111111
-                        11111111 11111111 11111111 11111111
-
-                        10000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000000
-
-                        00000000 00000000 00000000 00000000
-                        00000000 00000000 00000000 00000001
-    */
-
-    // (r - x)^(p + 1)/2 = sqrt(a) + 0 * x
-
-
-    // First 128 bits = 2^7 bits
-    for(j = 0; j < 7; j++){
-        for (i = 0; i < (1u << j); i++)
-            fp_2_sqr(t[0], t[0]);
-        fp_2_mul(t[0], t[1], t[0], w);
-        if(j == 0)  {f_copy(t[0][0], t[2][0]); f_copy(t[0][1], t[2][1]); }  // a^(2^2  - 1) = a^0b 11
-        if(j == 1)  {f_copy(t[0][0], t[3][0]); f_copy(t[0][1], t[3][1]); }  // a^(2^4  - 1) = a^0b 1111
-        if(j == 2)  {f_copy(t[0][0], t[4][0]); f_copy(t[0][1], t[4][1]); }  // a^(2^8  - 1) = a^0b 11111111
-        if(j == 3)  {f_copy(t[0][0], t[5][0]); f_copy(t[0][1], t[5][1]); }  // a^(2^16 - 1) = a^0b 11111111 11111111
-        if(j == 4)  {f_copy(t[0][0], t[6][0]); f_copy(t[0][1], t[6][1]); }  // a^(2^32 - 1) = a^0b 11111111 11111111 11111111 11111111
-                    {f_copy(t[0][0], t[1][0]); f_copy(t[0][1], t[1][1]); }  // a^(2^(2^(j+1)) - 1)
-    }
-
-    // Next 32 bits
-    for (i = 0; i < 32; i++)
-        fp_2_sqr(t[0], t[0]);
-    fp_2_mul(t[0], t[6], t[0], w);
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        fp_2_sqr(t[0], t[0]);
-    fp_2_mul(t[0], t[5], t[0], w);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        fp_2_sqr(t[0], t[0]);
-    fp_2_mul(t[0], t[4], t[0], w);
-
-    // Next 4 bits
-    for (i = 0; i < 4; i++)
-        fp_2_sqr(t[0], t[0]);
-    fp_2_mul(t[0], t[3], t[0], w);
-
-    // Next 2 bits
-    for (i = 0; i < 2; i++)
-        fp_2_sqr(t[0], t[0]);
-    fp_2_mul(t[0], t[2], t[0], w);
-
-    // Next 1 bit
-        fp_2_sqr(t[0], t[0]);
-    fp_2_mul(t[0], t[7], t[0], w);
-
-    // Next 319 bits
-    for(i = 0; i < 319; i++)
-        fp_2_sqr(t[0], t[0]);
-    fp_2_mul(t[0], t[7], t[0], w);
-
-
-    cond_select(a, t[0][0], b, f_eq(a, Zero));
+    // (r - x)^((p + 1)/2) = sqrt(a) + 0 * x
+    fp_2_pow_sqrt(t[0], t[1], w);
 
+    cond_select(a, t[1][0], b, f_eq(a, Zero));
 }
 
 
@@ -618,7 +635,7 @@ void f_sqrt(const f_elm_t a, f_elm_t b){
 //     // First 128 bits = 2^7 bits
 //     for(j = 0; j < 7; j++){
 //         for (i = 0; i < (1u << j); i++)
-//             f_mul(t[0], t[0], t[0]);
+//             f_sqr(t[0], t[0]);
 //         f_mul(t[0], t[1], t[0]);
 //         if(j == 0) f_copy(t[0], t[2]);  // a^(2^2  - 1) = a^0b 11
 //         if(j == 1) f_copy(t[0], t[3]);  // a^(2^4  - 1) = a^0b 1111
@@ -630,31 +647,31 @@ void f_sqrt(const f_elm_t a, f_elm_t b){
 
 //     // Next 32 bits
 //     for (i = 0; i < 32; i++)
-//         f_mul(t[0], t[0], t[0]);
+//         f_sqr(t[0], t[0]);
 //     f_mul(t[0], t[6], t[0]);
 
 //     // Next 16 bits
 //     for (i = 0; i < 16; i++)
-//         f_mul(t[0], t[0], t[0]);
+//         f_sqr(t[0], t[0]);
 //     f_mul(t[0], t[5], t[0]);
 
 //     // Next 8 bits
 //     for (i = 0; i < 8; i++)
-//         f_mul(t[0], t[0], t[0]);
+//         f_sqr(t[0], t[0]);
 //     f_mul(t[0], t[4], t[0]);
 
 //     // Next 4 bits
 //     for (i = 0; i < 4; i++)
-//         f_mul(t[0], t[0], t[0]);
+//         f_sqr(t[0], t[0]);
 //     f_mul(t[0], t[3], t[0]);
 
 //     // Next 2 bits
 //     for (i = 0; i < 2; i++)
-//         f_mul(t[0], t[0], t[0]);
+//         f_sqr(t[0], t[0]);
 //     f_mul(t[0], t[2], t[0]);
 
 //     // Next 1 bit
-//     f_mul(t[0], t[0], t[0]);
+//     f_sqr(t[0], t[0]);
 //     f_mul(t[0], a, t[0]);
 
 //     // t[0] = a^d
@@ -662,18 +679,18 @@ void f_sqrt(const f_elm_t a, f_elm_t b){
 //     // t[1] = a^((d+1)/2)
 //     f_copy(a, t[1]);
 //     for(i = 0; i < 190; i++)
-//         f_mul(t[1], t[1], t[1]);
+//         f_sqr(t[1], t[1]);
 
 
 //     for(i = 318; i >= 0; i--){
 
 //         f_copy(psi, psi_old);
-//         f_mul(psi, psi, psi);
+//         f_sqr(psi, psi);
 
 
 //         f_copy(t[0], t[2]);
 //         for(j = 0; j < i; j++)
-//             f_mul(t[2], t[2], t[2]);
+//             f_sqr(t[2], t[2]);
 
 //         cond_select(psi_old, Mont_one, t[3], f_neq(t[2], Mont_one));
 //         cond_select(psi,     Mont_one, t[4], f_neq(t[2], Mont_one));
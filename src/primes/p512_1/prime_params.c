@@ -9,3 +9,4 @@ const digit_t pp[WORDS_FIELD]        = {0xFFFFFFFFFFFFFFFF, 0xFFFFFFFFFFFFFFFF,
 const digit_t ip[WORDS_FIELD]        = {0x0000000000000001, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000001, 0x0000000000000000, 0x8000000000000000};
 const digit_t Zero[WORDS_FIELD]      = {0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000};
 const digit_t One[WORDS_FIELD]       = {0x0000000000000001, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000};
+const digit_t mu[WORDS_FIELD + 1]    = {0xFFFFFFFFFFFFFFFC, 0xFFFFFFFFFFFFFFFF, 0x0000000000000007, 0x0000000000000000, 0x0000000000000000, 0x0000000000000004, 0x0000000000000000, 0x0000000000000000, 0x0000000000000002};
@@ -0,0 +1,338 @@
+#include "arith.h"
+#include "chains.h"
+
+extern void f_red_asm(f_elm_t a);
+extern void f_add_asm(const f_elm_t a, const f_elm_t b, f_elm_t c);
+extern void f_neg_asm(const f_elm_t a, f_elm_t b);
+extern void f_sub_asm(const f_elm_t a, const f_elm_t b, f_elm_t c);
+extern void mp_mul_asm(const digit_t* a, const digit_t* b, digit_t* c);
+extern void mont_redc_asm(const digit_t* a, digit_t* c);
+extern void f_mul_asm(const f_elm_t a, const f_elm_t b, f_elm_t c);
+extern void mp_sqr_asm(const digit_t* a, digit_t* c);
+extern void f_sqr_asm(const f_elm_t a, f_elm_t c);
+
+
+// Reduction modulo p
+// a in [0, R - 1] -> a in [0, p-1]
+inline void f_red(f_elm_t a) {
+    f_red_asm(a); }
+
+
+// Generate a random field element
+void f_rand(f_elm_t a)
+{
+    randombytes((unsigned char *)a, sizeof(digit_t) * WORDS_FIELD);
+    f_red(a); // Not uniformly random, can use rejection sampling to fix, thought it's pretty close to uniform
+}
+
+
+// Addition of two field elements
+inline void f_add(const f_elm_t a, const f_elm_t b, f_elm_t c) {
+    f_add_asm(a, b, c); }
+
+
+// Negation of a field element
+inline void f_neg(const f_elm_t a, f_elm_t b) {
+    f_neg_asm(a, b); }
+
+
+// Subtraction of two field elements
+inline void f_sub(const f_elm_t a, const f_elm_t b, f_elm_t c) {
+    f_sub_asm(a, b, c); }
+
+
+// Multiplication of two multiprecision words (without reduction)
+inline void mp_mul(const digit_t *a, const digit_t *b, digit_t *c) {
+    mp_mul_asm(a, b, c); }
+
+
+// Montgomery form reduction after multiplication
+// a < p * R -> c = a * R^-1 mod p in [0, p-1]
+inline void mont_redc(const digit_t *a, digit_t *c) {
+    mont_redc_asm(a, c); }
+
+
+// Multiplication of field elements
+inline void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c) {
+    f_mul_asm(a, b, c); }
+
+
+// Squaring of a multiprecision word (without reduction)
+inline void mp_sqr(const digit_t *a, digit_t *c) {
+    mp_sqr_asm(a, c); }
+
+
+// Squaring of a field element
+inline void f_sqr(const f_elm_t a, f_elm_t c) {
+    f_sqr_asm(a, c); }
+
+
+
+// Convert a number from value to Montgomery form  (a -> aR)
+void to_mont(const digit_t *a, f_elm_t b)
+{
+    f_mul(a, R2, b);
+}
+
+
+// Convert a number from Montgomery form into value (aR -> a)
+void from_mont(const f_elm_t a, digit_t *b)
+{
+    digit_t t0[2 * WORDS_FIELD] = {0};
+    f_copy(a, t0);
+    mont_redc(t0, b);
+}
+
+
+#ifdef FERMAT_INVERSION
+// Multiplicative inverse of a field element
+void f_inv(const f_elm_t a, f_elm_t b)
+{
+    f_pow_inv(a, b);
+}
+#endif
+
+
+
+
+#ifdef EULER_LEGENDRE
+// Legendre symbol of a field element
+void f_leg(const f_elm_t a, unsigned char *b)
+{
+    f_elm_t t0;
+
+    f_pow_leg(a, t0);                       // t0 = a^((p-1)/2) = 1, -1 or 0
+
+    *b = ((*(unsigned char *)t0) & 0x01);
+}
+#endif
+
+
+
+
+// a = a0 + a1*a;   a[0] = a0, a[1] = a1, a[2] = a1^2 * w
+// b = a^2 mod x^2 - w
+void fp_2_sqr(const f_elm_t a[3], f_elm_t b[3]){
+
+    f_elm_t t0, t1, t2;
+
+    f_sqr(a[0], t0);  // t0 = a0^2
+    f_mul(a[0], a[1], t1);  // t1 = a0 * a1
+    f_mul(t0, a[2], t2);    // t2 = a0^2 * a1^2 * w
+    
+
+    f_add(t0, a[2], b[0]);  // b[0] = a0^2 + a1^2 * w
+
+    f_add(t1, t1, b[1]);    // b[1] = 2 * a0 * a1
+
+    f_add(t2, t2, t2);
+    f_add(t2, t2, b[2]);    // b[2] = 4 * a0^2 * a1^2 * w
+
+}
+
+
+// a = a[0] + a[1] * x
+// b = b[0] + b[1] * x
+// Modulus = x^2 - w
+// c = a * b = (a0b0 + a1b1 w) + (a0b1 + a1b0) * x
+void fp_2_mul(const f_elm_t a[3], const f_elm_t b[3], f_elm_t c[3], const f_elm_t w){
+    
+    f_elm_t t0, t1, t2;
+
+    f_add(a[0], a[1], t0);
+    f_add(b[0], b[1], t1);
+
+    f_mul(t0, t1, t2);
+
+    f_mul(a[0], b[0], t0);
+    f_mul(a[1], b[1], t1);
+
+    f_sub(t2, t0, t2);
+    f_sub(t2, t1, c[1]);
+    
+    f_mul(t1, w, t1);
+
+    f_add(t0, t1, c[0]);
+
+    f_sqr(c[1], c[2]);
+    f_mul(c[2], w, c[2]);
+
+}
+
+
+
+// // a = a[0] + a[1] * x
+// // b = b[0] + b[1] * x
+// // Modulus = x^2 - w
+// // c = a * b = (a0b0 + a1b1 w) + (a0b1 + a1b0) * x
+// void fp_2_mul(const f_elm_t* a, const f_elm_t* b, f_elm_t* c, const f_elm_t w){
+    
+//     f_elm_t t0, t1, t2;
+
+//     f_add(a[0], a[1], t0);
+//     f_add(b[0], b[1], t1);
+
+//     f_mul(t0, t1, t2);
+
+//     f_mul(a[0], b[0], t0);
+//     f_mul(a[1], b[1], t1);
+
+//     f_sub(t2, t0, t2);
+//     f_sub(t2, t1, c[1]);
+    
+//     f_mul(t1, w, t1);
+
+//     f_add(t0, t1, c[0]);
+
+// }
+
+
+// NOT CONSTANT TIME
+// BUT INPUT INDEPENDENT
+// Pocklington algorithm
+// Choose a random r so that c = r^2 - a is a non-square
+// Given that r is random, algorithm doesn't depend on a, but the run time is still not constant
+void f_sqrt(const f_elm_t a, f_elm_t b){
+
+    f_elm_t t[2][3] = {0};
+    f_elm_t a_temp[2];
+    f_elm_t w;
+
+    unsigned char s[1];
+
+
+    // IF a = 0 the algorithm doesn't work. 
+    // In that case set a = 1, and return 0 only at the end.
+    cond_select(Mont_one, a, a_temp[0], f_eq(a, Zero));
+    f_copy(Zero, a_temp[1]);
+
+
+    do {// w = r^2 - a  AND non-square
+        f_rand(t[0][0]);                    // r
+        f_sqr(t[0][0], w);         // r^2
+        f_sub(w, a_temp[0], w);             // w = r^2 - a
+        f_leg(w, s);
+    } while (1 - *s);
+
+
+    // t[0] = r - x; where w = r^2 - a.
+    // t[0] = t0 + t1 * x
+    // t[0] is represented as a triple; 
+    // t[0] = (t0, t1, t1^2 * w)
+    f_neg(Mont_one, t[0][1]);
+    f_copy(w, t[0][2]);
+
+    // (r - x)^((p + 1)/2) = sqrt(a) + 0 * x
+    fp_2_pow_sqrt(t[0], t[1], w);
+
+    cond_select(a, t[1][0], b, f_eq(a, Zero));
+}
+
+
+// Constant time but slow
+// Can be sped up with more memory, but stays much slower than above algorithm
+// This is Tonelli-Shanks
+// void f_sqrt(const f_elm_t a, f_elm_t b){
+
+//     // psi = 2^320'th root of unity. psi^(2^320) = 1, psi^(2^319) = -1
+//     f_elm_t psi = {0x866F1CC18DC46260, 0xBC6920F07BAAE79F, 0x5AFFB5FF5381606B, 0xBD8EE7B3BE6830E1, 0xA728C86D8ADE7CA2, 0x35903E99C2D6B5D4, 0x4D6556226F7CBA34, 0x001B66972B030BDF};
+//     f_elm_t psi_old;
+
+//     f_elm_t t[7];
+//     int i, j;
+
+//     f_copy(a, t[0]);
+//     f_copy(a, t[1]);
+
+//     /* d = (p - 1)/(2^320) 0b   01111111111111111111111111111111
+//                                 11111111111111111111111111111111
+//                                 11111111111111111111111111111111
+//                                 11111111111111111111111111111111
+
+//                                 11111111111111111111111111111111
+//                                 11111111111111111111111111111111
+//     */
+
+//     /* (d + 1)/2 0b     01000000000000000000000000000000
+//                         00000000000000000000000000000000
+//                         00000000000000000000000000000000
+//                         00000000000000000000000000000000
+
+//                         00000000000000000000000000000000
+//                         00000000000000000000000000000000
+//     */
+
+
+
+//     // First 128 bits = 2^7 bits
+//     for(j = 0; j < 7; j++){
+//         for (i = 0; i < (1u << j); i++)
+//             f_sqr(t[0], t[0]);
+//         f_mul(t[0], t[1], t[0]);
+//         if(j == 0) f_copy(t[0], t[2]);  // a^(2^2  - 1) = a^0b 11
+//         if(j == 1) f_copy(t[0], t[3]);  // a^(2^4  - 1) = a^0b 1111
+//         if(j == 2) f_copy(t[0], t[4]);  // a^(2^8  - 1) = a^0b 11111111
+//         if(j == 3) f_copy(t[0], t[5]);  // a^(2^16 - 1) = a^0b 11111111 11111111
+//         if(j == 4) f_copy(t[0], t[6]);  // a^(2^32 - 1) = a^0b 11111111 11111111 11111111 11111111
+//         f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
+//     }
+
+//     // Next 32 bits
+//     for (i = 0; i < 32; i++)
+//         f_sqr(t[0], t[0]);
+//     f_mul(t[0], t[6], t[0]);
+
+//     // Next 16 bits
+//     for (i = 0; i < 16; i++)
+//         f_sqr(t[0], t[0]);
+//     f_mul(t[0], t[5], t[0]);
+
+//     // Next 8 bits
+//     for (i = 0; i < 8; i++)
+//         f_sqr(t[0], t[0]);
+//     f_mul(t[0], t[4], t[0]);
+
+//     // Next 4 bits
+//     for (i = 0; i < 4; i++)
+//         f_sqr(t[0], t[0]);
+//     f_mul(t[0], t[3], t[0]);
+
+//     // Next 2 bits
+//     for (i = 0; i < 2; i++)
+//         f_sqr(t[0], t[0]);
+//     f_mul(t[0], t[2], t[0]);
+
+//     // Next 1 bit
+//     f_sqr(t[0], t[0]);
+//     f_mul(t[0], a, t[0]);
+
+//     // t[0] = a^d
+
+//     // t[1] = a^((d+1)/2)
+//     f_copy(a, t[1]);
+//     for(i = 0; i < 190; i++)
+//         f_sqr(t[1], t[1]);
+
+
+//     for(i = 318; i >= 0; i--){
+
+//         f_copy(psi, psi_old);
+//         f_sqr(psi, psi);
+
+
+//         f_copy(t[0], t[2]);
+//         for(j = 0; j < i; j++)
+//             f_sqr(t[2], t[2]);
+
+//         cond_select(psi_old, Mont_one, t[3], f_neq(t[2], Mont_one));
+//         cond_select(psi,     Mont_one, t[4], f_neq(t[2], Mont_one));
+
+//         f_mul(t[1], t[3], t[1]);
+//         f_mul(t[0], t[4], t[0]);
+
+//     }
+
+//     f_copy(t[1], b);
+
+// }
+
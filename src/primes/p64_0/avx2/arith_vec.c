@@ -0,0 +1,271 @@
+#include "arith.h"
+#include "dispatch.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #include <immintrin.h>
+    #define VEC_AVX2
+#endif
+
+// Array kernels modulo p = 2^61 - 1, in whichever form the backend keeps its elements
+// Inputs are below 2p (any element, also with REDUNDANT_FORM), outputs are canonical.
+// Products are folded with 2^61 = 1 (mod p). In Montgomery form (R = 2^64 = 8) the folded product is
+// multiplied by R^(-1) = 2^58, which is a rotation of the 61-bit value by 3 bits.
+
+#define MASK61  0x1FFFFFFFFFFFFFFF
+
+
+// a < 2^64 -> a mod p in [0, p)
+static inline digit_t red61(digit_t a)
+{
+    a = (a & MASK61) + (a >> 61);
+    a = (a & MASK61) + (a >> 61);
+    return (a + ((a + 1) >> 61)) & MASK61;
+}
+
+
+// c = a*b mod p in the form of the elements, a, b < 2p
+static inline digit_t mul61(digit_t a, digit_t b)
+{
+    uint128_t t = (uint128_t)a * b;
+    digit_t r = red61(((digit_t)t & MASK61) + (digit_t)(t >> 61));
+#ifndef CANONICAL_FORM
+    r = (r >> 3) | ((r & 7) << 58);
+#endif
+    return r;
+}
+
+
+// Portable kernels, unrolled by four
+
+static void f_add_vec_generic(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        c[i][0]     = red61(a[i][0] + b[i][0]);
+        c[i + 1][0] = red61(a[i + 1][0] + b[i + 1][0]);
+        c[i + 2][0] = red61(a[i + 2][0] + b[i + 2][0]);
+        c[i + 3][0] = red61(a[i + 3][0] + b[i + 3][0]);
+    }
+    for (; i < n; i++)
+        c[i][0] = red61(a[i][0] + b[i][0]);
+}
+
+
+// a + 4p - b, 4p = 2^63 - 4 is above any input
+static void f_sub_vec_generic(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+    const digit_t p4 = p[0] << 2;
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        c[i][0]     = red61(a[i][0] + p4 - b[i][0]);
+        c[i + 1][0] = red61(a[i + 1][0] + p4 - b[i + 1][0]);
+        c[i + 2][0] = red61(a[i + 2][0] + p4 - b[i + 2][0]);
+        c[i + 3][0] = red61(a[i + 3][0] + p4 - b[i + 3][0]);
+    }
+    for (; i < n; i++)
+        c[i][0] = red61(a[i][0] + p4 - b[i][0]);
+}
+
+
+static void f_mul_vec_generic(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        c[i][0]     = mul61(a[i][0], b[i][0]);
+        c[i + 1][0] = mul61(a[i + 1][0], b[i + 1][0]);
+        c[i + 2][0] = mul61(a[i + 2][0], b[i + 2][0]);
+        c[i + 3][0] = mul61(a[i + 3][0], b[i + 3][0]);
+    }
+    for (; i < n; i++)
+        c[i][0] = mul61(a[i][0], b[i][0]);
+}
+
+
+static void f_axpy_vec_generic(const f_elm_t alpha, const f_elm_t *x, f_elm_t *y, const unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        y[i][0]     = red61(y[i][0] + mul61(alpha[0], x[i][0]));
+        y[i + 1][0] = red61(y[i + 1][0] + mul61(alpha[0], x[i + 1][0]));
+        y[i + 2][0] = red61(y[i + 2][0] + mul61(alpha[0], x[i + 2][0]));
+        y[i + 3][0] = red61(y[i + 3][0] + mul61(alpha[0], x[i + 3][0]));
+    }
+    for (; i < n; i++)
+        y[i][0] = red61(y[i][0] + mul61(alpha[0], x[i][0]));
+}
+
+
+#ifdef VEC_AVX2
+// Four lanes of red61
+__attribute__((target("avx2")))
+static inline __m256i red61_x4(__m256i a)
+{
+    const __m256i m61 = _mm256_set1_epi64x(MASK61), one = _mm256_set1_epi64x(1);
+
+    a = _mm256_add_epi64(_mm256_and_si256(a, m61), _mm256_srli_epi64(a, 61));
+    a = _mm256_add_epi64(_mm256_and_si256(a, m61), _mm256_srli_epi64(a, 61));
+    return _mm256_and_si256(_mm256_add_epi64(a, _mm256_srli_epi64(_mm256_add_epi64(a, one), 61)), m61);
+}
+
+
+// Four lanes of mul61, the 128-bit products are built from 32x32 -> 64 partial products
+// With a, b < 2^62 the product is below 2^124, so hi*8 + (lo >> 61) fits in a word
+__attribute__((target("avx2")))
+static inline __m256i mul61_x4(__m256i a, __m256i b)
+{
+    const __m256i m32 = _mm256_set1_epi64x(0xFFFFFFFF), m61 = _mm256_set1_epi64x(MASK61);
+    __m256i ah = _mm256_srli_epi64(a, 32), bh = _mm256_srli_epi64(b, 32);
+    __m256i ll = _mm256_mul_epu32(a, b), lh = _mm256_mul_epu32(a, bh), hl = _mm256_mul_epu32(ah, b), hh = _mm256_mul_epu32(ah, bh);
+    __m256i mid, lo, hi, r;
+
+    mid = _mm256_add_epi64(_mm256_srli_epi64(ll, 32), _mm256_add_epi64(_mm256_and_si256(lh, m32), _mm256_and_si256(hl, m32)));
+    lo = _mm256_or_si256(_mm256_and_si256(ll, m32), _mm256_slli_epi64(mid, 32));
+    hi = _mm256_add_epi64(_mm256_add_epi64(hh, _mm256_srli_epi64(mid, 32)), _mm256_add_epi64(_mm256_srli_epi64(lh, 32), _mm256_srli_epi64(hl, 32)));
+
+    r = _mm256_add_epi64(_mm256_and_si256(lo, m61), _mm256_or_si256(_mm256_slli_epi64(hi, 3), _mm256_srli_epi64(lo, 61)));
+    r = red61_x4(r);
+#ifndef CANONICAL_FORM
+    r = _mm256_or_si256(_mm256_srli_epi64(r, 3), _mm256_slli_epi64(_mm256_and_si256(r, _mm256_set1_epi64x(7)), 58));
+#endif
+    return r;
+}
+
+
+__attribute__((target("avx2")))
+static void f_add_vec_avx2(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i t = _mm256_add_epi64(_mm256_loadu_si256((const __m256i *)a[i]), _mm256_loadu_si256((const __m256i *)b[i]));
+        _mm256_storeu_si256((__m256i *)c[i], red61_x4(t));
+    }
+    for (; i < n; i++)
+        c[i][0] = red61(a[i][0] + b[i][0]);
+}
+
+
+__attribute__((target("avx2")))
+static void f_sub_vec_avx2(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+    const __m256i p4 = _mm256_set1_epi64x(p[0] << 2);
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i t = _mm256_add_epi64(_mm256_loadu_si256((const __m256i *)a[i]), p4);
+        t = _mm256_sub_epi64(t, _mm256_loadu_si256((const __m256i *)b[i]));
+        _mm256_storeu_si256((__m256i *)c[i], red61_x4(t));
+    }
+    for (; i < n; i++)
+        c[i][0] = red61(a[i][0] + (p[0] << 2) - b[i][0]);
+}
+
+
+__attribute__((target("avx2")))
+static void f_mul_vec_avx2(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_si256((__m256i *)c[i], mul61_x4(_mm256_loadu_si256((const __m256i *)a[i]), _mm256_loadu_si256((const __m256i *)b[i])));
+    for (; i < n; i++)
+        c[i][0] = mul61(a[i][0], b[i][0]);
+}
+
+
+__attribute__((target("avx2")))
+static void f_axpy_vec_avx2(const f_elm_t alpha, const f_elm_t *x, f_elm_t *y, const unsigned int n)
+{
+    const __m256i s = _mm256_set1_epi64x(alpha[0]);
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i t = mul61_x4(s, _mm256_loadu_si256((const __m256i *)x[i]));
+        t = _mm256_add_epi64(t, _mm256_loadu_si256((const __m256i *)y[i]));
+        _mm256_storeu_si256((__m256i *)y[i], red61_x4(t));
+    }
+    for (; i < n; i++)
+        y[i][0] = red61(y[i][0] + mul61(alpha[0], x[i][0]));
+}
+
+
+// AVX2 is checked once through CPUID (cpu_features), FF_DISPATCH can turn it off
+static int vec_use_avx2(void)
+{
+    return (cpu_features() & CPU_AVX2) != 0;
+}
+#endif
+
+
+// Addition of n pairs of field elements, c[i] = a[i] + b[i]
+void f_add_vec(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+#ifdef VEC_AVX2
+    if (vec_use_avx2())
+    {
+        f_add_vec_avx2(a, b, c, n);
+        return;
+    }
+#endif
+    f_add_vec_generic(a, b, c, n);
+}
+
+
+// Subtraction of n pairs of field elements, c[i] = a[i] - b[i]
+void f_sub_vec(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+#ifdef VEC_AVX2
+    if (vec_use_avx2())
+    {
+        f_sub_vec_avx2(a, b, c, n);
+        return;
+    }
+#endif
+    f_sub_vec_generic(a, b, c, n);
+}
+
+
+// Multiplication of n pairs of field elements, c[i] = a[i] * b[i]
+void f_mul_vec(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+#ifdef VEC_AVX2
+    if (vec_use_avx2())
+    {
+        f_mul_vec_avx2(a, b, c, n);
+        return;
+    }
+#endif
+    f_mul_vec_generic(a, b, c, n);
+}
+
+
+// Squaring of n field elements, c[i] = a[i]^2
+void f_sqr_vec(const f_elm_t *a, f_elm_t *c, const unsigned int n)
+{
+    f_mul_vec(a, a, c, n);
+}
+
+
+// Scaled accumulation, y[i] = y[i] + alpha * x[i]
+void f_axpy_vec(const f_elm_t alpha, const f_elm_t *x, f_elm_t *y, const unsigned int n)
+{
+#ifdef VEC_AVX2
+    if (vec_use_avx2())
+    {
+        f_axpy_vec_avx2(alpha, x, y, n);
+        return;
+    }
+#endif
+    f_axpy_vec_generic(alpha, x, y, n);
+}
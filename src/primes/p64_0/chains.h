@@ -0,0 +1,99 @@
+// Generated by tools/addchain.py, do not edit
+// Exponentiations by fixed powers of p = 0x1FFFFFFFFFFFFFFF
+
+#ifndef CHAINS_H
+#define CHAINS_H
+
+#ifdef FERMAT_INVERSION
+// b = a^(p - 2), 60 squarings and 9 multiplications
+static void f_pow_inv(const f_elm_t a, f_elm_t b)
+{
+    f_elm_t t[3];
+    unsigned int i;
+
+    f_sqr(a, t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^3
+    f_sqr(t[0], t[1]);
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^4 - 1)
+    f_sqr(t[1], t[0]);
+    for (i = 0; i < 3; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[1], t[0]);                // t[0] = a^(2^8 - 1)
+    f_sqr(t[0], t[1]);
+    for (i = 0; i < 7; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^16 - 1)
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], a, t[1]);                   // t[1] = a^(2^17 - 1)
+    f_sqr(t[1], t[2]);
+    for (i = 0; i < 16; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[1], t[2]);                // t[2] = a^(2^34 - 1)
+    for (i = 0; i < 17; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[1], t[2]);                // t[2] = a^(2^51 - 1)
+    for (i = 0; i < 8; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[0], t[2]);                // t[2] = a^(2^59 - 1)
+
+    // bit 0
+    f_sqr(t[2], t[2]);
+    f_sqr(t[2], t[2]);
+    f_mul(t[2], a, t[2]);
+
+    f_copy(t[2], b);
+}
+#endif
+
+#ifdef EULER_LEGENDRE
+// b = a^((p - 1)/2), 59 squarings and 7 multiplications
+static void f_pow_leg(const f_elm_t a, f_elm_t b)
+{
+    f_elm_t t[3];
+    unsigned int i;
+
+    f_sqr(a, t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^3
+    f_sqr(t[0], t[1]);
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^4 - 1)
+    f_sqr(t[1], t[0]);
+    for (i = 0; i < 3; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[1], t[0]);                // t[0] = a^(2^8 - 1)
+    f_sqr(t[0], t[2]);
+    for (i = 0; i < 7; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[0], t[2]);                // t[2] = a^(2^16 - 1)
+    for (i = 0; i < 4; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[1], t[2]);                // t[2] = a^(2^20 - 1)
+    f_sqr(t[2], t[0]);
+    for (i = 0; i < 19; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[2], t[0]);                // t[0] = a^(2^40 - 1)
+    for (i = 0; i < 20; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[2], t[0]);                // t[0] = a^(2^60 - 1)
+
+    f_copy(t[0], b);
+}
+#endif
+
+// b = a^((p + 1)/4), 59 squarings and 0 multiplications
+static void f_pow_sqrt(const f_elm_t a, f_elm_t b)
+{
+    f_elm_t t[1];
+    unsigned int i;
+
+
+    // bits 58 to 0, zeros
+    f_sqr(a, t[0]);
+    for (i = 0; i < 58; i++)
+        f_sqr(t[0], t[0]);
+
+    f_copy(t[0], b);
+}
+
+#endif
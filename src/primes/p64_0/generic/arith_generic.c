@@ -1,4 +1,5 @@
 #include "arith.h"
+#include "chains.h"
 
 
 // Reduction modulo p
@@ -49,6 +50,38 @@ void f_rand(f_elm_t a)
 }
 
 
+#ifdef REDUNDANT_FORM
+// Addition of two field elements, inputs and output in [0, 2p)
+// The sum is below 4p < 2^63, the bits from 2^61 up are folded back with 2^61 = 1 (mod p)
+void f_add(const f_elm_t a, const f_elm_t b, f_elm_t c)
+{
+    digit_t t0;
+
+    t0 = a[0] + b[0];
+    c[0] = (t0 & p[0]) + (t0 >> 61);
+}
+
+// Subtraction of two field elements, inputs and output in [0, 2p)
+// A borrow adds 2p
+void f_sub(const f_elm_t a, const f_elm_t b, f_elm_t c)
+{
+    digit_t mask, borrow = 0;
+
+    SUBC(borrow, a[0], b[0], c[0]);
+    mask = 0 - borrow;
+    c[0] += (p[0] << 1) & mask;
+}
+
+// Negation of a field element, input and output in [0, 2p)
+void f_neg(const f_elm_t a, f_elm_t b)
+{
+    digit_t mask, borrow = 0;
+
+    SUBC(borrow, 0, a[0], b[0]);
+    mask = 0 - borrow;
+    b[0] += (p[0] << 1) & mask;
+}
+#else
 // Addition of two field elements
 void f_add(const f_elm_t a, const f_elm_t b, f_elm_t c)
 {
@@ -79,7 +112,6 @@ void f_sub(const f_elm_t a, const f_elm_t b, f_elm_t c)
         SUBC(carry, c[i], Mont_one[i] & mask, c[i])
 
     f_red(c);
-    f_red(c);
 }
 
 // Negation of a field element
@@ -92,6 +124,7 @@ void f_neg(const f_elm_t a, f_elm_t b)
 
     f_red(b);
 }
+#endif
 
 // Multiplication of two multiprecision words (without reduction)
 void mp_mul(const digit_t *a, const digit_t *b, digit_t *c)
@@ -132,6 +165,40 @@ void mp_mul(const digit_t *a, const digit_t *b, digit_t *c)
     c[2 * WORDS_FIELD - 1] = v;
 }
 
+// Squaring of a multiprecision word (without reduction)
+void mp_sqr(const digit_t *a, digit_t *c)
+{ // Product scanning squaring, the cross products a[i]*a[j] (i < j) are computed once and doubled
+    digit_t t = 0, u = 0, v = 0;
+    uint128_t uv, UV;
+
+    for (int k = 0; k < 2 * WORDS_FIELD - 1; k++)
+    {
+        for (int i = (k < WORDS_FIELD ? 0 : k - WORDS_FIELD + 1); i < k - i; i++)
+        {
+            UV = (uint128_t)a[i] * a[k - i];
+            t += (digit_t)(UV >> (2 * RADIX - 1));
+            UV <<= 1;
+            uv = (((uint128_t)u << RADIX) | v) + UV;
+            t += (uv < UV);
+            u = (digit_t)(uv >> RADIX);
+            v = (digit_t)uv;
+        }
+        if ((k & 1) == 0)
+        {
+            UV = (uint128_t)a[k / 2] * a[k / 2];
+            uv = (((uint128_t)u << RADIX) | v) + UV;
+            t += (uv < UV);
+            u = (digit_t)(uv >> RADIX);
+            v = (digit_t)uv;
+        }
+        c[k] = v;
+        v = u;
+        u = t;
+        t = 0;
+    }
+    c[2 * WORDS_FIELD - 1] = v;
+}
+
 // 2.3 times slower than below !
 // void mont_redc(const digit_t *a, digit_t *c)
 // {
@@ -187,6 +254,38 @@ void mont_redc(const digit_t *a, digit_t *c)
 }
 
 
+#ifdef SPECIAL_FORM_REDUCTION
+// Reduction of a double-width product modulo p = 2^61 - 1
+// a < 2^122 -> c in [0, 2^61), 2^61 = 1 (mod p) so the high part is added to the low part
+// a < 2^124 (inputs in [0, 2p)) -> c in [0, 2^61 + 4)
+void mp_red(const digit_t *a, digit_t *c)
+{
+    digit_t t0;
+
+    t0 = (a[0] & p[0]) + ((a[1] << 3) | (a[0] >> 61));
+    c[0] = (t0 & p[0]) + (t0 >> 61);
+}
+
+
+// Multiplication of field elements, inputs and output in [0, 2^k)
+void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c)
+{
+    digit_t t0[2 * WORDS_FIELD];
+
+    mp_mul(a, b, t0);
+    mp_red(t0, c);
+}
+
+
+// Squaring of a field element, input and output in [0, 2^k)
+void f_sqr(const f_elm_t a, f_elm_t c)
+{
+    digit_t t0[2 * WORDS_FIELD];
+
+    mp_sqr(a, t0);
+    mp_red(t0, c);
+}
+#elif !defined(BARRETT_FORM)
 // Multiplication of field elements
 void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c)
 {
@@ -198,6 +297,33 @@ void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c)
 
 
 
+// Squaring of a field element
+void f_sqr(const f_elm_t a, f_elm_t c)
+{
+    digit_t t0[2 * WORDS_FIELD] = {0};
+
+    mp_sqr(a, t0);
+    mont_redc(t0, c);
+}
+#endif
+
+
+
+#ifdef CANONICAL_FORM
+// Elements are kept in canonical form, the conversions only apply the final correction
+void to_mont(const digit_t *a, f_elm_t b)
+{
+    f_copy(a, b);
+    f_red(b);
+}
+
+
+void from_mont(const f_elm_t a, digit_t *b)
+{
+    f_copy(a, b);
+    f_red(b);
+}
+#else
 // Convert a number from value to Montgomery form  (a -> aR)
 void to_mont(const digit_t *a, f_elm_t b)
 {
@@ -212,222 +338,43 @@ void from_mont(const f_elm_t a, digit_t *b)
     f_copy(a, t0);
     mont_redc(t0, b);
 }
+#endif
+
 
 
+#ifdef FERMAT_INVERSION
 // Multiplicative inverse of a field element
 void f_inv(const f_elm_t a, f_elm_t b)
 {
-
-    f_elm_t t[4];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
-
-    /* p - 2 =  0b  000 11111 11111111\
-                    11111111 11111111\
-
-                    11111111 11111111\
-
-                    111 11111111 11101\
-    */
-
-
-    // First 32 bits = 2^5 bits
-    for(j = 0; j < 5; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 2) f_copy(t[0], t[2]);  // a^(2^8  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[3]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-    
-    /* t[3] = a ^ 0b 11111111 11111111
-    */
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-    // Bit 4
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0],    a, t[0]);
-
-    // Bit 3
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0],    a, t[0]);
-    
-    // Bit 2
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0],    a, t[0]);
-    
-    // Bit 1
-    f_mul(t[0], t[0], t[0]);
-
-    // Bit 0
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0],    a, t[0]);
-
-    f_copy(t[0], b);
-
+    f_pow_inv(a, b);
 }
+#endif
 
 
+#ifdef EULER_LEGENDRE
 // Legendre symbol of a field element
 void f_leg(const f_elm_t a, unsigned char *b)
 {
-
-    f_elm_t t[5];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
-
-    /* (p - 1)/2 = 0b   00001111 11111111\
-                        11111111 11111111\
-
-                        11111111 11111111\
-
-                        1111 1111 1111 1111
-    */
-
-
-    // bit = 64 (=0)
-
-    // First 32 bits = 2^5 bits
-    for(j = 0; j < 5; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 1) f_copy(t[0], t[2]);  // a^(2^4  - 1) = a^0b 1111
-        if(j == 2) f_copy(t[0], t[3]);  // a^(2^8 - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[4]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-    
-    /* t[4] = a ^ 0b 11111111 11111111
-    */
-
-    // Next 16 bits
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
-
-    // Next 8 bits
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 4 bits
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-
-    *b = ((*(unsigned char *)t[0]) & 0x01);
-
+    f_elm_t t0;
+
+    f_pow_leg(a, t0);                       // t0 = a^((p-1)/2) = 1, -1 or 0
+
+#ifdef CANONICAL_FORM
+    f_add(t0, One, t0);                     // t0 = 0 iff a^((p-1)/2) = -1
+    *b = 1 - f_eq(t0, Zero);
+#else
+#ifdef REDUNDANT_FORM
+    f_red(t0);                              // The parity test needs the canonical representative
+#endif
+    *b = ((*(unsigned char *)t0) & 0x01);
+#endif
 }
+#endif
 
 
 
 // Legendre symbol of a field element
 void f_sqrt(const f_elm_t a, f_elm_t b)
 {
-
-    /* (p + 1)/4 = 0b   0000100000000000\
-                        0000000000000000\
-                        0000000000000000\
-                        0000000000000000
-        =2^59 = (2^61 - 1 + 1)/4
-    */
-
-    f_mul(a, a, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-    f_mul(b, b, b);
-
+    f_pow_sqrt(a, b);
 }
@@ -9,3 +9,4 @@ const digit_t pp[WORDS_FIELD]        = {0x2000000000000001}; // pp = -p^(-1) mod
 const digit_t ip[WORDS_FIELD]        = {0xDFFFFFFFFFFFFFFF}; // ip =  p^(-1) mod R    
 const digit_t Zero[WORDS_FIELD]      = {0x0000000000000000}; // Zero = 0
 const digit_t One[WORDS_FIELD]       = {0x0000000000000001}; // One = 1
+const digit_t mu[WORDS_FIELD + 1]    = {0x0000000000000040, 0x0000000000000008}; // mu = floor(2^128 / p)
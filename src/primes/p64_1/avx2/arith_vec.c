@@ -0,0 +1,324 @@
+#include "arith.h"
+#include "dispatch.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #include <immintrin.h>
+    #define VEC_AVX2
+#endif
+
+// Array kernels modulo p = 2^64 - 59, in whichever form the backend keeps its elements
+// Inputs and outputs are canonical. A carry out of the word is folded back with 2^64 = 59 (mod p).
+// In canonical form a product is folded twice (Crandall reduction). In Montgomery form q = t*pp mod 2^64
+// gives (t + q*p)/2^64 = t_hi + q - floor(59*q / 2^64), since the low words of t and q*p cancel.
+
+#define C59     59
+
+
+// c = a + b mod p
+static inline digit_t add59(digit_t a, digit_t b)
+{
+    digit_t c = a + b, d = c + C59;
+    digit_t mask = 0 - (digit_t)((c < a) | (d < c));    // a + b >= 2^64, or a + b >= p and c + 59 carries
+
+    return c ^ ((c ^ d) & mask);
+}
+
+
+// c = a - b mod p
+static inline digit_t sub59(digit_t a, digit_t b)
+{
+    digit_t c = a - b;
+
+    return c - (C59 & (0 - (digit_t)(a < b)));
+}
+
+
+// c = a*b mod p in the form of the elements
+static inline digit_t mul59(digit_t a, digit_t b)
+{
+    uint128_t t = (uint128_t)a * b;
+    digit_t lo = (digit_t)t, hi = (digit_t)(t >> 64);
+#ifdef CANONICAL_FORM
+    t = (uint128_t)hi * C59 + lo;
+    t = (uint128_t)(digit_t)(t >> 64) * C59 + (digit_t)t;    // below 2^64 + 59^2
+    return add59((digit_t)t, (digit_t)(t >> 64) * C59);
+#else
+    digit_t q = lo * pp[0];
+    digit_t h = (digit_t)(((uint128_t)q * C59) >> 64);
+    t = (uint128_t)hi + q - h - p[0];                       // in [-p, p), the high word is the mask
+    return (digit_t)t + (p[0] & (digit_t)(t >> 64));
+#endif
+}
+
+
+// Portable kernels, unrolled by four
+
+static void f_add_vec_generic(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        c[i][0]     = add59(a[i][0], b[i][0]);
+        c[i + 1][0] = add59(a[i + 1][0], b[i + 1][0]);
+        c[i + 2][0] = add59(a[i + 2][0], b[i + 2][0]);
+        c[i + 3][0] = add59(a[i + 3][0], b[i + 3][0]);
+    }
+    for (; i < n; i++)
+        c[i][0] = add59(a[i][0], b[i][0]);
+}
+
+
+static void f_sub_vec_generic(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        c[i][0]     = sub59(a[i][0], b[i][0]);
+        c[i + 1][0] = sub59(a[i + 1][0], b[i + 1][0]);
+        c[i + 2][0] = sub59(a[i + 2][0], b[i + 2][0]);
+        c[i + 3][0] = sub59(a[i + 3][0], b[i + 3][0]);
+    }
+    for (; i < n; i++)
+        c[i][0] = sub59(a[i][0], b[i][0]);
+}
+
+
+static void f_mul_vec_generic(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        c[i][0]     = mul59(a[i][0], b[i][0]);
+        c[i + 1][0] = mul59(a[i + 1][0], b[i + 1][0]);
+        c[i + 2][0] = mul59(a[i + 2][0], b[i + 2][0]);
+        c[i + 3][0] = mul59(a[i + 3][0], b[i + 3][0]);
+    }
+    for (; i < n; i++)
+        c[i][0] = mul59(a[i][0], b[i][0]);
+}
+
+
+static void f_axpy_vec_generic(const f_elm_t alpha, const f_elm_t *x, f_elm_t *y, const unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        y[i][0]     = add59(y[i][0], mul59(alpha[0], x[i][0]));
+        y[i + 1][0] = add59(y[i + 1][0], mul59(alpha[0], x[i + 1][0]));
+        y[i + 2][0] = add59(y[i + 2][0], mul59(alpha[0], x[i + 2][0]));
+        y[i + 3][0] = add59(y[i + 3][0], mul59(alpha[0], x[i + 3][0]));
+    }
+    for (; i < n; i++)
+        y[i][0] = add59(y[i][0], mul59(alpha[0], x[i][0]));
+}
+
+
+#ifdef VEC_AVX2
+// Unsigned a < b on four lanes, all ones where true
+__attribute__((target("avx2")))
+static inline __m256i ltu_x4(__m256i a, __m256i b)
+{
+    const __m256i sign = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+
+    return _mm256_cmpgt_epi64(_mm256_xor_si256(b, sign), _mm256_xor_si256(a, sign));
+}
+
+
+// Four lanes of add59
+__attribute__((target("avx2")))
+static inline __m256i add59_x4(__m256i a, __m256i b)
+{
+    __m256i c = _mm256_add_epi64(a, b), d = _mm256_add_epi64(c, _mm256_set1_epi64x(C59));
+
+    return _mm256_blendv_epi8(c, d, _mm256_or_si256(ltu_x4(c, a), ltu_x4(d, c)));
+}
+
+
+// Four lanes of sub59
+__attribute__((target("avx2")))
+static inline __m256i sub59_x4(__m256i a, __m256i b)
+{
+    __m256i c = _mm256_sub_epi64(a, b);
+
+    return _mm256_sub_epi64(c, _mm256_and_si256(ltu_x4(a, b), _mm256_set1_epi64x(C59)));
+}
+
+
+// Low and high words of four 64x64 products, built from 32x32 -> 64 partial products
+__attribute__((target("avx2")))
+static inline void mul64_x4(__m256i a, __m256i b, __m256i *lo, __m256i *hi)
+{
+    const __m256i m32 = _mm256_set1_epi64x(0xFFFFFFFF);
+    __m256i ah = _mm256_srli_epi64(a, 32), bh = _mm256_srli_epi64(b, 32);
+    __m256i ll = _mm256_mul_epu32(a, b), lh = _mm256_mul_epu32(a, bh), hl = _mm256_mul_epu32(ah, b), hh = _mm256_mul_epu32(ah, bh);
+    __m256i mid;
+
+    mid = _mm256_add_epi64(_mm256_srli_epi64(ll, 32), _mm256_add_epi64(_mm256_and_si256(lh, m32), _mm256_and_si256(hl, m32)));
+    *lo = _mm256_or_si256(_mm256_and_si256(ll, m32), _mm256_slli_epi64(mid, 32));
+    *hi = _mm256_add_epi64(_mm256_add_epi64(hh, _mm256_srli_epi64(mid, 32)), _mm256_add_epi64(_mm256_srli_epi64(lh, 32), _mm256_srli_epi64(hl, 32)));
+}
+
+
+// Four lanes of mul59
+__attribute__((target("avx2")))
+static inline __m256i mul59_x4(__m256i a, __m256i b)
+{
+    const __m256i c59 = _mm256_set1_epi64x(C59);
+    __m256i lo, hi, x0, x1;
+
+    mul64_x4(a, b, &lo, &hi);
+#ifdef CANONICAL_FORM
+    const __m256i m32 = _mm256_set1_epi64x(0xFFFFFFFF);
+
+    // lo + 59*hi in 32-bit pieces, the carry word x1 >> 32 is below 2^7 and is folded once more
+    x0 = _mm256_add_epi64(_mm256_and_si256(lo, m32), _mm256_mul_epu32(hi, c59));
+    x1 = _mm256_add_epi64(_mm256_add_epi64(_mm256_srli_epi64(lo, 32), _mm256_mul_epu32(_mm256_srli_epi64(hi, 32), c59)), _mm256_srli_epi64(x0, 32));
+    lo = _mm256_or_si256(_mm256_and_si256(x0, m32), _mm256_slli_epi64(x1, 32));
+    hi = _mm256_mul_epu32(_mm256_srli_epi64(x1, 32), c59);
+    return add59_x4(lo, hi);
+#else
+    // q = lo*pp mod 2^64 and h = floor(59*q / 2^64)
+    const __m256i pp0 = _mm256_set1_epi64x(pp[0] & 0xFFFFFFFF), pp1 = _mm256_set1_epi64x(pp[0] >> 32);
+    __m256i q, h, s, u, carry;
+
+    q = _mm256_add_epi64(_mm256_mul_epu32(lo, pp1), _mm256_mul_epu32(_mm256_srli_epi64(lo, 32), pp0));
+    q = _mm256_add_epi64(_mm256_mul_epu32(lo, pp0), _mm256_slli_epi64(q, 32));
+    x0 = _mm256_mul_epu32(q, c59);
+    x1 = _mm256_mul_epu32(_mm256_srli_epi64(q, 32), c59);
+    h = _mm256_srli_epi64(_mm256_add_epi64(x1, _mm256_srli_epi64(x0, 32)), 32);
+
+    // u = hi + q - h below 2p, subtract p (add 59) if it reached 2^64 or p
+    s = _mm256_add_epi64(hi, q);
+    u = _mm256_sub_epi64(s, h);
+    carry = _mm256_xor_si256(ltu_x4(s, q), ltu_x4(s, h));
+    s = _mm256_add_epi64(u, c59);
+    return _mm256_blendv_epi8(u, s, _mm256_or_si256(carry, ltu_x4(s, u)));
+#endif
+}
+
+
+__attribute__((target("avx2")))
+static void f_add_vec_avx2(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_si256((__m256i *)c[i], add59_x4(_mm256_loadu_si256((const __m256i *)a[i]), _mm256_loadu_si256((const __m256i *)b[i])));
+    for (; i < n; i++)
+        c[i][0] = add59(a[i][0], b[i][0]);
+}
+
+
+__attribute__((target("avx2")))
+static void f_sub_vec_avx2(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_si256((__m256i *)c[i], sub59_x4(_mm256_loadu_si256((const __m256i *)a[i]), _mm256_loadu_si256((const __m256i *)b[i])));
+    for (; i < n; i++)
+        c[i][0] = sub59(a[i][0], b[i][0]);
+}
+
+
+__attribute__((target("avx2")))
+static void f_mul_vec_avx2(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_si256((__m256i *)c[i], mul59_x4(_mm256_loadu_si256((const __m256i *)a[i]), _mm256_loadu_si256((const __m256i *)b[i])));
+    for (; i < n; i++)
+        c[i][0] = mul59(a[i][0], b[i][0]);
+}
+
+
+__attribute__((target("avx2")))
+static void f_axpy_vec_avx2(const f_elm_t alpha, const f_elm_t *x, f_elm_t *y, const unsigned int n)
+{
+    const __m256i s = _mm256_set1_epi64x(alpha[0]);
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i t = mul59_x4(s, _mm256_loadu_si256((const __m256i *)x[i]));
+        _mm256_storeu_si256((__m256i *)y[i], add59_x4(_mm256_loadu_si256((const __m256i *)y[i]), t));
+    }
+    for (; i < n; i++)
+        y[i][0] = add59(y[i][0], mul59(alpha[0], x[i][0]));
+}
+
+
+// AVX2 is checked once through CPUID (cpu_features), FF_DISPATCH can turn it off
+static int vec_use_avx2(void)
+{
+    return (cpu_features() & CPU_AVX2) != 0;
+}
+#endif
+
+
+// Addition of n pairs of field elements, c[i] = a[i] + b[i]
+void f_add_vec(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+#ifdef VEC_AVX2
+    if (vec_use_avx2())
+    {
+        f_add_vec_avx2(a, b, c, n);
+        return;
+    }
+#endif
+    f_add_vec_generic(a, b, c, n);
+}
+
+
+// Subtraction of n pairs of field elements, c[i] = a[i] - b[i]
+void f_sub_vec(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+#ifdef VEC_AVX2
+    if (vec_use_avx2())
+    {
+        f_sub_vec_avx2(a, b, c, n);
+        return;
+    }
+#endif
+    f_sub_vec_generic(a, b, c, n);
+}
+
+
+// Multiplication of n pairs of field elements, c[i] = a[i] * b[i]
+void f_mul_vec(const f_elm_t *a, const f_elm_t *b, f_elm_t *c, const unsigned int n)
+{
+#ifdef VEC_AVX2
+    if (vec_use_avx2())
+    {
+        f_mul_vec_avx2(a, b, c, n);
+        return;
+    }
+#endif
+    f_mul_vec_generic(a, b, c, n);
+}
+
+
+// Squaring of n field elements, c[i] = a[i]^2
+void f_sqr_vec(const f_elm_t *a, f_elm_t *c, const unsigned int n)
+{
+    f_mul_vec(a, a, c, n);
+}
+
+
+// Scaled accumulation, y[i] = y[i] + alpha * x[i]
+void f_axpy_vec(const f_elm_t alpha, const f_elm_t *x, f_elm_t *y, const unsigned int n)
+{
+#ifdef VEC_AVX2
+    if (vec_use_avx2())
+    {
+        f_axpy_vec_avx2(alpha, x, y, n);
+        return;
+    }
+#endif
+    f_axpy_vec_generic(alpha, x, y, n);
+}
@@ -0,0 +1,130 @@
+// Generated by tools/addchain.py, do not edit
+// Exponentiations by fixed powers of p = 0xFFFFFFFFFFFFFFC5
+
+#ifndef CHAINS_H
+#define CHAINS_H
+
+#ifdef FERMAT_INVERSION
+// b = a^(p - 2), 63 squarings and 9 multiplications
+static void f_pow_inv(const f_elm_t a, f_elm_t b)
+{
+    f_elm_t t[3];
+    unsigned int i;
+
+    f_sqr(a, t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^3
+    f_sqr(t[0], t[1]);
+    f_mul(t[1], a, t[1]);                   // t[1] = a^7
+    f_sqr(t[1], t[2]);
+    f_sqr(t[2], t[2]);
+    f_sqr(t[2], t[2]);
+    f_mul(t[2], t[1], t[2]);                // t[2] = a^(2^6 - 1)
+    f_sqr(t[2], t[2]);
+    f_mul(t[2], a, t[2]);                   // t[2] = a^(2^7 - 1)
+    f_sqr(t[2], t[1]);
+    for (i = 0; i < 6; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[2], t[1]);                // t[1] = a^(2^14 - 1)
+    f_sqr(t[1], t[2]);
+    for (i = 0; i < 13; i++)
+        f_sqr(t[2], t[2]);
+    f_mul(t[2], t[1], t[2]);                // t[2] = a^(2^28 - 1)
+    f_sqr(t[2], t[2]);
+    f_mul(t[2], a, t[2]);                   // t[2] = a^(2^29 - 1)
+    f_sqr(t[2], t[1]);
+    for (i = 0; i < 28; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[2], t[1]);                // t[1] = a^(2^58 - 1)
+
+    // bits 1 to 0, 2 ones
+    for (i = 0; i < 6; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);
+
+    f_copy(t[1], b);
+}
+#endif
+
+#ifdef EULER_LEGENDRE
+// b = a^((p - 1)/2), 62 squarings and 9 multiplications
+static void f_pow_leg(const f_elm_t a, f_elm_t b)
+{
+    f_elm_t t[2];
+    unsigned int i;
+
+    f_sqr(a, t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^3
+    f_sqr(t[0], t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^7
+    f_sqr(t[0], t[1]);
+    f_sqr(t[1], t[1]);
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^6 - 1)
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], a, t[1]);                   // t[1] = a^(2^7 - 1)
+    f_sqr(t[1], t[0]);
+    for (i = 0; i < 6; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[1], t[0]);                // t[0] = a^(2^14 - 1)
+    f_sqr(t[0], t[1]);
+    for (i = 0; i < 13; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^28 - 1)
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], a, t[1]);                   // t[1] = a^(2^29 - 1)
+    f_sqr(t[1], t[0]);
+    for (i = 0; i < 28; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[1], t[0]);                // t[0] = a^(2^58 - 1)
+
+    // bit 1
+    for (i = 0; i < 4; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], a, t[0]);
+
+    // bits 0 to 0, zeros
+    f_sqr(t[0], t[0]);
+
+    f_copy(t[0], b);
+}
+#endif
+
+// b = a^((p - 5)/8), 60 squarings and 8 multiplications
+static void f_pow_sqrt(const f_elm_t a, f_elm_t b)
+{
+    f_elm_t t[2];
+    unsigned int i;
+
+    f_sqr(a, t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^3
+    f_sqr(t[0], t[0]);
+    f_mul(t[0], a, t[0]);                   // t[0] = a^7
+    f_sqr(t[0], t[1]);
+    f_sqr(t[1], t[1]);
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^6 - 1)
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], a, t[1]);                   // t[1] = a^(2^7 - 1)
+    f_sqr(t[1], t[0]);
+    for (i = 0; i < 6; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[1], t[0]);                // t[0] = a^(2^14 - 1)
+    f_sqr(t[0], t[1]);
+    for (i = 0; i < 13; i++)
+        f_sqr(t[1], t[1]);
+    f_mul(t[1], t[0], t[1]);                // t[1] = a^(2^28 - 1)
+    f_sqr(t[1], t[1]);
+    f_mul(t[1], a, t[1]);                   // t[1] = a^(2^29 - 1)
+    f_sqr(t[1], t[0]);
+    for (i = 0; i < 28; i++)
+        f_sqr(t[0], t[0]);
+    f_mul(t[0], t[1], t[0]);                // t[0] = a^(2^58 - 1)
+
+    // bits 2 to 0, zeros
+    for (i = 0; i < 3; i++)
+        f_sqr(t[0], t[0]);
+
+    f_copy(t[0], b);
+}
+
+#endif
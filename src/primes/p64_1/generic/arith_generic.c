@@ -1,4 +1,5 @@
 #include "arith.h"
+#include "chains.h"
 
 
 // Reduction modulo p
@@ -109,6 +110,40 @@ void mp_mul(const digit_t *a, const digit_t *b, digit_t *c)
     c[2 * WORDS_FIELD - 1] = v;
 }
 
+// Squaring of a multiprecision word (without reduction)
+void mp_sqr(const digit_t *a, digit_t *c)
+{ // Product scanning squaring, the cross products a[i]*a[j] (i < j) are computed once and doubled
+    digit_t t = 0, u = 0, v = 0;
+    uint128_t uv, UV;
+
+    for (int k = 0; k < 2 * WORDS_FIELD - 1; k++)
+    {
+        for (int i = (k < WORDS_FIELD ? 0 : k - WORDS_FIELD + 1); i < k - i; i++)
+        {
+            UV = (uint128_t)a[i] * a[k - i];
+            t += (digit_t)(UV >> (2 * RADIX - 1));
+            UV <<= 1;
+            uv = (((uint128_t)u << RADIX) | v) + UV;
+            t += (uv < UV);
+            u = (digit_t)(uv >> RADIX);
+            v = (digit_t)uv;
+        }
+        if ((k & 1) == 0)
+        {
+            UV = (uint128_t)a[k / 2] * a[k / 2];
+            uv = (((uint128_t)u << RADIX) | v) + UV;
+            t += (uv < UV);
+            u = (digit_t)(uv >> RADIX);
+            v = (digit_t)uv;
+        }
+        c[k] = v;
+        v = u;
+        u = t;
+        t = 0;
+    }
+    c[2 * WORDS_FIELD - 1] = v;
+}
+
 // Montgomery form reduction after multiplication
 void mont_redc(const digit_t *a, digit_t *c)
 {
@@ -135,6 +170,51 @@ void mont_redc(const digit_t *a, digit_t *c)
 }
 
 
+#ifdef SPECIAL_FORM_REDUCTION
+// Reduction of a double-width product modulo p = 2^k - c (canonical form)
+// Folds the high half with 2^(64*WORDS_FIELD) = Mont_one[0] (mod p), Mont_one[0] is a single word
+void mp_red(const digit_t *a, digit_t *c)
+{
+    digit_t carry;
+    uint128_t uv = 0;
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+    {
+        uv = (uint128_t)a[WORDS_FIELD + i] * Mont_one[0] + a[i] + (digit_t)(uv >> RADIX);
+        c[i] = (digit_t)uv;
+    }
+
+    // Fold the top word, if this carries out the low words are left below Mont_one[0]^2
+    uv = (uint128_t)(digit_t)(uv >> RADIX) * Mont_one[0] + c[0];
+    c[0] = (digit_t)uv;
+    carry = (digit_t)(uv >> RADIX);
+    for (int i = 1; i < WORDS_FIELD; i++)
+        ADDC(carry, c[i], 0, c[i]);
+    c[0] += Mont_one[0] & (0 - carry);
+
+    f_red(c);
+}
+
+
+// Multiplication of field elements
+void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c)
+{
+    digit_t t0[2 * WORDS_FIELD];
+
+    mp_mul(a, b, t0);
+    mp_red(t0, c);
+}
+
+
+// Squaring of a field element
+void f_sqr(const f_elm_t a, f_elm_t c)
+{
+    digit_t t0[2 * WORDS_FIELD];
+
+    mp_sqr(a, t0);
+    mp_red(t0, c);
+}
+#elif !defined(BARRETT_FORM)
 // Multiplication of field elements
 void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c)
 {
@@ -146,6 +226,31 @@ void f_mul(const f_elm_t a, const f_elm_t b, f_elm_t c)
 
 
 
+// Squaring of a field element
+void f_sqr(const f_elm_t a, f_elm_t c)
+{
+    digit_t t0[2 * WORDS_FIELD] = {0};
+
+    mp_sqr(a, t0);
+    mont_redc(t0, c);
+}
+#endif
+
+
+
+#ifdef CANONICAL_FORM
+// Elements are kept in canonical form, the conversions are copies
+void to_mont(const digit_t *a, f_elm_t b)
+{
+    f_copy(a, b);
+}
+
+
+void from_mont(const f_elm_t a, digit_t *b)
+{
+    f_copy(a, b);
+}
+#else
 // Convert a number from value to Montgomery form  (a -> aR)
 void to_mont(const digit_t *a, f_elm_t b)
 {
@@ -160,135 +265,35 @@ void from_mont(const f_elm_t a, digit_t *b)
     f_copy(a, t0);
     mont_redc(t0, b);
 }
+#endif
+
 
 
+#ifdef FERMAT_INVERSION
 // Multiplicative inverse of a field element
 void f_inv(const f_elm_t a, f_elm_t b)
 {
-
-    f_elm_t t[5];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
-
-    /* p - 2 =  0b  11111111 11111111\
-                    11111111 11111111\
-
-                    11111111 11111111\
-
-                    11111111 11 0000 11\
-    */
-
-
-    // First 32 bits = 2^5 bits
-    for(j = 0; j < 5; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 0) f_copy(t[0], t[2]);  // a^(2^2  - 1) = a^0b 11
-        if(j == 2) f_copy(t[0], t[3]);  // a^(2^8  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[4]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-    
-    /* t[3] = a ^ 0b 11111111 11111111
-    */
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[4], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // bit = 7, 6
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-    // Next 4 bits
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    // bit = 1, 0
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-    f_copy(t[0], b);
-
+    f_pow_inv(a, b);
 }
+#endif
 
 
+#ifdef EULER_LEGENDRE
 // Legendre symbol of a field element
 void f_leg(const f_elm_t a, unsigned char *b)
 {
+    f_elm_t t0;
 
-    f_elm_t t[4];
-    unsigned int i, j;
-
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
-
-    /* (p - 1)/2 = 0b   0 1111111 11111111\
-                        11111111 11111111\
-
-                        11111111 11111111\
-
-                        11111111 1 1100010
-    */
-
-
-    // bit = 64 (=0)
-
-    // First 32 bits = 2^5 bits
-    for(j = 0; j < 5; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 2) f_copy(t[0], t[2]);  // a^(2^8  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[3]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-    
-    /* t[3] = a ^ 0b 11111111 11111111
-    */
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-    // bit = 6
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-    // bit = 5
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-    // bit = 4
-    f_mul(t[0], t[0], t[0]);
-    // bit = 3
-    f_mul(t[0], t[0], t[0]);
-    // bit = 2
-    f_mul(t[0], t[0], t[0]);
-    // bit = 1
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-    // bit = 0
-    f_mul(t[0], t[0], t[0]);
-
-    *b = ((*(unsigned char *)t[0]) & 0x80) >> 7;
+    f_pow_leg(a, t0);                       // t0 = a^((p-1)/2) = 1, -1 or 0
 
+#ifdef CANONICAL_FORM
+    f_add(t0, One, t0);                     // t0 = 0 iff a^((p-1)/2) = -1
+    *b = 1 - f_eq(t0, Zero);
+#else
+    *b = ((*(unsigned char *)t0) & 0x80) >> 7;
+#endif
 }
+#endif
 
 
 
@@ -297,79 +302,25 @@ void f_leg(const f_elm_t a, unsigned char *b)
 void f_sqrt(const f_elm_t a, f_elm_t b)
 {
 
-    f_elm_t t[4];
+    f_elm_t t[3];
+#ifdef CANONICAL_FORM
+    f_elm_t psi = {0x1FDD1BB873DC8195}; // psi = sqrt(-1)
+#else
     f_elm_t psi = {0x57F56382B3D1DEF4}; // psi = 4'th root of 1 = i, psi^2 = -1, psi^4 = 1 (1 being Mont_one)
+#endif
 
-    unsigned int i, j;
     digit_t mask = 0;
 
-    f_copy(a, t[0]);
-    f_copy(a, t[1]);
-
-
-    /* d = (p - 1)/4 0b 00 111111 11111111\
-                        11111111 11111111\
-
-                        11111111 11111111\
-
-                        11111111 11 110001
-    */
-
-    /* (d+1)/2 = 0b     000 11111 11111111\
-                        11111111 11111111\
-
-                        11111111 11111111\
-
-                        11111111 111 11001
-    */
-
-    // First 32 bits = 2^5 bits
-    for(j = 0; j < 5; j++){
-        for (i = 0; i < (1u << j); i++)
-            f_mul(t[0], t[0], t[0]);
-        f_mul(t[0], t[1], t[0]);
-        if(j == 2) f_copy(t[0], t[2]);  // a^(2^8  - 1) = a^0b 11111111
-        if(j == 3) f_copy(t[0], t[3]);  // a^(2^16 - 1) = a^0b 11111111 11111111
-        f_copy(t[0], t[1]);             // a^(2^(2^(j+1)) - 1)
-    }
-    
-    /* t[3] = a ^ 0b 11111111 11111111
-    */
-
-    // Next 16 bits
-    for (i = 0; i < 16; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[3], t[0]);
-
-    // Next 8 bits
-    for (i = 0; i < 8; i++)
-        f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[2], t[0]);
-
-
-    // Next 2 bits
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], a, t[0]);
-
-    // Next 3 bits
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-    f_mul(t[0], t[0], t[0]);
-
-
-    f_mul(t[0], t[0], t[1]);
-    f_mul(t[1], a, t[1]);       // t[1] = a^(d)
-
-
-    f_mul(t[0], a, t[0]);       // t[0] = a^((d+1)/2)
+    f_pow_sqrt(a, t[0]);                    // t[0] = a^((p-5)/8)
+    f_sqr(t[0], t[1]);
+    f_mul(t[1], a, t[1]);                   // t[1] = a^((p-1)/4) = 1 or -1 for a square
+    f_mul(t[0], a, t[0]);                   // t[0] = a^((p+3)/8)
 
     // t[0] has to be multiplied with 1 if t[1] is 1, and with psi if t[1] is -1
-    mask = 0 - (((digit_t) f_eq(t[1], Mont_one)) & 0x01);
+    mask = 0 - (((digit_t) f_eq(t[1], F_ONE)) & 0x01);
     
-    psi[0] = (psi[0] ^ Mont_one[0]) & mask;
-    psi[0] ^= Mont_one[0];
+    psi[0] = (psi[0] ^ F_ONE[0]) & mask;
+    psi[0] ^= F_ONE[0];
 
     f_mul(t[0], psi, t[0]);
 
@@ -9,3 +9,4 @@ const digit_t pp[WORDS_FIELD]        = {0xCBEEA4E1A08AD8F3};
 const digit_t ip[WORDS_FIELD]        = {0x34115B1E5F75270D};
 const digit_t Zero[WORDS_FIELD]      = {0x0000000000000000};
 const digit_t One[WORDS_FIELD]       = {0x0000000000000001};
+const digit_t mu[WORDS_FIELD + 1]    = {0x000000000000003B, 0x0000000000000001};
@@ -0,0 +1,320 @@
+#include "arith.h"
+
+// Constant-time inversion with the safegcd algorithm of Bernstein and Yang, after the modinv64 code of libsecp256k1
+// f = p and g = a are kept as signed integers in radix 2^62. A batch runs 62 divsteps on the low limbs of f and g only
+// and collects them in a 2x2 transition matrix (scaled by 2^62), which is then applied to the full f and g, and to d
+// and e. These keep f = d*a and g = e*a (mod p), adding the multiple of p that makes their update divisible by 2^62.
+// After SAFEGCD_DIVSTEPS steps g = 0 and f = +-1, so the inverse is +-d. The step count is the bound floor((49n + 57) / 17)
+// of the paper for n-bit inputs, every branch is replaced by a mask, so the running time does not depend on a.
+// In Montgomery form a holds xR and d = (xR)^(-1), two multiplications by R2 turn it into x^(-1)R.
+// f_inv_vartime, for public inputs, skips runs of zeros of g with a count of trailing zeros, cancels several bits of g
+// per step and stops as soon as g = 0, after the modinv64_var code of libsecp256k1. It is built with FERMAT_INVERSION too.
+
+#define LIMBS62             ((NBITS_FIELD + 63) / 62)       // Room for the sign and for d, e in (-2p, p)
+#define MASK62              (((digit_t)1 << 62) - 1)
+#define SAFEGCD_DIVSTEPS    ((49 * NBITS_FIELD + 57) / 17)
+#define SAFEGCD_BATCHES     ((SAFEGCD_DIVSTEPS + 61) / 62)
+
+// Limbs 0 .. LIMBS62 - 2 in [0, 2^62), the top limb carries the sign
+typedef int64_t s62_t[LIMBS62];
+
+// Transition matrix of 62 divsteps, [f', g'] = [u v; q r] [f, g] / 2^62
+typedef struct {
+    int64_t u, v, q, r;
+} trans62_t;
+
+
+static void s62_from_words(const digit_t *a, int64_t *b)
+{
+    int w, s;
+    digit_t x;
+
+    for (int i = 0; i < LIMBS62; i++)
+    {
+        w = (62 * i) / RADIX;
+        s = (62 * i) % RADIX;
+        x = (w < WORDS_FIELD) ? a[w] >> s : 0;
+        if (s > 2 && w + 1 < WORDS_FIELD)
+            x |= a[w + 1] << (RADIX - s);
+        b[i] = (int64_t)(x & MASK62);
+    }
+}
+
+
+// a in [0, 2^(64*WORDS_FIELD)), all limbs non-negative
+static void s62_to_words(const int64_t *a, digit_t *b)
+{
+    int i, s;
+
+    for (int w = 0; w < WORDS_FIELD; w++)
+    {
+        i = (RADIX * w) / 62;
+        s = (RADIX * w) % 62;
+        b[w] = ((digit_t)a[i] >> s) | ((i + 1 < LIMBS62) ? (digit_t)a[i + 1] << (62 - s) : 0);
+    }
+}
+
+
+// a = a + p if mask = -1
+static void s62_cadd_p(int64_t *a, const int64_t *p62, const int64_t mask)
+{
+    int64_t c = 0;
+
+    for (int i = 0; i < LIMBS62 - 1; i++)
+    {
+        c += a[i] + (p62[i] & mask);
+        a[i] = c & MASK62;
+        c >>= 62;
+    }
+    a[LIMBS62 - 1] += c + (p62[LIMBS62 - 1] & mask);
+}
+
+
+// a = -a if mask = -1
+static void s62_cneg(int64_t *a, const int64_t mask)
+{
+    int64_t c = 0;
+
+    for (int i = 0; i < LIMBS62 - 1; i++)
+    {
+        c += (a[i] ^ mask) - mask;
+        a[i] = c & MASK62;
+        c >>= 62;
+    }
+    a[LIMBS62 - 1] = ((a[LIMBS62 - 1] ^ mask) - mask) + c;
+}
+
+
+// 62 divsteps on the low 64 bits of f and g, returns the new delta
+// divstep: if delta > 0 and g is odd (delta, f, g) -> (1 - delta, g, (g - f)/2), else (1 + delta, f, (g + (g mod 2) f)/2)
+static int64_t divsteps_62(int64_t delta, digit_t f, digit_t g, trans62_t *t)
+{
+    digit_t u = 1, v = 0, q = 0, r = 1, c1, c2, c, x, y, z;
+
+    for (int i = 0; i < 62; i++)
+    {
+        c1 = (digit_t)((0 - delta) >> 63);      // delta > 0
+        c2 = 0 - (g & 1);                       // g odd
+        c = c1 & c2;                            // swap
+        x = (f ^ c) - c;
+        y = (u ^ c) - c;
+        z = (v ^ c) - c;
+        g += x & c2;                            // g = g + f, or g - f when swapping
+        q += y & c2;
+        r += z & c2;
+        f += g & c;                             // f = g when swapping
+        u += q & c;
+        v += r & c;
+        delta = (int64_t)(((digit_t)delta ^ c) - c) + 1;
+        g >>= 1;
+        u <<= 1;
+        v <<= 1;
+    }
+
+    t->u = (int64_t)u;
+    t->v = (int64_t)v;
+    t->q = (int64_t)q;
+    t->r = (int64_t)r;
+    return delta;
+}
+
+
+// Variable-time version of divsteps_62 with eta = -delta, delta starting at 1/2
+// A swap is done at most once per run of zeros of g, then the low bits of g are cleared with g = g + w*f, up to 6 bits
+// when f was just swapped in and up to 4 otherwise (w = -g/f modulo a power of 2)
+static int64_t divsteps_62_var(int64_t eta, digit_t f, digit_t g, trans62_t *t)
+{
+    digit_t u = 1, v = 0, q = 0, r = 1, m, w, x;
+    int i = 62, limit, zeros;
+
+    for (;;)
+    {
+        zeros = __builtin_ctzll(g | ((digit_t)-1 << i));
+        g >>= zeros;
+        u <<= zeros;
+        v <<= zeros;
+        eta -= zeros;
+        i -= zeros;
+        if (i == 0)
+            break;
+
+        // f and g are odd
+        if (eta < 0)
+        {
+            eta = -eta;
+            x = f; f = g; g = 0 - x;
+            x = u; u = q; q = 0 - x;
+            x = v; v = r; r = 0 - x;
+            limit = ((int)eta + 1) > i ? i : ((int)eta + 1);
+            m = ((digit_t)-1 >> (RADIX - limit)) & 63;
+            w = (f * g * (f * f - 2)) & m;
+        }
+        else
+        {
+            limit = ((int)eta + 1) > i ? i : ((int)eta + 1);
+            m = ((digit_t)-1 >> (RADIX - limit)) & 15;
+            w = f + (((f + 1) & 4) << 1);
+            w = ((0 - w) * g) & m;
+        }
+        g += f * w;
+        q += u * w;
+        r += v * w;
+    }
+
+    t->u = (int64_t)u;
+    t->v = (int64_t)v;
+    t->q = (int64_t)q;
+    t->r = (int64_t)r;
+    return eta;
+}
+
+
+// [f, g] = t [f, g] / 2^62, exact
+static void update_fg(int64_t *f, int64_t *g, const trans62_t *t)
+{
+    int128_t cf, cg;
+
+    cf = (int128_t)t->u * f[0] + (int128_t)t->v * g[0];
+    cg = (int128_t)t->q * f[0] + (int128_t)t->r * g[0];
+    cf >>= 62;
+    cg >>= 62;
+    for (int i = 1; i < LIMBS62; i++)
+    {
+        cf += (int128_t)t->u * f[i] + (int128_t)t->v * g[i];
+        cg += (int128_t)t->q * f[i] + (int128_t)t->r * g[i];
+        f[i - 1] = (int64_t)cf & MASK62;
+        g[i - 1] = (int64_t)cg & MASK62;
+        cf >>= 62;
+        cg >>= 62;
+    }
+    f[LIMBS62 - 1] = (int64_t)cf;
+    g[LIMBS62 - 1] = (int64_t)cg;
+}
+
+
+// [d, e] = t [d, e] / 2^62 (mod p), inputs and outputs in (-2p, p)
+// A negative d or e first gets p added (as u*p, v*p, ...), then md*p and me*p clear the low 62 bits
+static void update_de(int64_t *d, int64_t *e, const trans62_t *t, const int64_t *p62, const digit_t ip62)
+{
+    const int64_t sd = d[LIMBS62 - 1] >> 63, se = e[LIMBS62 - 1] >> 63;
+    int64_t md, me;
+    int128_t cd, ce;
+
+    md = (t->u & sd) + (t->v & se);
+    me = (t->q & sd) + (t->r & se);
+    cd = (int128_t)t->u * d[0] + (int128_t)t->v * e[0];
+    ce = (int128_t)t->q * d[0] + (int128_t)t->r * e[0];
+    md -= (int64_t)((ip62 * (digit_t)cd + (digit_t)md) & MASK62);
+    me -= (int64_t)((ip62 * (digit_t)ce + (digit_t)me) & MASK62);
+    cd += (int128_t)p62[0] * md;
+    ce += (int128_t)p62[0] * me;
+    cd >>= 62;
+    ce >>= 62;
+    for (int i = 1; i < LIMBS62; i++)
+    {
+        cd += (int128_t)t->u * d[i] + (int128_t)t->v * e[i] + (int128_t)p62[i] * md;
+        ce += (int128_t)t->q * d[i] + (int128_t)t->r * e[i] + (int128_t)p62[i] * me;
+        d[i - 1] = (int64_t)cd & MASK62;
+        e[i - 1] = (int64_t)ce & MASK62;
+        cd >>= 62;
+        ce >>= 62;
+    }
+    d[LIMBS62 - 1] = (int64_t)cd;
+    e[LIMBS62 - 1] = (int64_t)ce;
+}
+
+
+// p^(-1) mod 2^62 by Newton iteration, p is its own inverse mod 2^3
+static digit_t safegcd_ip62(void)
+{
+    digit_t ip62 = p[0];
+
+    for (int i = 0; i < 5; i++)
+        ip62 *= 2 - p[0] * ip62;
+    return ip62 & MASK62;
+}
+
+
+// b = +-d for f = +-1 and d in (-2p, p), moved back to Montgomery form
+static void safegcd_finish(int64_t *d, const int64_t *f, const int64_t *p62, f_elm_t b)
+{
+    s62_cadd_p(d, p62, d[LIMBS62 - 1] >> 63);
+    s62_cneg(d, f[LIMBS62 - 1] >> 63);
+    s62_cadd_p(d, p62, d[LIMBS62 - 1] >> 63);
+    s62_to_words(d, b);
+
+#ifndef CANONICAL_FORM
+    f_mul(b, R2, b);
+    f_mul(b, R2, b);
+#endif
+}
+
+
+#ifndef FERMAT_INVERSION
+
+// Multiplicative inverse of a field element, 0 for a = 0
+void f_inv(const f_elm_t a, f_elm_t b)
+{
+    s62_t f, g, d = {0}, e = {0}, p62;
+    f_elm_t t0;
+    trans62_t t;
+    int64_t delta = 1;
+    const digit_t ip62 = safegcd_ip62();
+
+    f_copy(a, t0);
+#if defined(REDUNDANT_FORM) || defined(MERSENNE_FORM)
+    f_red(t0);
+#endif
+
+    s62_from_words(p, p62);
+    s62_from_words(p, f);
+    s62_from_words(t0, g);
+    e[0] = 1;
+
+    for (int i = 0; i < SAFEGCD_BATCHES; i++)
+    {
+        delta = divsteps_62(delta, (digit_t)f[0], (digit_t)g[0], &t);
+        update_de(d, e, &t, p62, ip62);
+        update_fg(f, g, &t);
+    }
+
+    safegcd_finish(d, f, p62, b);
+}
+
+#endif
+
+
+// Multiplicative inverse of a field element, 0 for a = 0. Variable time, for public inputs only
+void f_inv_vartime(const f_elm_t a, f_elm_t b)
+{
+    s62_t f, g, d = {0}, e = {0}, p62;
+    f_elm_t t0;
+    trans62_t t;
+    int64_t eta = -1, c;
+    const digit_t ip62 = safegcd_ip62();
+
+    f_copy(a, t0);
+#if defined(REDUNDANT_FORM) || defined(MERSENNE_FORM)
+    f_red(t0);
+#endif
+
+    s62_from_words(p, p62);
+    s62_from_words(p, f);
+    s62_from_words(t0, g);
+    e[0] = 1;
+
+    for (;;)
+    {
+        c = 0;
+        for (int i = 0; i < LIMBS62; i++)
+            c |= g[i];
+        if (c == 0)
+            break;
+
+        eta = divsteps_62_var(eta, (digit_t)f[0], (digit_t)g[0], &t);
+        update_de(d, e, &t, p62, ip62);
+        update_fg(f, g, &t);
+    }
+
+    safegcd_finish(d, f, p62, b);
+}
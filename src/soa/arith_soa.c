@@ -0,0 +1,388 @@
+#include <stdlib.h>
+#include <string.h>
+#include "arith.h"
+#include "dispatch.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #include <immintrin.h>
+    #define SOA_AVX2
+#endif
+
+// Structure-of-arrays vectors: limb i of element k is data[i*stride + k], stride is n rounded up to a block of eight
+// Every row starts on a 64-byte boundary and the padding lanes hold zeros, so the kernels always work on whole blocks.
+// With one word per element the layout is the one of f_elm_t[], and the array kernels (f_add_vec, ...) run on it directly.
+// Otherwise add, sub and select run across the lanes of a block (four per register with AVX2), mul and sqr gather each lane for f_mul/f_sqr.
+// The lane-parallel add and sub are exact (a +- b mod p in [0, p)), which is what f_add and f_sub return in every
+// form except the Mersenne and redundant ones, there they go through f_add/f_sub as well.
+
+#define SOA_LANES   8
+
+#if WORDS_FIELD > 1 && !defined(MERSENNE_FORM) && !defined(REDUNDANT_FORM)
+    #define SOA_EXACT_ADD
+#endif
+
+
+// Allocate a vector of n elements, all zero, 0 on success
+int f_vec_init(f_vec_t *v, const unsigned int n)
+{
+    v->n = n;
+    v->stride = (n + SOA_LANES - 1) & ~(SOA_LANES - 1u);
+    v->data = NULL;
+    if (v->stride == 0)
+        return 0;
+    v->data = aligned_alloc(64, (size_t)v->stride * WORDS_FIELD * sizeof(digit_t));
+    if (!v->data)
+        return -1;
+    memset(v->data, 0, (size_t)v->stride * WORDS_FIELD * sizeof(digit_t));
+    return 0;
+}
+
+
+void f_vec_free(f_vec_t *v)
+{
+    free(v->data);
+    v->data = NULL;
+    v->n = v->stride = 0;
+}
+
+
+// f_elm_t[] -> vector, a block of eight elements at a time
+void f_vec_pack(const f_elm_t *a, f_vec_t *v)
+{
+    const unsigned int n = v->n, stride = v->stride;
+    unsigned int k = 0;
+
+    for (; k + SOA_LANES <= n; k += SOA_LANES)
+        for (int i = 0; i < WORDS_FIELD; i++)
+            for (int l = 0; l < SOA_LANES; l++)
+                v->data[i * stride + k + l] = a[k + l][i];
+    for (; k < n; k++)
+        for (int i = 0; i < WORDS_FIELD; i++)
+            v->data[i * stride + k] = a[k][i];
+}
+
+
+// Vector -> f_elm_t[]
+void f_vec_unpack(const f_vec_t *v, f_elm_t *a)
+{
+    const unsigned int n = v->n, stride = v->stride;
+    unsigned int k = 0;
+
+    for (; k + SOA_LANES <= n; k += SOA_LANES)
+        for (int l = 0; l < SOA_LANES; l++)
+            for (int i = 0; i < WORDS_FIELD; i++)
+                a[k + l][i] = v->data[i * stride + k + l];
+    for (; k < n; k++)
+        for (int i = 0; i < WORDS_FIELD; i++)
+            a[k][i] = v->data[i * stride + k];
+}
+
+
+#ifdef SOA_EXACT_ADD
+// One block, c = a + b mod p with the carries of the eight lanes side by side
+static inline void soa_add_block(const digit_t *a, const digit_t *b, digit_t *c, const unsigned int stride)
+{
+    digit_t s[WORDS_FIELD][SOA_LANES], carry[SOA_LANES] = {0}, borrow[SOA_LANES] = {0};
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+        for (int l = 0; l < SOA_LANES; l++)
+        {
+            digit_t x = a[i * stride + l], y = b[i * stride + l];
+            digit_t t = x + y, u = t + carry[l];
+            carry[l] = (t < x) | (u < t);
+            s[i][l] = u;
+        }
+    for (int i = 0; i < WORDS_FIELD; i++)
+        for (int l = 0; l < SOA_LANES; l++)
+        {
+            digit_t t = s[i][l] - p[i], u = t - borrow[l];
+            borrow[l] = (s[i][l] < p[i]) | (t < borrow[l]);
+            c[i * stride + l] = u;
+        }
+    // a + b < p iff there was no carry out and the subtraction borrowed
+    for (int i = 0; i < WORDS_FIELD; i++)
+        for (int l = 0; l < SOA_LANES; l++)
+        {
+            digit_t mask = 0 - (borrow[l] & (1 - carry[l]));
+            c[i * stride + l] = (s[i][l] & mask) | (c[i * stride + l] & ~mask);
+        }
+}
+
+
+// One block, c = a - b mod p, p is added back where the subtraction borrowed
+static inline void soa_sub_block(const digit_t *a, const digit_t *b, digit_t *c, const unsigned int stride)
+{
+    digit_t s[WORDS_FIELD][SOA_LANES], carry[SOA_LANES] = {0}, borrow[SOA_LANES] = {0};
+
+    for (int i = 0; i < WORDS_FIELD; i++)
+        for (int l = 0; l < SOA_LANES; l++)
+        {
+            digit_t x = a[i * stride + l], y = b[i * stride + l];
+            digit_t t = x - y, u = t - borrow[l];
+            borrow[l] = (x < y) | (t < borrow[l]);
+            s[i][l] = u;
+        }
+    for (int i = 0; i < WORDS_FIELD; i++)
+        for (int l = 0; l < SOA_LANES; l++)
+        {
+            digit_t m = p[i] & (0 - borrow[l]);
+            digit_t t = s[i][l] + m, u = t + carry[l];
+            carry[l] = (t < m) | (u < t);
+            c[i * stride + l] = u;
+        }
+}
+#endif
+
+
+// One block, c = cond ? b : a per lane
+static inline void soa_select_block(const digit_t *a, const digit_t *b, digit_t *c, const uint8_t *cond, const unsigned int stride)
+{
+    digit_t mask[SOA_LANES];
+
+    for (int l = 0; l < SOA_LANES; l++)
+        mask[l] = 0 - (digit_t)cond[l];
+    for (int i = 0; i < WORDS_FIELD; i++)
+        for (int l = 0; l < SOA_LANES; l++)
+            c[i * stride + l] = a[i * stride + l] ^ ((a[i * stride + l] ^ b[i * stride + l]) & mask[l]);
+}
+
+
+#ifdef SOA_AVX2
+// Unsigned a < b on four lanes, all ones where true
+__attribute__((target("avx2")))
+static inline __m256i ltu_x4(__m256i a, __m256i b)
+{
+    const __m256i sign = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+    return _mm256_cmpgt_epi64(_mm256_xor_si256(b, sign), _mm256_xor_si256(a, sign));
+}
+
+
+#ifdef SOA_EXACT_ADD
+// Four lanes of soa_add_block, carries and borrows are kept as all-ones masks
+__attribute__((target("avx2")))
+static void soa_add_avx2(const f_vec_t *a, const f_vec_t *b, f_vec_t *c)
+{
+    const unsigned int stride = a->stride;
+
+    for (unsigned int k = 0; k < stride; k += 4)
+    {
+        __m256i s[WORDS_FIELD], carry = _mm256_setzero_si256(), borrow = _mm256_setzero_si256(), t, u, x, mask;
+
+        #pragma GCC unroll 8
+        for (int i = 0; i < WORDS_FIELD; i++)
+        {
+            x = _mm256_load_si256((const __m256i *)&a->data[i * stride + k]);
+            t = _mm256_add_epi64(x, _mm256_load_si256((const __m256i *)&b->data[i * stride + k]));
+            u = _mm256_sub_epi64(t, carry);
+            carry = _mm256_or_si256(ltu_x4(t, x), ltu_x4(u, t));
+            s[i] = u;
+        }
+        #pragma GCC unroll 8
+        for (int i = 0; i < WORDS_FIELD; i++)
+        {
+            x = _mm256_set1_epi64x(p[i]);
+            t = _mm256_sub_epi64(s[i], x);
+            u = _mm256_add_epi64(t, borrow);
+            borrow = _mm256_or_si256(ltu_x4(s[i], x), ltu_x4(t, u));
+            _mm256_store_si256((__m256i *)&c->data[i * stride + k], u);
+        }
+        mask = _mm256_andnot_si256(carry, borrow);          // a + b < p
+        #pragma GCC unroll 8
+        for (int i = 0; i < WORDS_FIELD; i++)
+        {
+            t = _mm256_load_si256((const __m256i *)&c->data[i * stride + k]);
+            _mm256_store_si256((__m256i *)&c->data[i * stride + k], _mm256_blendv_epi8(t, s[i], mask));
+        }
+    }
+}
+
+
+// Four lanes of soa_sub_block
+__attribute__((target("avx2")))
+static void soa_sub_avx2(const f_vec_t *a, const f_vec_t *b, f_vec_t *c)
+{
+    const unsigned int stride = a->stride;
+
+    for (unsigned int k = 0; k < stride; k += 4)
+    {
+        __m256i s[WORDS_FIELD], carry = _mm256_setzero_si256(), borrow = _mm256_setzero_si256(), t, u, x, y, m;
+
+        #pragma GCC unroll 8
+        for (int i = 0; i < WORDS_FIELD; i++)
+        {
+            x = _mm256_load_si256((const __m256i *)&a->data[i * stride + k]);
+            y = _mm256_load_si256((const __m256i *)&b->data[i * stride + k]);
+            t = _mm256_sub_epi64(x, y);
+            u = _mm256_add_epi64(t, borrow);
+            borrow = _mm256_or_si256(ltu_x4(x, y), ltu_x4(t, u));
+            s[i] = u;
+        }
+        #pragma GCC unroll 8
+        for (int i = 0; i < WORDS_FIELD; i++)
+        {
+            m = _mm256_and_si256(_mm256_set1_epi64x(p[i]), borrow);
+            t = _mm256_add_epi64(s[i], m);
+            u = _mm256_sub_epi64(t, carry);
+            carry = _mm256_or_si256(ltu_x4(t, m), ltu_x4(u, t));
+            _mm256_store_si256((__m256i *)&c->data[i * stride + k], u);
+        }
+    }
+}
+#endif
+
+
+// Four lanes of soa_select_block, the masks come from the condition bytes
+__attribute__((target("avx2")))
+static void soa_select_avx2(const f_vec_t *a, const f_vec_t *b, f_vec_t *c, const uint8_t *cond)
+{
+    const unsigned int stride = a->stride;
+    uint8_t last[4] = {0};
+
+    for (unsigned int k = 0; k < a->n; k += 4)
+    {
+        __m256i mask, x, y;
+        uint32_t bytes;
+
+        if (k + 4 <= a->n)
+            memcpy(&bytes, cond + k, 4);
+        else
+        {
+            memcpy(last, cond + k, a->n - k);
+            memcpy(&bytes, last, 4);
+        }
+        mask = _mm256_sub_epi64(_mm256_setzero_si256(), _mm256_cvtepu8_epi64(_mm_cvtsi32_si128((int)bytes)));
+        #pragma GCC unroll 8
+        for (int i = 0; i < WORDS_FIELD; i++)
+        {
+            x = _mm256_load_si256((const __m256i *)&a->data[i * stride + k]);
+            y = _mm256_load_si256((const __m256i *)&b->data[i * stride + k]);
+            _mm256_store_si256((__m256i *)&c->data[i * stride + k], _mm256_xor_si256(x, _mm256_and_si256(_mm256_xor_si256(x, y), mask)));
+        }
+    }
+}
+#endif
+
+
+// Gather lane k of a vector into a field element and back
+static inline void soa_get(const f_vec_t *v, const unsigned int k, f_elm_t a)
+{
+    for (int i = 0; i < WORDS_FIELD; i++)
+        a[i] = v->data[i * v->stride + k];
+}
+
+static inline void soa_set(f_vec_t *v, const unsigned int k, const f_elm_t a)
+{
+    for (int i = 0; i < WORDS_FIELD; i++)
+        v->data[i * v->stride + k] = a[i];
+}
+
+
+// Addition of two vectors, c[k] = a[k] + b[k]
+void f_vec_add(const f_vec_t *a, const f_vec_t *b, f_vec_t *c)
+{
+#if WORDS_FIELD == 1
+    f_add_vec((const f_elm_t *)a->data, (const f_elm_t *)b->data, (f_elm_t *)c->data, a->n);
+#elif defined(SOA_EXACT_ADD)
+    #ifdef SOA_AVX2
+    if (cpu_features() & CPU_AVX2)
+    {
+        soa_add_avx2(a, b, c);
+        return;
+    }
+    #endif
+    for (unsigned int k = 0; k < a->stride; k += SOA_LANES)
+        soa_add_block(a->data + k, b->data + k, c->data + k, a->stride);
+#else
+    f_elm_t x, y;
+    for (unsigned int k = 0; k < a->n; k++)
+    {
+        soa_get(a, k, x); soa_get(b, k, y);
+        f_add(x, y, x);
+        soa_set(c, k, x);
+    }
+#endif
+}
+
+
+// Subtraction of two vectors, c[k] = a[k] - b[k]
+void f_vec_sub(const f_vec_t *a, const f_vec_t *b, f_vec_t *c)
+{
+#if WORDS_FIELD == 1
+    f_sub_vec((const f_elm_t *)a->data, (const f_elm_t *)b->data, (f_elm_t *)c->data, a->n);
+#elif defined(SOA_EXACT_ADD)
+    #ifdef SOA_AVX2
+    if (cpu_features() & CPU_AVX2)
+    {
+        soa_sub_avx2(a, b, c);
+        return;
+    }
+    #endif
+    for (unsigned int k = 0; k < a->stride; k += SOA_LANES)
+        soa_sub_block(a->data + k, b->data + k, c->data + k, a->stride);
+#else
+    f_elm_t x, y;
+    for (unsigned int k = 0; k < a->n; k++)
+    {
+        soa_get(a, k, x); soa_get(b, k, y);
+        f_sub(x, y, x);
+        soa_set(c, k, x);
+    }
+#endif
+}
+
+
+// Multiplication of two vectors, c[k] = a[k] * b[k]
+void f_vec_mul(const f_vec_t *a, const f_vec_t *b, f_vec_t *c)
+{
+#if WORDS_FIELD == 1
+    f_mul_vec((const f_elm_t *)a->data, (const f_elm_t *)b->data, (f_elm_t *)c->data, a->n);
+#else
+    f_elm_t x, y;
+    for (unsigned int k = 0; k < a->n; k++)
+    {
+        soa_get(a, k, x); soa_get(b, k, y);
+        f_mul(x, y, x);
+        soa_set(c, k, x);
+    }
+#endif
+}
+
+
+// Squaring of a vector, c[k] = a[k]^2
+void f_vec_sqr(const f_vec_t *a, f_vec_t *c)
+{
+#if WORDS_FIELD == 1
+    f_sqr_vec((const f_elm_t *)a->data, (f_elm_t *)c->data, a->n);
+#else
+    f_elm_t x;
+    for (unsigned int k = 0; k < a->n; k++)
+    {
+        soa_get(a, k, x);
+        f_sqr(x, x);
+        soa_set(c, k, x);
+    }
+#endif
+}
+
+
+// Selection between two vectors, c[k] = b[k] if cond[k] = 1, a[k] if cond[k] = 0
+void f_vec_select(const f_vec_t *a, const f_vec_t *b, f_vec_t *c, const uint8_t *cond)
+{
+#ifdef SOA_AVX2
+    if (cpu_features() & CPU_AVX2)
+    {
+        soa_select_avx2(a, b, c, cond);
+        return;
+    }
+#endif
+    uint8_t last[SOA_LANES] = {0};
+    unsigned int k = 0;
+
+    for (; k + SOA_LANES <= a->n; k += SOA_LANES)
+        soa_select_block(a->data + k, b->data + k, c->data + k, cond + k, a->stride);
+    if (k < a->n)
+    {
+        memcpy(last, cond + k, a->n - k);               // the padding lanes keep a, which is zero
+        soa_select_block(a->data + k, b->data + k, c->data + k, last, a->stride);
+    }
+}
@@ -5,29 +5,68 @@
 #include <stdlib.h>
 #include "arith.h"
 #include "random.h"
+#include "dispatch.h"
 
 #define TEST_LOOPS      256
 #define MAX(a,b)    (((a)>(b))?(a):(b))
 
+#ifdef REDUNDANT_FORM
+#define RED_TESTS   4
+#else
 #define RED_TESTS   3
-#define ADD_TESTS   3
+#endif
+#define ADD_TESTS   4
 #define NEG_TESTS   3
-#define SUB_TESTS   5
-#define MUL_TESTS   5
-#define LEG_TESTS   3
-#define INV_TESTS   2
-#define SQRT_TESTS  1
-#define NUM_TESTS   8
-
-#define TESTS_PAD   MAX(MAX(MAX(RED_TESTS, ADD_TESTS), MAX(NEG_TESTS, SUB_TESTS)), MAX(MAX(MUL_TESTS, LEG_TESTS), MAX(INV_TESTS, SQRT_TESTS)))
+#define SUB_TESTS   6
+#define MUL_TESTS   7
+#define SQR_TESTS   4
+#define LEG_TESTS   5
+#define INV_TESTS   5
+#define SQRT_TESTS  2
+#define DOT_TESTS   3
+#define F51_TESTS   6
+#define X4_TESTS    5
+#define X8_TESTS    3
+#define SOA_TESTS   5
+#define MULL_TESTS  3
+#define CT_TESTS    3
+#define CONST_TESTS 3
+#ifdef RADIX51
+#define F51_ROWS    1
+#else
+#define F51_ROWS    0
+#endif
+#if PRIME_ID == P256_0
+#define X4_ROWS     1
+#else
+#define X4_ROWS     0
+#endif
+#define X4_ROW      (10 + F51_ROWS)
+#define X8_ROW      (10 + F51_ROWS + X4_ROWS)
+#define SOA_ROW     (11 + F51_ROWS + X4_ROWS)
+#define MULL_ROW    (12 + F51_ROWS + X4_ROWS)
+#define CT_ROW      (13 + F51_ROWS + X4_ROWS)
+#define CONST_ROW   (14 + F51_ROWS + X4_ROWS)
+#define NUM_TESTS   (15 + F51_ROWS + X4_ROWS)
+
+#define TESTS_PAD   MAX(MAX(MAX(RED_TESTS, ADD_TESTS), MAX(NEG_TESTS, SUB_TESTS)), MAX(MAX(MAX(MUL_TESTS, SQR_TESTS), LEG_TESTS), MAX(MAX(INV_TESTS, SQRT_TESTS), MAX(DOT_TESTS, MAX(F51_TESTS, MAX(X4_TESTS, MAX(X8_TESTS, MAX(SOA_TESTS, MAX(MULL_TESTS, MAX(CT_TESTS, CONST_TESTS))))))))))
 #define TESTS_LEN(x) (  (x) == 0 ? RED_TESTS  : \
                         (x) == 1 ? ADD_TESTS  : \
                         (x) == 2 ? NEG_TESTS  : \
                         (x) == 3 ? SUB_TESTS  : \
                         (x) == 4 ? MUL_TESTS  : \
-                        (x) == 5 ? LEG_TESTS  : \
-                        (x) == 6 ? INV_TESTS  : \
-                        (x) == 7 ? SQRT_TESTS : -1)
+                        (x) == 5 ? SQR_TESTS  : \
+                        (x) == 6 ? LEG_TESTS  : \
+                        (x) == 7 ? INV_TESTS  : \
+                        (x) == 8 ? SQRT_TESTS : \
+                        (x) == 9 ? DOT_TESTS  : \
+                        (x) == 10 && F51_ROWS ? F51_TESTS : \
+                        (x) == X4_ROW && X4_ROWS ? X4_TESTS : \
+                        (x) == X8_ROW ? X8_TESTS : \
+                        (x) == SOA_ROW ? SOA_TESTS : \
+                        (x) == MULL_ROW ? MULL_TESTS : \
+                        (x) == CT_ROW ? CT_TESTS : \
+                        (x) == CONST_ROW ? CONST_TESTS : -1)
 
 
 #define PASS(x)                 ((x) ? "\033[31m✗\033[0m" : "\033[0;32m✔\033[0m")
@@ -42,16 +81,47 @@ const char* pass_check(unsigned char arr[], int n) {
     return buffer;
 }
 
+#ifdef REDUNDANT_FORM
+// 1 if a is not below 2p, the bound on every element in redundant form
+unsigned char out_of_range(const f_elm_t a) {
+    digit_t borrow = 0, t;
+    for(int i = 0; i < WORDS_FIELD; i++)
+        SUBC(borrow, a[i], (p[i] << 1) | (i ? p[i - 1] >> 63 : 0), t);
+    (void)t;
+    return (unsigned char)(1 - borrow);
+}
+#endif
+
+
+#ifdef RADIX51
+// 0 if the radix 2^51 element a (a plain value) equals the field element b, 1 otherwise
+unsigned char f51_eq(const f51_elm_t a, const f_elm_t b) {
+    f_elm_t t0, t1;
+    f51_pack(a, t0);
+    to_mont(t0, t1);
+    return f_eq(t1, b);
+}
+#endif
+
 
 int main(int argc, char* argv[]){
     (void)argv[0];
     (void)argc;
 
-    const char *function_names[] = {"f_red", "f_add", "f_neg", "f_sub", "f_mul", "f_leg", "f_inv", "f_sqr"};
+    const char *function_names[] = {"f_red ", "f_add ", "f_neg ", "f_sub ", "f_mul ", "f_sqr ", "f_leg ", "f_inv ", "f_sqrt", "f_dot ",
+#ifdef RADIX51
+                                    "f51_* ",
+#endif
+#if PRIME_ID == P256_0
+                                    "f_*_x4",
+#endif
+                                    "f_*_x8", "f_vec ", "f_mul4", "f_ct  ", "f_cnst"};
     unsigned char *s = NULL;
     f_elm_t *t0 = NULL, *t1 = NULL, *t2 = NULL;
+    f_vec_t sv0 = {0}, sv1 = {0}, sv2 = {0};
     unsigned char f;
     f_elm_t s0, s1, s2;
+    acc_t acc;
     int result = 0;
 
     s = calloc(TEST_LOOPS, sizeof(unsigned char));
@@ -59,7 +129,7 @@ int main(int argc, char* argv[]){
     t1 = malloc(TEST_LOOPS * sizeof(f_elm_t));
     t2 = malloc(TEST_LOOPS * sizeof(f_elm_t));
     
-    if (!s || !t0 || !t1 || !t2) {
+    if (!s || !t0 || !t1 || !t2 || f_vec_init(&sv0, TEST_LOOPS - 3) || f_vec_init(&sv1, TEST_LOOPS - 3) || f_vec_init(&sv2, TEST_LOOPS - 3)) {
         fprintf(stderr, "Error: Memory allocation failed\n");
         result = 1;
         goto cleanup;
@@ -77,7 +147,11 @@ int main(int argc, char* argv[]){
     unsigned char tests[NUM_TESTS][256] = {0};
 
     const char *prime_names[] = {"p64_0", "p64_1", "p128_0", "p128_1", "p192_0", "p192_1", "p256_0", "p256_1", "p512_0", "p512_1"};
+#ifdef RUNTIME_DISPATCH
+    printf("Running tests for %s (%s backend)\n\n", prime_names[PRIME_ID], f_backend_name());
+#else
     printf("Running tests for %s\n\n", prime_names[PRIME_ID]);
+#endif
 
     for(int i = 0; i < TEST_LOOPS; i++){
 
@@ -91,6 +165,24 @@ int main(int argc, char* argv[]){
         f_copy(p, s0); f_red(s0);                       // s0 = p % p
         tests[0][2] |= f_eq(s0, Zero);
 
+#ifdef REDUNDANT_FORM
+        // Redundant representative s2 = t0 + p in [p, 2p) behaves as t0, and every result stays below 2p
+        digit_t carry = 0;
+        for(int k = 0; k < WORDS_FIELD; k++) ADDC(carry, t0[i][k], p[k], s2[k]);
+        f_mul(s2, t1[i], s0); f_mul(t0[i], t1[i], s1);
+        tests[0][3] |= f_eq(s0, s1) | out_of_range(s0);
+        f_sqr(s2, s0); f_sqr(t0[i], s1);
+        tests[0][3] |= f_eq(s0, s1) | out_of_range(s0);
+        f_add(s2, s2, s0); f_add(t0[i], t0[i], s1);
+        tests[0][3] |= f_eq(s0, s1) | out_of_range(s0);
+        f_sub(t1[i], s2, s0); f_sub(t1[i], t0[i], s1);
+        tests[0][3] |= f_eq(s0, s1) | out_of_range(s0);
+        f_neg(s2, s0); f_neg(t0[i], s1);
+        tests[0][3] |= f_eq(s0, s1) | out_of_range(s0);
+        from_mont(s2, s0); from_mont(t0[i], s1);        // from_mont returns the canonical value
+        tests[0][3] |= (memcmp(s0, s1, sizeof(f_elm_t)) != 0);
+#endif
+
 
         // Addition check
         f_add(t0[i], t1[i], s0); f_add(s0, t2[i], s0);  // s0 = (t0 + t1) + t2
@@ -149,41 +241,85 @@ int main(int argc, char* argv[]){
         f_mul(t1[i], t0[i], s1);                        // s1 = t1 * t0
         tests[4][2] |= f_eq(s0, s1);
 
-        f_mul(t0[i], Mont_one, s0);                     // s0 = t0 * 1
+        f_mul(t0[i], F_ONE, s0);                        // s0 = t0 * 1
         tests[4][3] |= f_eq(s0, t0[i]);
         
         f_mul(t0[i], Zero, s0);                         // s0 = t0 * 0
         tests[4][4] |= f_eq(s0, Zero);
 
 
+        // Squaring checks
+        f_sqr(t0[i], s0);                               // s0 = t0^2
+        f_mul(t0[i], t0[i], s1);                        // s1 = t0 * t0
+        tests[5][0] |= f_eq(s0, s1);
+
+        f_add(t0[i], t1[i], s0); f_sqr(s0, s0);         // s0 = (t0 + t1)^2
+        f_sqr(t0[i], s1); f_sqr(t1[i], s2); f_add(s1, s2, s1);
+        f_mul(t0[i], t1[i], s2); f_add(s2, s2, s2); f_add(s1, s2, s1);  // s1 = t0^2 + 2 * t0 * t1 + t1^2
+        tests[5][1] |= f_eq(s0, s1);
+
+        f_neg(F_ONE, s0); f_sqr(s0, s0);                // s0 = (-1)^2
+        tests[5][2] |= f_eq(s0, F_ONE);
+
+
         // Legendre check
         f_leg(t0[i], s);                                                // s   = f_leg(t0)
         f_mul(t1[i], t1[i], s1); f_mul(s1, t0[i], s1); f_leg(s1, s+1);  // s+1 = f_leg(t0 * t1 * t1)
         if((f_eq(t0[i], Zero)) && (f_eq(t1[i], Zero)))// Ignore input t0 = 0 or t1 = 0
-        tests[5][0] |= s[0] ^ s[1];
+        tests[6][0] |= s[0] ^ s[1];
 
         f_leg(t0[i], s);                                // s   = f_leg(t0)
         f_leg(t1[i], s+1);                              // s+1 = f_leg(t1)
         f_mul(t0[i], t1[i], s0); f_leg(s0, s+2);        // s+2 = f_leg(t0 * t1)
         if((f_eq(t0[i], Zero)) && (f_eq(t1[i], Zero)))// Ignore input t0 = 0 or t1 = 0
-        tests[5][1] |= s[0] ^ s[1] ^ s[2];
+        tests[6][1] |= s[0] ^ s[1] ^ s[2];
 
         if(i == 0) f_leg(t0[i], &f);
-        tests[5][2] |= (f ^ s[0]) |(f ^ s[1]) | (f ^ s[2]); // They are not all equal (to the first value)
+        tests[6][2] |= (f ^ s[0]) |(f ^ s[1]) | (f ^ s[2]); // They are not all equal (to the first value)
+
+        if(i == TEST_LOOPS - 1) tests[6][2] = !tests[6][2]; // If they were all equal result would be 0.
+
+        f_sqr(t0[i], s0);                               // Jacobi symbol: t0^2 is a square, f_leg agrees
+        if(f_eq(t0[i], Zero))     // Ignore input t0 = 0
+        tests[6][3] |= (f_jacobi(s0) != 1) | ((f_jacobi(t0[i]) < 0) ^ s[0]);
+
+        if(i == 0){                                     // (0 | p) = 0, (1 | p) = 1, (-1 | p) = 1 iff p = 1 mod 4
+            tests[6][3] |= (f_jacobi(Zero) != 0) | (f_jacobi(F_ONE) != 1);
+            f_neg(F_ONE, s0);
+            tests[6][3] |= f_jacobi(s0) != ((p[0] & 2) ? -1 : 1);
+        }
 
-        if(i == TEST_LOOPS - 1) tests[5][2] = !tests[5][2]; // If they were all equal result would be 0.
+        f_leg_vartime(t0[i], &f);                       // Variable-time versions agree
+        tests[6][4] |= (f_jacobi_vartime(t0[i]) != f_jacobi(t0[i])) | (f ^ s[0]);
+        if(i == 0) tests[6][4] |= f_jacobi_vartime(Zero) != 0;
 
 
         // Inverse check
         f_inv(t0[i], s0);                               // s0 = t0^(-1)
         f_mul(s0, t0[i], s0);                           // s0 = s0 * s0^(-1)
         if(f_eq(t0[i], Zero))     // Ignore input t0 = 0
-        tests[6][0] |= f_eq(s0, Mont_one);
+        tests[7][0] |= f_eq(s0, F_ONE);
         
 
         f_inv(t0[i], s0);                               // s0 = t0^(-1)
         f_inv(s0, s1);                                  // s1 = s0^(-1) = t0
-        tests[6][1] |= f_eq(s1, t0[i]);
+        tests[7][1] |= f_eq(s1, t0[i]);
+
+        if(i == 0){                                     // 0^(-1) = 0, 1 and -1 are their own inverses
+            f_inv(Zero, s0);
+            tests[7][2] |= f_eq(s0, Zero);
+            f_inv(F_ONE, s0);
+            tests[7][2] |= f_eq(s0, F_ONE);
+            f_neg(F_ONE, s1); f_inv(s1, s0);
+            tests[7][2] |= f_eq(s0, s1);
+        }
+
+        f_inv(t0[i], s0); f_inv_vartime(t0[i], s1);     // Variable-time version agrees, 0 for 0
+        tests[7][3] |= f_eq(s0, s1);
+        if(i == 0){
+            f_inv_vartime(Zero, s0);
+            tests[7][3] |= f_eq(s0, Zero);
+        }
 
 
         // Square root test
@@ -191,9 +327,467 @@ int main(int argc, char* argv[]){
         f_mul(s0, s0, s0);                           // s0 = s0^2 = t0
         f_leg(t0[i], s);
         if(!*s)                                      // Test if t0 is a square
-        tests[7][0] |= f_eq(t0[i], s0);
+        tests[8][0] |= f_eq(t0[i], s0);
+
+        f = (unsigned char)f_sqrt_vartime(t0[i], s0);   // Root of a square, 0 for a non-square
+        f_mul(s0, s0, s1);
+        tests[8][1] |= *s ? (f | f_eq(s0, Zero)) : ((f ^ 1) | f_eq(t0[i], s1));
+
+    }
+
+#ifdef REDUNDANT_FORM
+    // Largest redundant representative s2 = 2p - 1, p is odd so the decrement does not borrow
+    for(int k = 0; k < WORDS_FIELD; k++) s2[k] = (p[k] << 1) | (k ? p[k - 1] >> 63 : 0);
+    s2[0] -= 1;
+    f_copy(p, s1); s1[0] -= 1;                          // s1 = p - 1
+    f_mul(s2, s2, s0); f_mul(s1, s1, t2[0]);
+    tests[0][3] |= f_eq(s0, t2[0]) | out_of_range(s0);
+    f_add(s2, s2, s0); f_add(s1, s1, t2[0]);
+    tests[0][3] |= f_eq(s0, t2[0]) | out_of_range(s0);
+    f_sub(Zero, s2, s0); f_neg(s1, t2[0]);
+    tests[0][3] |= f_eq(s0, t2[0]) | out_of_range(s0);
+    f_rand(t2[0]);
+#endif
+
+    // Accumulator checks
+    for(int i = 0; i < TEST_LOOPS - 2; i++){
+        acc_zero(acc);                                  // s0 = t0 * t1 + t1 * t2 - t2 * t0
+        acc_muladd(acc, t0[i], t1[i]); acc_muladd(acc, t1[i], t2[i]); acc_mulsub(acc, t2[i], t0[i]);
+        acc_reduce(acc, s0);
+        f_mul(t0[i], t1[i], s1); f_mul(t1[i], t2[i], s2); f_add(s1, s2, s1);
+        f_mul(t2[i], t0[i], s2); f_sub(s1, s2, s1);
+        tests[9][0] |= f_eq(s0, s1);
+    }
+
+    f_dot(TEST_LOOPS, (const f_elm_t *)t0, (const f_elm_t *)t1, s0);   // s0 = sum t0[i] * t1[i]
+    f_copy(Zero, s1);
+    for(int i = 0; i < TEST_LOOPS; i++){
+        f_mul(t0[i], t1[i], s2); f_add(s1, s2, s1);
+    }
+    tests[9][1] |= f_eq(s0, s1);
+
+    f_neg(F_ONE, s2);                                   // (-1) * (-1) maximizes every product
+    acc_zero(acc); f_copy(Zero, s1);
+    for(int i = 0; i < TEST_LOOPS; i++){
+        acc_muladd(acc, s2, s2); f_add(s1, F_ONE, s1);  // s1 = TEST_LOOPS
+    }
+    acc_reduce(acc, s0);
+    tests[9][2] |= f_eq(s0, s1);
+    for(int i = 0; i < 2 * TEST_LOOPS; i++){
+        acc_mulsub(acc, s2, s2); f_sub(s1, F_ONE, s1);  // s1 = -TEST_LOOPS
+    }
+    acc_reduce(acc, s0);
+    tests[9][2] |= f_eq(s0, s1);
+
+#ifdef RADIX51
+    // Radix 2^51 kernels against the 4x64 ones, through plain values
+    f_copy(max_val, s1); f_red(s1);                     // 2^256 - 1 = 37 (mod p)
+    f51_elm_t u0, u1, u2, u3;
+    f51_unpack(max_val, u0); f51_pack(u0, s0);
+    tests[10][0] |= (memcmp(s0, s1, sizeof(f_elm_t)) != 0);
+    f51_unpack(p, u0); f51_pack(u0, s0);
+    tests[10][0] |= (memcmp(s0, Zero, sizeof(f_elm_t)) != 0);
+    f_copy(p, s1); s1[0] += 18; f51_unpack(s1, u0);    // 2^255 - 1 = 18 (mod p)
+    f51_pack(u0, s0); f_copy(Zero, s1); s1[0] = 18;
+    tests[10][0] |= (memcmp(s0, s1, sizeof(f_elm_t)) != 0);
+
+    for(int i = 0; i < TEST_LOOPS; i++){
+        from_mont(t0[i], s0); f51_unpack(s0, u0);
+        from_mont(t1[i], s1); f51_unpack(s1, u1);
+        f51_pack(u0, s2);                               // pack(unpack(t0)) = t0
+        tests[10][0] |= (memcmp(s0, s2, sizeof(f_elm_t)) != 0);
+
+        f51_add(u0, u1, u2);                            // u2 = t0 + t1
+        f_add(t0[i], t1[i], s0);
+        tests[10][1] |= f51_eq(u2, s0);
+        f51_sub(u1, u2, u3);                            // u3 = t1 - (t0 + t1) = -t0
+        f_neg(t0[i], s1);
+        tests[10][1] |= f51_eq(u3, s1);
+
+        f51_mul(u2, u3, u2);                            // u2 = (t0 + t1) * -t0, inputs with unreduced limbs
+        f_mul(s0, s1, s0);
+        tests[10][2] |= f51_eq(u2, s0);
+        f51_mul(u0, u1, u2);
+        f_mul(t0[i], t1[i], s0);
+        tests[10][2] |= f51_eq(u2, s0);
+
+        f51_sqr(u3, u2);                                // u2 = (-t0)^2
+        f_sqr(t0[i], s0);
+        tests[10][3] |= f51_eq(u2, s0);
+        f51_sqr(u2, u2);
+        f_sqr(s0, s0);
+        tests[10][3] |= f51_eq(u2, s0);
+
+        f51_inv(u0, u2);                                // u2 = t0^(-1)
+        f_inv(t0[i], s0);
+        tests[10][4] |= f51_eq(u2, s0);
+
+        f_leg(t0[i], s);
+        f51_sqrt(u0, u2);                               // u2 = sqrt(t0)
+        f51_sqr(u2, u2);
+        if(!*s)
+        tests[10][5] |= f51_eq(u2, t0[i]);
+    }
+#endif
+
+#if PRIME_ID == P256_0
+    // 4-way kernels against the scalar ones, lane by lane
+    f_elm_t e4[4], r4[4];
+    f_elm_x4_t v0, v1, v2, v3;
+    f_copy(Zero, e4[0]); f_copy(F_ONE, e4[1]); f_neg(F_ONE, e4[2]); f_neg(F_ONE, e4[3]);
+    f_pack_x4((const f_elm_t *)e4, v0); f_unpack_x4(v0, r4);
+    for(int k = 0; k < 4; k++)
+        tests[X4_ROW][0] |= f_eq(r4[k], e4[k]);
+    f_sub_x4(v0, v0, v1);                               // limbs of 2p, the largest f_sub_x4 output of equal operands
+    f_add_x4(v0, v0, v2);
+    f_mul_x4(v1, v2, v3); f_unpack_x4(v3, r4);
+    for(int k = 0; k < 4; k++)
+        tests[X4_ROW][2] |= f_eq(r4[k], Zero);          // (x - x) * 2x = 0
+    f_mul_x4(v2, v2, v3); f_unpack_x4(v3, r4);
+    for(int k = 0; k < 4; k++){
+        f_add(e4[k], e4[k], s0); f_sqr(s0, s0);
+        tests[X4_ROW][2] |= f_eq(r4[k], s0);
+    }
+
+    for(int i = 0; i < TEST_LOOPS; i += 4){
+        f_pack_x4((const f_elm_t *)&t0[i], v0);
+        f_pack_x4((const f_elm_t *)&t1[i], v1);
+        f_unpack_x4(v0, r4);                            // unpack(pack(t0)) = t0
+        for(int k = 0; k < 4; k++)
+            tests[X4_ROW][0] |= f_eq(r4[k], t0[i + k]);
+
+        f_add_x4(v0, v1, v2);                           // v2 = t0 + t1
+        f_unpack_x4(v2, r4);
+        for(int k = 0; k < 4; k++){
+            f_add(t0[i + k], t1[i + k], s0);
+            tests[X4_ROW][1] |= f_eq(r4[k], s0);
+        }
+        f_sub_x4(v0, v1, v3);                           // v3 = t0 - t1
+        f_unpack_x4(v3, r4);
+        for(int k = 0; k < 4; k++){
+            f_sub(t0[i + k], t1[i + k], s0);
+            tests[X4_ROW][1] |= f_eq(r4[k], s0);
+        }
+
+        f_mul_x4(v0, v1, v2);                           // v2 = t0 * t1
+        f_unpack_x4(v2, r4);
+        for(int k = 0; k < 4; k++){
+            f_mul(t0[i + k], t1[i + k], s0);
+            tests[X4_ROW][2] |= f_eq(r4[k], s0);
+        }
+        f_add_x4(v0, v1, v2);                           // v2 = (t0 + t1) * (t0 - t1), inputs with unreduced limbs
+        f_mul_x4(v2, v3, v2);
+        f_unpack_x4(v2, r4);
+        for(int k = 0; k < 4; k++){
+            f_add(t0[i + k], t1[i + k], s0); f_sub(t0[i + k], t1[i + k], s1); f_mul(s0, s1, s0);
+            tests[X4_ROW][2] |= f_eq(r4[k], s0);
+        }
+
+        f_sqr_x4(v0, v2);                               // v2 = t0^2
+        f_unpack_x4(v2, r4);
+        for(int k = 0; k < 4; k++){
+            f_sqr(t0[i + k], s0);
+            tests[X4_ROW][3] |= f_eq(r4[k], s0);
+        }
+        f_sqr_x4(v3, v2);                               // v2 = (t0 - t1)^2
+        f_unpack_x4(v2, r4);
+        for(int k = 0; k < 4; k++){
+            f_sub(t0[i + k], t1[i + k], s0); f_sqr(s0, s0);
+            tests[X4_ROW][3] |= f_eq(r4[k], s0);
+        }
+
+        f_copy(t0[i], s0); f_copy(t0[i + 1], s1);       // chained squarings and multiplications on their own outputs
+        for(int j = 0; j < 64; j++){
+            f_sqr_x4(v0, v0); f_mul_x4(v0, v1, v0);
+            f_sqr(s0, s0); f_mul(s0, t1[i], s0);
+            f_sqr(s1, s1); f_mul(s1, t1[i + 1], s1);
+        }
+        f_unpack_x4(v0, r4);
+        tests[X4_ROW][4] |= f_eq(r4[0], s0) | f_eq(r4[1], s1);
+    }
+#endif
 
+    // Batched multiplication and squaring checks, t2 is reused as output
+    f_mul_vec((const f_elm_t *)t0, (const f_elm_t *)t1, t2, TEST_LOOPS);   // t2[i] = t0[i] * t1[i]
+    for(int i = 0; i < TEST_LOOPS; i++){
+        f_mul(t0[i], t1[i], s0);
+        tests[4][5] |= f_eq(s0, t2[i]);
+    }
+
+    f_sqr_vec((const f_elm_t *)t0, t2, TEST_LOOPS);                         // t2[i] = t0[i]^2
+    for(int i = 0; i < TEST_LOOPS; i++){
+        f_sqr(t0[i], s0);
+        tests[5][3] |= f_eq(s0, t2[i]);
+    }
+
+    // 8-way Montgomery kernels against the scalar ones, through plain values
+    f_elm_t e8[8], r8[8], q8[8];
+    f_elm_x8_t w0, w1, w2;
+    f_copy(Zero, e8[0]); f_copy(One, e8[1]); f_copy(p, e8[2]); f_copy(max_val, e8[3]);
+    for(int k = 4; k < 8; k++){
+        f_copy(p, e8[k]); e8[k][0] -= k - 3;                                    // p - 1, ..., p - 4
+    }
+    to_mont_x8((const f_elm_t *)e8, w0); from_mont_x8(w0, r8);
+    for(int k = 0; k < 8; k++){
+        f_copy(e8[k], s0); f_red(s0);                                           // s0 = e8[k] mod p
+        tests[X8_ROW][0] |= (memcmp(s0, r8[k], sizeof(f_elm_t)) != 0);
+    }
+    f_mul_x8(w0, w0, w1); from_mont_x8(w1, r8);                                 // (p - 1)^2 = 1, the largest product
+    tests[X8_ROW][1] |= (memcmp(r8[4], One, sizeof(f_elm_t)) != 0);
+
+    for(int i = 0; i + 8 <= TEST_LOOPS; i += 8){
+        for(int k = 0; k < 8; k++){
+            from_mont(t0[i + k], e8[k]);
+            from_mont(t1[i + k], q8[k]);
+        }
+        to_mont_x8((const f_elm_t *)e8, w0);
+        to_mont_x8((const f_elm_t *)q8, w1);
+        from_mont_x8(w0, r8);                                                   // from(to(t0)) = t0
+        for(int k = 0; k < 8; k++)
+            tests[X8_ROW][0] |= (memcmp(r8[k], e8[k], sizeof(f_elm_t)) != 0);
+
+        f_mul_x8(w0, w1, w2); from_mont_x8(w2, r8);                             // t0 * t1
+        for(int k = 0; k < 8; k++){
+            f_mul(t0[i + k], t1[i + k], s0); from_mont(s0, s1);
+            tests[X8_ROW][1] |= (memcmp(r8[k], s1, sizeof(f_elm_t)) != 0);
+        }
+
+        f_sqr_x8(w0, w2); from_mont_x8(w2, r8);                                 // t0^2
+        for(int k = 0; k < 8; k++){
+            f_sqr(t0[i + k], s0); from_mont(s0, s1);
+            tests[X8_ROW][2] |= (memcmp(r8[k], s1, sizeof(f_elm_t)) != 0);
+        }
+        f_copy(t0[i], s0);                                                      // chained on their own outputs
+        for(int j = 0; j < 64; j++){
+            f_sqr_x8(w0, w0); f_mul_x8(w0, w1, w0);
+            f_sqr(s0, s0); f_mul(s0, t1[i], s0);
+        }
+        from_mont_x8(w0, r8); from_mont(s0, s1);
+        tests[X8_ROW][2] |= (memcmp(r8[0], s1, sizeof(f_elm_t)) != 0);
+    }
+
+    // Array kernels, n = TEST_LOOPS - 1 leaves a tail after any unrolling
+    f_add_vec((const f_elm_t *)t0, (const f_elm_t *)t1, t2, TEST_LOOPS - 1);      // t2[i] = t0[i] + t1[i]
+    for(int i = 0; i < TEST_LOOPS - 1; i++){
+        f_add(t0[i], t1[i], s0);
+        tests[1][3] |= f_eq(s0, t2[i]);
+    }
+
+    f_sub_vec((const f_elm_t *)t0, (const f_elm_t *)t1, t2, TEST_LOOPS - 1);      // t2[i] = t0[i] - t1[i]
+    for(int i = 0; i < TEST_LOOPS - 1; i++){
+        f_sub(t0[i], t1[i], s0);
+        tests[3][5] |= f_eq(s0, t2[i]);
+    }
+
+    for(int i = 0; i < TEST_LOOPS; i++)
+        f_copy(t1[i], t2[i]);
+    f_axpy_vec(t0[0], (const f_elm_t *)t1, t2, TEST_LOOPS - 1);                   // t2[i] = t1[i] + t0[0] * t1[i]
+    for(int i = 0; i < TEST_LOOPS - 1; i++){
+        f_mul(t0[0], t1[i], s0); f_add(s0, t1[i], s0);
+        tests[4][6] |= f_eq(s0, t2[i]);
+    }
+    tests[4][6] |= f_eq(t2[TEST_LOOPS - 1], t1[TEST_LOOPS - 1]);
+
+    // The largest elements, -1 and -2, through every array kernel
+    f_elm_t e[8], e2[8];
+    for(int i = 0; i < 8; i++){
+        f_neg(F_ONE, e[i]);
+        if(i & 1) f_add(e[i], e[i], e[i]);
+    }
+    f_add_vec((const f_elm_t *)e, (const f_elm_t *)e, e2, 8);
+    f_add(e[7], e[7], s0);
+    tests[1][3] |= f_eq(e2[7], s0);
+    f_sub_vec((const f_elm_t *)e, (const f_elm_t *)&e[1], e2, 7);                 // -1 - (-2) = 1, -2 - (-1) = -1
+    tests[3][5] |= f_eq(e2[0], F_ONE) | f_eq(e2[1], e[0]);
+    f_mul_vec((const f_elm_t *)e, (const f_elm_t *)e, e2, 8);
+    f_sqr(e[7], s0);
+    tests[4][6] |= f_eq(e2[0], F_ONE) | f_eq(e2[7], s0);
+    f_axpy_vec(e[0], (const f_elm_t *)e, e, 8);                                   // -1 + (-1)(-1) = 0
+    tests[4][6] |= f_eq(e[0], Zero);
+
+    // Structure-of-arrays vectors against the scalar operations, n = TEST_LOOPS - 3 leaves padding lanes
+    // The second pass runs on the largest elements, -1 and -2
+    for(int r = 0; r < 2; r++){
+        const unsigned int n = sv0.n;
+        if(r == 1)
+            for(unsigned int k = 0; k < n; k++){
+                f_copy(e[k & 7], t0[k]);
+                f_copy(e[(k + 1) & 7], t1[k]);
+            }
+        f_vec_pack((const f_elm_t *)t0, &sv0);
+        f_vec_pack((const f_elm_t *)t1, &sv1);
+        f_vec_unpack(&sv0, t2);
+        tests[SOA_ROW][0] |= (memcmp(t0, t2, n * sizeof(f_elm_t)) != 0);
+        for(int i = 0; i < WORDS_FIELD; i++)
+            for(unsigned int k = n; k < sv0.stride; k++)
+                tests[SOA_ROW][0] |= (sv0.data[i * sv0.stride + k] != 0);
+
+        f_vec_add(&sv0, &sv1, &sv2); f_vec_unpack(&sv2, t2);                       // t0 + t1
+        for(unsigned int k = 0; k < n; k++){
+            f_add(t0[k], t1[k], s0);
+            tests[SOA_ROW][1] |= f_eq(s0, t2[k]);
+        }
+        f_vec_sub(&sv0, &sv1, &sv2); f_vec_unpack(&sv2, t2);                       // t0 - t1
+        for(unsigned int k = 0; k < n; k++){
+            f_sub(t0[k], t1[k], s0);
+            tests[SOA_ROW][1] |= f_eq(s0, t2[k]);
+        }
+        f_vec_mul(&sv0, &sv1, &sv2); f_vec_unpack(&sv2, t2);                       // t0 * t1
+        for(unsigned int k = 0; k < n; k++){
+            f_mul(t0[k], t1[k], s0);
+            tests[SOA_ROW][2] |= f_eq(s0, t2[k]);
+        }
+        f_vec_sqr(&sv0, &sv2); f_vec_unpack(&sv2, t2);                            // t0^2
+        for(unsigned int k = 0; k < n; k++){
+            f_sqr(t0[k], s0);
+            tests[SOA_ROW][3] |= f_eq(s0, t2[k]);
+        }
+        for(unsigned int k = 0; k < n; k++)
+            s[k] = (t0[k][0] ^ t1[k][WORDS_FIELD - 1] ^ k) & 1;
+        f_vec_select(&sv0, &sv1, &sv2, s); f_vec_unpack(&sv2, t2);                 // s ? t1 : t0
+        for(unsigned int k = 0; k < n; k++){
+            cond_select(t0[k], t1[k], s0, s[k]);
+            tests[SOA_ROW][4] |= (memcmp(s0, t2[k], sizeof(f_elm_t)) != 0);
+        }
+        f_vec_add(&sv0, &sv1, &sv0); f_vec_sub(&sv0, &sv1, &sv0);                    // in place, (t0 + t1) - t1 = t0
+        f_vec_unpack(&sv0, t2);
+        for(unsigned int k = 0; k < n; k++){
+            f_add(t0[k], t1[k], s0); f_sub(s0, t1[k], s0);
+            tests[SOA_ROW][1] |= f_eq(s0, t2[k]);
+        }
+    }
+
+    // Interleaved multiplications against f_mul and f_sqr, the last pass runs on -1 and -2
+    for(int i = 0; i + 4 <= TEST_LOOPS; i += 4){
+        f_elm_t *a = &t0[i], *b = &t1[i], r[4], r2[2];
+        if(i == TEST_LOOPS - 4){
+            a = e; b = &e[1];
+        }
+        f_mul2((const f_elm_t *)a, (const f_elm_t *)b, r);
+        f_sqr2((const f_elm_t *)a, r2);
+        for(int k = 0; k < 2; k++){
+            f_mul(a[k], b[k], s0);
+            tests[MULL_ROW][0] |= f_eq(s0, r[k]);
+            f_sqr(a[k], s0);
+            tests[MULL_ROW][0] |= f_eq(s0, r2[k]);
+        }
+        f_mul4((const f_elm_t *)a, (const f_elm_t *)b, r);
+        for(int k = 0; k < 4; k++){
+            f_mul(a[k], b[k], s0);
+            tests[MULL_ROW][1] |= f_eq(s0, r[k]);
+        }
+        f_sqr4((const f_elm_t *)a, r);
+        for(int k = 0; k < 4; k++){
+            f_sqr(a[k], s0);
+            tests[MULL_ROW][1] |= f_eq(s0, r[k]);
+        }
+    }
+    f_elm_t q[4], q2[4];                                                        // chained in place on their own outputs
+    for(int k = 0; k < 4; k++){
+        f_copy(t0[k], q[k]);
+        f_copy(t0[k], q2[k]);
+    }
+    for(int j = 0; j < 64; j++){
+        f_mul4((const f_elm_t *)q, (const f_elm_t *)&t1[4], q);
+        f_sqr2((const f_elm_t *)q, q);
+        for(int k = 0; k < 4; k++){
+            f_mul(q2[k], t1[4 + k], q2[k]);
+            if(k < 2) f_sqr(q2[k], q2[k]);
+        }
+    }
+    for(int k = 0; k < 4; k++){
+        tests[MULL_ROW][2] |= f_eq(q[k], q2[k]);
+#ifdef REDUNDANT_FORM
+        tests[MULL_ROW][2] |= out_of_range(q[k]);
+#endif
+    }
+
+    // Constant-time table lookup on every table size up to 17 and every index, out of range indices give 0
+    for(unsigned int n = 1; n <= 17; n++){
+        for(unsigned int idx = 0; idx < n + 3; idx++){
+            f_table_lookup((const f_elm_t *)&t0[n], n, idx, s0);
+            if(idx < n)
+                tests[CT_ROW][0] |= (memcmp(s0, t0[n + idx], sizeof(f_elm_t)) != 0);
+            else
+                tests[CT_ROW][0] |= (memcmp(s0, Zero, sizeof(f_elm_t)) != 0);
+        }
+    }
+    f_table_lookup((const f_elm_t *)t0, TEST_LOOPS, TEST_LOOPS - 1, s0);
+    tests[CT_ROW][0] |= (memcmp(s0, t0[TEST_LOOPS - 1], sizeof(f_elm_t)) != 0);
+
+    // Conditional swap, against cond_select, twice back to the start
+    for(int i = 0; i < TEST_LOOPS - 1; i++){
+        uint8_t c = t1[i][0] & 1;
+        f_copy(t0[i], s0); f_copy(t0[i + 1], s1);
+        f_cswap(s0, s1, c);
+        cond_select(t0[i], t0[i + 1], s2, c);
+        tests[CT_ROW][1] |= (memcmp(s0, s2, sizeof(f_elm_t)) != 0);
+        cond_select(t0[i + 1], t0[i], s2, c);
+        tests[CT_ROW][1] |= (memcmp(s1, s2, sizeof(f_elm_t)) != 0);
+        f_cswap(s0, s1, c);
+        tests[CT_ROW][2] |= (memcmp(s0, t0[i], sizeof(f_elm_t)) != 0) | (memcmp(s1, t0[i + 1], sizeof(f_elm_t)) != 0);
+    }
+    f_cswap(s0, s0, 1);                                                     // with itself
+    tests[CT_ROW][2] |= (memcmp(s0, Zero, sizeof(f_elm_t)) != 0) ^ (memcmp(t0[TEST_LOOPS - 2], Zero, sizeof(f_elm_t)) != 0);
+
+    // Prepared constants against f_mul, random and edge multipliers, in place
+    f_const_t kc;
+    for(int i = 0; i < TEST_LOOPS; i++){
+        const digit_t *c = (i == 0) ? Zero : (i == 1) ? F_ONE : (i < 4) ? e[i - 2] : t1[i];
+        f_const_prepare(c, &kc);
+        for(int j = 0; j < 4; j++){
+            const digit_t *a = (j < 2) ? e[j] : t0[(i + j) % TEST_LOOPS];
+            f_mul(a, c, s0);
+            f_mul_const(a, &kc, s1);
+            tests[CONST_ROW][0] |= f_eq(s0, s1);
+        }
+        f_copy(t0[i], s1);
+        f_mul_const(s1, &kc, s1);
+        f_mul(t0[i], c, s0);
+        tests[CONST_ROW][0] |= f_eq(s0, s1);
+    }
+
+    // Small integers against f_mul by the same integer as a field element, built by doubling and adding 1
+    digit_t ks[] = {0, 1, 2, 3, 19, 121666, 0xFFFFFFFF, 0x8000000000000001, 0xFFFFFFFFFFFFFFFF, 0, 0};
+    ks[9] = t1[0][0]; ks[10] = t1[1][0] >> 7;
+    for(unsigned int j = 0; j < sizeof(ks) / sizeof(ks[0]); j++){
+        f_copy(Zero, s2);
+        for(int b = 63; b >= 0; b--){
+            f_add(s2, s2, s2);
+            if((ks[j] >> b) & 1) f_add(s2, F_ONE, s2);
+        }
+        for(int i = 0; i < TEST_LOOPS; i++){
+            const digit_t *a = (i < 2) ? e[i] : (i == 2) ? Zero : t0[i];
+            f_mul(a, s2, s0);
+            f_mul_small(a, ks[j], s1);
+            tests[CONST_ROW][1] |= f_eq(s0, s1);
+#ifdef REDUNDANT_FORM
+            tests[CONST_ROW][1] |= out_of_range(s1);
+#endif
+        }
+    }
+
+    // Chained on their own outputs
+    f_const_prepare(t1[0], &kc);
+    f_copy(t0[0], s0); f_copy(t0[0], s1);
+    for(int i = 0; i < 64; i++){
+        f_mul_const(s0, &kc, s0); f_mul_small(s0, 121666, s0);
+        f_mul(s1, t1[0], s1); f_mul_small(s1, 121665, s2); f_add(s1, s2, s1);
+    }
+    tests[CONST_ROW][2] |= f_eq(s0, s1);
+
+    // Batch inversion with zeros at both ends and in the middle, then in place back to t0
+    f_copy(Zero, t0[0]); f_copy(Zero, t0[TEST_LOOPS / 2]); f_copy(Zero, t0[TEST_LOOPS - 1]);
+    f_inv_batch((const f_elm_t *)t0, t2, TEST_LOOPS, t1);
+    for(int i = 0; i < TEST_LOOPS; i++){
+        f_inv(t0[i], s0);
+        tests[7][4] |= f_eq(t2[i], s0);
     }
+    f_inv_batch((const f_elm_t *)t2, t2, TEST_LOOPS, t1);
+    f_inv_batch((const f_elm_t *)t0, &s0, 1, t1);       // n = 1, a single zero
+    tests[7][4] |= f_eq(s0, Zero);
+    for(int i = 0; i < TEST_LOOPS; i++)
+        tests[7][4] |= f_eq(t2[i], t0[i]);
 
     // Print results
     for(int j = 0; j < NUM_TESTS; j++){
@@ -211,6 +805,9 @@ int main(int argc, char* argv[]){
         printf("✗ Some tests failed!\n\n");
 
 cleanup:
+    f_vec_free(&sv0);
+    f_vec_free(&sv1);
+    f_vec_free(&sv2);
     free(t0);
     free(t1);
     free(t2);
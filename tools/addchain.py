@@ -0,0 +1,412 @@
+#!/usr/bin/env python3
+"""Addition chain generator for the fixed exponentiations of the field arithmetic.
+
+Given an exponent e, emits a straight-line C function computing b = a^e with f_sqr and f_mul.
+The exponent is split into windows, most significant first: runs of ones become one window
+a^(2^k - 1), the remaining ones sliding windows of odd values of up to w bits. The run values
+come from an addition chain on the run lengths, x_(i+j) = x_i^(2^j) * x_j, searched for the
+fewest multiplications and then the fewest squarings. The odd values come from a table
+a, a^3, a^5, ... Every window width is tried and the cheapest chain is kept.
+
+    tools/addchain.py 0x7fff...ffeb                     # one exponent, printed to stdout
+    tools/addchain.py --prime p256_0 "(p + 1) / 4"      # an expression in p
+    tools/addchain.py --all                             # regenerates src/primes/*/chains.h
+
+The primes are read from src/primes/<name>/prime_params.c.
+"""
+
+import argparse
+import functools
+import os
+import re
+import sys
+
+SQR_COST = 0.8          # f_sqr relative to f_mul, only used to pick among chains
+MAX_WINDOW = 5
+COMMENT_COLUMN = 44
+SEARCH_NODES = 200000   # budget of the run length chain search, the binary method is the fallback
+
+ROOT = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+PRIMES = ["p64_0", "p64_1", "p128_0", "p128_1", "p192_0", "p192_1", "p256_0", "p256_1", "p512_0", "p512_1"]
+
+
+# -- Addition chain on run lengths --------------------------------------------------------------
+
+def binary_chain(start, targets):
+    """Fallback: the targets in increasing order, each as a sum of two lengths the chain has, or by the binary method"""
+    have = set(start)
+    steps = []
+
+    def build(k):
+        if k in have:
+            return
+        pairs = [(k - j, j) for j in have if j <= k - j and k - j in have]
+        if pairs:
+            steps.append((k,) + min(pairs, key=lambda x: x[1]))
+        elif k % 2 == 0:
+            build(k // 2)
+            steps.append((k, k // 2, k // 2))
+        else:
+            build(k - 1)
+            steps.append((k, k - 1, 1))
+        have.add(k)
+
+    for k in sorted(targets):
+        build(k)
+    return steps
+
+
+def chain_cost(steps):
+    return (len(steps), sum(min(i, j) for _, i, j in steps))
+
+
+@functools.lru_cache(maxsize=None)
+def run_chain(start, targets):
+    """Shortest chain from the lengths in start that contains every target, as (k, i, j) steps with k = i + j"""
+    targets = sorted(set(targets) - set(start))
+    if not targets:
+        return []
+    top = targets[-1]
+    best = [binary_chain(start, targets)]
+    nodes = [0]
+
+    def search(chain, steps, left):
+        nodes[0] += 1
+        if nodes[0] > SEARCH_NODES:
+            return
+        missing = [t for t in targets if t not in chain]
+        if not missing:
+            if chain_cost(steps) < chain_cost(best[0]):
+                best[0] = list(steps)
+            return
+        if len(missing) > left or chain[-1] << left < top:
+            return
+        cands = sorted({x + y for x in chain for y in chain if chain[-1] < x + y <= top}, reverse=True)
+        for k in cands:
+            j = min(y for y in chain if k - y in chain)
+            i = k - j
+            steps.append((k, max(i, j), min(i, j)))
+            search(chain + [k], steps, left - 1)
+            steps.pop()
+
+    for length in range(len(targets), len(best[0]) + 1):
+        nodes[0] = 0
+        search(sorted(set(start)), [], length)
+        if len(best[0]) <= length:
+            break
+    return best[0]
+
+
+# -- Windows and the straight-line program ------------------------------------------------------
+
+def split_windows(e, w):
+    """Windows (low bit, width, value, is_run) of e, most significant first"""
+    bits = bin(e)[2:]
+    n = len(bits)
+    out = []
+    i = 0
+    while i < n:
+        if bits[i] == "0":
+            i += 1
+            continue
+        r = len(bits[i:]) - len(bits[i:].lstrip("1"))
+        if r >= w:
+            width = r
+        else:
+            width = min(w, n - i)
+            for j in range(i + r + 1, i + width):       # stop before a run that makes its own window
+                if bits[j] == "1" and bits[j - 1] == "0":
+                    rj = len(bits[j:]) - len(bits[j:].lstrip("1"))
+                    if rj >= w or j + rj > i + width:
+                        width = j - i
+                        break
+            width = len(bits[i:i + width].rstrip("0"))
+        value = int(bits[i:i + width], 2)
+        out.append((n - i - width, width, value, value == (1 << width) - 1))
+        i += width
+    return out
+
+
+class Program:
+    """Straight-line program on symbolic values, value 0 is the input a"""
+
+    def __init__(self):
+        self.ops = []           # (kind, dst, x, y or shift, comment), ("=", value) or ("#", bits of e)
+        self.nvals = 1
+        self.sqr = 0
+        self.mul = 0
+
+    def new(self):
+        self.nvals += 1
+        return self.nvals - 1
+
+    def op_sqr(self, x, n, comment=None):
+        v = self.new()
+        self.ops.append(("sqr", v, x, n, comment))
+        self.sqr += n
+        return v
+
+    def op_mul(self, x, y, comment=None):
+        v = self.new()
+        self.ops.append(("mul", v, x, y, comment))
+        self.mul += 1
+        return v
+
+    def cost(self):
+        return SQR_COST * self.sqr + self.mul
+
+
+def power_desc(v):
+    """a^v written with runs of ones where that is shorter"""
+    if v == 1:
+        return "a"
+    k = v.bit_length()
+    if v == (1 << k) - 1 and k > 3:
+        return "a^(2^%d - 1)" % k
+    return "a^%d" % v
+
+
+def build_program(e, w, targets):
+    """Program for the windows of width w, the run lengths in targets are built by the chain, other runs are
+    covered by the longest runs the chain has"""
+    wins = split_windows(e, w)
+    odd = sorted({v for _, _, v, run in wins if not run and v > 1})
+    prog = Program()
+    have = {1: 0}                                       # exponent -> value
+
+    if odd:
+        a2 = prog.op_sqr(0, 1, ("=", "a^2"))
+        for v in range(3, odd[-1] + 1, 2):
+            have[v] = prog.op_mul(have[v - 2], a2, ("=", power_desc(v)))
+
+    start = [k for k in range(1, MAX_WINDOW + 1) if (1 << k) - 1 in have]
+    for k, i, j in run_chain(tuple(start), tuple(sorted(targets))):
+        x = prog.op_sqr(have[(1 << i) - 1], j)
+        have[(1 << k) - 1] = prog.op_mul(x, have[(1 << j) - 1], ("=", power_desc((1 << k) - 1)))
+    lengths = sorted((v.bit_length() for v in have if v & (v + 1) == 0), reverse=True)
+
+    def pieces(width):
+        out = []
+        while width > 0:
+            out.append(next(k for k in lengths if k <= width))
+            width -= out[-1]
+        return out
+
+    first = pieces(wins[0][1]) if wins[0][3] else [wins[0][1]]
+    acc = have[(1 << first[0]) - 1] if wins[0][3] else have[wins[0][2]]
+    low = wins[0][0] + wins[0][1] - first[0]
+    for k in first[1:]:
+        acc = prog.op_sqr(acc, k)
+        acc = prog.op_mul(acc, have[(1 << k) - 1])
+    for pos, width, v, run in wins[1:]:
+        if width == 1:
+            comment = ("#", "bit %d" % pos)
+        elif run:
+            comment = ("#", "bits %d to %d, %d ones" % (pos + width - 1, pos, width))
+        else:
+            comment = ("#", "bits %d to %d, 0b%s" % (pos + width - 1, pos, bin(v)[2:]))
+        top = pos + width
+        for k in (pieces(width) if run else [width]):
+            acc = prog.op_sqr(acc, low - top + k, comment)
+            acc = prog.op_mul(acc, have[(1 << k) - 1] if run else have[v])
+            low = top - k
+            top = low
+            comment = None
+    if low > 0:
+        acc = prog.op_sqr(acc, low, ("#", "bits %d to 0, zeros" % (low - 1)))
+    prog.result = acc
+    return prog
+
+
+def best_program(e):
+    """Cheapest program over the window widths and the choice of run lengths for the chain. A run below the top
+    one is built whole, through its remainder modulo the top run (94 = 32 + 32 + 30) or only from the others"""
+    progs = []
+    for w in range(1, MAX_WINDOW + 1):
+        wins = split_windows(e, w)
+        top = wins[0][1] if wins[0][3] and wins[0][1] > 1 else 0
+        options = [[]]
+        for width in sorted({width for _, width, _, run in wins[1:] if run and width > 1 and width != top}):
+            alt = [(width,), ()]
+            if top and width > top and width % top > 1:
+                alt.append((width % top,))
+            options = [o + list(x) for o in options for x in alt]
+        for extra in options:
+            progs.append(build_program(e, w, set(extra) | ({top} if top else set())))
+    return min(progs, key=lambda q: (q.cost(), q.nvals))
+
+
+# -- Register allocation and C output -----------------------------------------------------------
+
+def allocate(prog):
+    """Registers t[0], t[1], ... for the values, a result overwrites an operand that dies with it"""
+    last = {}
+    for idx, (kind, dst, x, y, _) in enumerate(prog.ops):
+        last[x] = idx
+        if kind == "mul":
+            last[y] = idx
+    last[prog.result] = len(prog.ops)
+
+    reg = {}
+    free = []
+    nregs = 0
+    for idx, (kind, dst, x, y, _) in enumerate(prog.ops):
+        srcs = [x] if kind == "sqr" else [x, y]
+        dying = [s for s in srcs if s != 0 and last.get(s) == idx]
+        if dying:
+            reg[dst] = reg[dying[0]]
+            free += [reg[s] for s in dying[1:] if reg[s] != reg[dst]]
+        elif free:
+            free.sort()
+            reg[dst] = free.pop(0)
+        else:
+            reg[dst] = nregs
+            nregs += 1
+        if last.get(dst) is None:
+            free.append(reg[dst])
+    return reg, nregs
+
+
+def emit_function(name, e, what, fp2=False):
+    prog = best_program(e)
+    reg, nregs = allocate(prog)
+    lines = []
+
+    def r(v):
+        return "a" if v == 0 else "t[%d]" % reg[v]
+
+    def sqr(x, y):
+        return ("fp_2_sqr(%s, %s);" if fp2 else "f_sqr(%s, %s);") % (x, y)
+
+    def mul(x, y, z):
+        return ("fp_2_mul(%s, %s, %s, w);" if fp2 else "f_mul(%s, %s, %s);") % (x, y, z)
+
+    if fp2:
+        lines.append("// b = a^(%s) in Fp2, %d squarings and %d multiplications" % (what, prog.sqr, prog.mul))
+        lines.append("static void %s(const f_elm_t a[3], f_elm_t b[3], const f_elm_t w)" % name)
+        lines.append("{")
+        lines.append("    f_elm_t t[%d][3];" % nregs)
+    else:
+        lines.append("// b = a^(%s), %d squarings and %d multiplications" % (what, prog.sqr, prog.mul))
+        lines.append("static void %s(const f_elm_t a, f_elm_t b)" % name)
+        lines.append("{")
+        lines.append("    f_elm_t t[%d];" % nregs)
+    lines.append("")
+    head = len(lines)
+
+    def annotate(line, note):
+        return line.ljust(COMMENT_COLUMN) + note if note else line
+
+    for kind, dst, x, y, comment in prog.ops:
+        if comment and comment[0] == "#":
+            lines.append("")
+            lines.append("    // %s" % comment[1])
+        d = r(dst)
+        if fp2 and dst == prog.result:
+            d = "b"
+        note = ("// %s = %s" % (d, comment[1])) if comment and comment[0] == "=" else ""
+        if kind == "mul":
+            lines.append(annotate("    " + mul(r(x), r(y), d), note))
+            continue
+        # d = x^(2^y), the first squaring moves the value into its register when it has another one
+        n = y
+        if fp2 and dst == prog.result and n > 1:
+            raise ValueError("Fp2 chains must end with a multiplication")
+        if r(x) != d:
+            lines.append("    " + sqr(r(x), d))
+            n -= 1
+        if n == 1:
+            lines.append("    " + sqr(d, d))
+        elif n == 2:
+            lines += ["    " + sqr(d, d)] * 2
+        elif n > 2:
+            lines.append("    for (i = 0; i < %d; i++)" % n)
+            lines.append("        " + sqr(d, d))
+        lines[-1] = annotate(lines[-1], note)
+    if not fp2:
+        lines.append("")
+        lines.append("    f_copy(%s, b);" % r(prog.result))
+    lines.append("}")
+    if any(line.lstrip().startswith("for (i") for line in lines):
+        lines.insert(head - 1, "    unsigned int i;")
+    return "\n".join(lines), prog
+
+
+# -- Primes -------------------------------------------------------------------------------------
+
+def read_prime(name):
+    path = os.path.join(ROOT, "src", "primes", name, "prime_params.c")
+    with open(path) as f:
+        text = f.read()
+    m = re.search(r"digit_t\s+p\s*\[\s*WORDS_FIELD\s*\]\s*=\s*\{([^}]*)\}", text)
+    if not m:
+        sys.exit("%s: no definition of p" % path)
+    words = [int(x, 16) for x in re.findall(r"0x[0-9A-Fa-f]+", m.group(1))]
+    return sum(x << (64 * i) for i, x in enumerate(words))
+
+
+def eval_exponent(expr, p):
+    if not re.fullmatch(r"[0-9a-fA-FxXp+\-*/%() ]+", expr):
+        sys.exit("unsupported exponent expression: %s" % expr)
+    return int(eval(expr.replace("/", "//"), {"__builtins__": {}}, {"p": p}))
+
+
+def chains_header(name, p):
+    """The exponentiations of a prime: inversion, Euler's criterion and the square root"""
+    funcs = [("f_pow_inv", p - 2, "p - 2", "FERMAT_INVERSION", False),
+             ("f_pow_leg", (p - 1) // 2, "(p - 1)/2", "EULER_LEGENDRE", False)]
+    if p % 4 == 3:
+        funcs.append(("f_pow_sqrt", (p + 1) // 4, "(p + 1)/4", None, False))
+    elif p % 8 == 5:
+        funcs.append(("f_pow_sqrt", (p - 5) // 8, "(p - 5)/8", None, False))
+    else:
+        funcs.append(("fp_2_pow_sqrt", (p + 1) // 2, "(p + 1)/2", None, True))
+
+    guard = "CHAINS_H"
+    out = ["// Generated by tools/addchain.py, do not edit",
+           "// Exponentiations by fixed powers of p = 0x%X" % p,
+           "",
+           "#ifndef %s" % guard,
+           "#define %s" % guard]
+    for fname, e, what, flag, fp2 in funcs:
+        text, _ = emit_function(fname, e, what, fp2)
+        out.append("")
+        if flag:
+            out.append("#ifdef %s" % flag)
+        out.append(text)
+        if flag:
+            out.append("#endif")
+    out.append("")
+    out.append("#endif")
+    return "\n".join(out) + "\n"
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Addition chains for fixed exponents as straight-line C")
+    ap.add_argument("exponent", nargs="?", help="integer, or an expression in p with --prime")
+    ap.add_argument("--prime", choices=PRIMES, help="prime for the expression, from prime_params.c")
+    ap.add_argument("--name", default="f_pow", help="name of the emitted function")
+    ap.add_argument("--all", action="store_true", help="regenerate src/primes/*/chains.h")
+    args = ap.parse_args()
+
+    if args.all:
+        for name in PRIMES:
+            path = os.path.join(ROOT, "src", "primes", name, "chains.h")
+            with open(path, "w") as f:
+                f.write(chains_header(name, read_prime(name)))
+            print("wrote %s" % os.path.relpath(path, ROOT))
+        return
+    if args.exponent is None:
+        ap.error("an exponent or --all is required")
+    p = read_prime(args.prime) if args.prime else None
+    if p is None and "p" in args.exponent.replace("0x", ""):
+        ap.error("--prime is required for an expression in p")
+    e = eval_exponent(args.exponent, p) if p else int(args.exponent, 0)
+    if e < 1:
+        ap.error("the exponent must be positive")
+    text, _ = emit_function(args.name, e, args.exponent)
+    print(text)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,243 @@
+#!/usr/bin/env python3
+"""Two-lane Montgomery multiplication kernels for the ARM64 backends.
+
+Emits f_mul2_asm(a, b, c), c[l] = a[l] * b[l] * R^(-1) mod p for the two elements l = 0, 1 stored one after the
+other, as straight-line ARM64 assembly for one prime. Both lanes run the product scanning Montgomery multiplication
+of f_mul_lanes in src/arith.c: column k sums a[j]*b[k-j] and m[j]*p[k-j] into a three-word accumulator, the columns
+below WORDS_FIELD give the Montgomery words m[k] and the upper ones the result, which is corrected by one conditional
+subtraction of p. The loads and multiplications of the two lanes alternate. The carry chains cannot, the lanes share
+the flags, so each product ends with the short add chain of lane 0 and then the one of lane 1, and the multiplier
+works on one lane while the other adds. Products by zero words of p are left out.
+
+    tools/mullanes.py --prime p256_0                    # printed to stdout
+    tools/mullanes.py --all                             # regenerates src/primes/*/arm64/arith_arm*_mul2.S
+
+The primes are read from src/primes/<name>/prime_params.c.
+"""
+
+import argparse
+import os
+import sys
+
+from addchain import PRIMES, ROOT, read_prime
+
+COMMENT_COLUMN = 44
+
+# x0, x1, x2 hold a, b and c, x3 a word of p or -p^(-1) shared by the lanes. Each lane has a rotating three-word
+# accumulator, the low and high words of a product and its two operands. x18 is left alone (platform register).
+SHARED = "x3"
+LANES = [{"acc": ["x4", "x5", "x6"], "lo": "x7", "hi": "x8", "x": "x9", "y": "x10"},
+         {"acc": ["x11", "x12", "x13"], "lo": "x14", "hi": "x15", "x": "x16", "y": "x17"}]
+
+
+class Kernel:
+    def __init__(self, p, words):
+        self.p = p
+        self.n = words
+        self.pw = [(p >> (64 * i)) & (2**64 - 1) for i in range(words)]
+        self.lines = []
+        self.acc = [list(lane["acc"]) for lane in LANES]
+        self.zero = [True, True, True]                  # accumulator words known to be zero, the same in both lanes
+
+    # Stack frame: m[2][n] then r[2][n + 1]
+    def m_off(self, lane, j):
+        return 8 * (lane * self.n + j)
+
+    def r_off(self, lane, i):
+        return 8 * (2 * self.n + lane * (self.n + 1) + i)
+
+    def frame(self):
+        return (8 * (4 * self.n + 2) + 15) // 16 * 16
+
+    def emit(self, op, args="", comment=None):
+        line = "    %-8s%s" % (op, args) if args else "    %s" % op
+        if comment:
+            line = line.ljust(COMMENT_COLUMN) + "// " + comment
+        self.lines.append(line.rstrip())
+
+    def blank(self):
+        self.lines.append("")
+
+    def note(self, text):
+        self.lines.append("    // " + text)
+
+    def a(self, lane, w):
+        """Accumulator word w of a lane, xzr when it is known to be zero"""
+        return "xzr" if self.zero[w] else self.acc[lane][w]
+
+    def add_product(self, lo, hi):
+        """acc += hi:lo in both lanes, lo and hi map a lane to its registers"""
+        for l in range(2):
+            a0, a1, a2 = self.acc[l]
+            if self.zero[1] and self.zero[2]:
+                # hi <= 2^64 - 2, the carry stays in the second word
+                self.emit("adds", "%s, %s, %s" % (a0, self.a(l, 0), lo[l]))
+                self.emit("adc", "%s, %s, xzr" % (a1, hi[l]))
+            else:
+                self.emit("adds", "%s, %s, %s" % (a0, self.a(l, 0), lo[l]))
+                self.emit("adcs", "%s, %s, %s" % (a1, self.a(l, 1), hi[l]))
+                self.emit("adc", "%s, %s, xzr" % (a2, self.a(l, 2)))
+        if not (self.zero[1] and self.zero[2]):
+            self.zero[2] = False
+        self.zero[0] = self.zero[1] = False
+
+    def product(self, xs, ys, shared=None):
+        """Loads the operands of both lanes (ys is None when the second one is the shared register) and multiplies"""
+        for l in range(2):
+            self.emit("ldr", "%s, %s" % (LANES[l]["x"], xs[l]))
+            if ys:
+                self.emit("ldr", "%s, %s" % (LANES[l]["y"], ys[l]))
+        y = [shared or LANES[l]["y"] for l in range(2)]
+        if all(self.zero):
+            # First product into an empty accumulator, straight into its two low words
+            for l in range(2):
+                self.emit("mul", "%s, %s, %s" % (self.acc[l][0], LANES[l]["x"], y[l]))
+            for l in range(2):
+                self.emit("umulh", "%s, %s, %s" % (self.acc[l][1], LANES[l]["x"], y[l]))
+            self.zero[0] = self.zero[1] = False
+            return
+        for l in range(2):
+            self.emit("mul", "%s, %s, %s" % (LANES[l]["lo"], LANES[l]["x"], y[l]))
+        for l in range(2):
+            self.emit("umulh", "%s, %s, %s" % (LANES[l]["hi"], LANES[l]["x"], y[l]))
+        self.add_product([LANES[l]["lo"] for l in range(2)], [LANES[l]["hi"] for l in range(2)])
+
+    def column(self, k):
+        n = self.n
+        self.blank()
+        self.note("Column %d" % k)
+        lo_j, hi_j = max(0, k - n + 1), min(k, n - 1)
+        for j in range(lo_j, hi_j + 1):
+            self.product(["[x0, #%d]" % (8 * (l * n + j)) for l in range(2)],
+                         ["[x1, #%d]" % (8 * (l * n + k - j)) for l in range(2)])
+        for j in range(lo_j, min(k - 1, hi_j) + 1):
+            if self.pw[k - j] == 0:
+                continue
+            self.emit("ldr", "%s, mul2_p + %d" % (SHARED, 8 * (k - j)) if k - j else "%s, mul2_p" % SHARED)
+            self.product(["[sp, #%d]" % self.m_off(l, j) for l in range(2)], None, SHARED)
+
+        if k < n:
+            # m[k] = acc0 * (-p^(-1)) makes acc + m[k]*p[0] divisible by 2^64: only the high word of m[k]*p[0]
+            # is added, with the carry of the low word (1 unless acc0 = 0)
+            assert not self.zero[0]
+            self.emit("ldr", "%s, mul2_pp0" % SHARED)
+            for l in range(2):
+                self.emit("mul", "%s, %s, %s" % (LANES[l]["x"], self.acc[l][0], SHARED))
+            self.emit("ldr", "%s, mul2_p" % SHARED)
+            for l in range(2):
+                self.emit("str", "%s, [sp, #%d]" % (LANES[l]["x"], self.m_off(l, k)))
+                self.emit("umulh", "%s, %s, %s" % (LANES[l]["hi"], LANES[l]["x"], SHARED))
+            for l in range(2):
+                a0, a1, a2 = self.acc[l]
+                self.emit("cmp", "%s, #1" % a0)
+                self.emit("adcs", "%s, %s, %s" % (a1, self.a(l, 1), LANES[l]["hi"]))
+                self.emit("adc", "%s, %s, xzr" % (a2, self.a(l, 2)))
+            self.zero[1] = self.zero[2] = False
+        else:
+            for l in range(2):
+                self.emit("str", "%s, [sp, #%d]" % (self.a(l, 0), self.r_off(l, k - n)))
+
+        # Shift the accumulator down by a word, the low register becomes the new (zero) top word
+        for l in range(2):
+            self.acc[l] = self.acc[l][1:] + self.acc[l][:1]
+        self.zero = self.zero[1:] + [True]
+
+    def final(self):
+        n = self.n
+        self.blank()
+        self.note("r = acc1:acc0:..., below 2p")
+        for l in range(2):
+            self.emit("str", "%s, [sp, #%d]" % (self.a(l, 0), self.r_off(l, n - 1)))
+            self.emit("str", "%s, [sp, #%d]" % (self.a(l, 1), self.r_off(l, n)))
+
+        for l in range(2):
+            self.blank()
+            self.note("c[%d] = r - p, r if that borrows" % l)
+            x, y = LANES[l]["x"], LANES[l]["y"]
+            for i in range(n):
+                self.emit("ldr", "%s, [sp, #%d]" % (x, self.r_off(l, i)))
+                if self.pw[i]:
+                    self.emit("ldr", "%s, mul2_p + %d" % (y, 8 * i) if i else "%s, mul2_p" % y)
+                self.emit("subs" if i == 0 else "sbcs", "%s, %s, %s" % (x, x, y if self.pw[i] else "xzr"))
+                self.emit("str", "%s, [x2, #%d]" % (x, 8 * (l * n + i)))
+            self.emit("ldr", "%s, [sp, #%d]" % (x, self.r_off(l, n)))
+            self.emit("sbcs", "xzr, %s, xzr" % x)
+            for i in range(n):
+                self.emit("ldr", "%s, [sp, #%d]" % (x, self.r_off(l, i)))
+                self.emit("ldr", "%s, [x2, #%d]" % (y, 8 * (l * n + i)))
+                self.emit("csel", "%s, %s, %s, lo" % (y, x, y))
+                self.emit("str", "%s, [x2, #%d]" % (y, 8 * (l * n + i)))
+
+    def body(self):
+        self.emit("sub", "sp, sp, #%d" % self.frame(), "m[2][%d], r[2][%d]" % (self.n, self.n + 1))
+        for k in range(2 * self.n - 1):
+            self.column(k)
+        self.final()
+        self.blank()
+        self.emit("add", "sp, sp, #%d" % self.frame())
+        self.emit("ret")
+        return self.lines
+
+
+def mul2_source(name, p):
+    bits = int(name[1:].split("_")[0])
+    words = bits // 64
+    pw = [(p >> (64 * i)) & (2**64 - 1) for i in range(words)]
+    pp0 = (-pow(p, -1, 2**64)) % 2**64
+
+    out = ["// Generated by tools/mullanes.py, do not edit",
+           "// Two interleaved Montgomery multiplications modulo p = 0x%X" % p,
+           "",
+           "// Format function and variable names for Mac OS X",
+           "#if defined(__APPLE__)",
+           "    #define fmt(f)    _##f",
+           "#else",
+           "    #define fmt(f)    f",
+           "#endif",
+           "",
+           ".text",
+           ".align 4",
+           "",
+           "",
+           "// Field characteristic",
+           "mul2_p:"]
+    out += [".quad   0x%016X" % w for w in pw]
+    out += ["",
+            "// -p^(-1) mod 2^64",
+            "mul2_pp0:",
+            ".quad   0x%016X" % pp0,
+            "",
+            "",
+            "//***********************************************************************",
+            "//  Two field multiplications with interleaved carry chains",
+            "//  Input: a[x0] 2 elements < p; b[x1] 2 elements < p",
+            "//  Output: c[x2] 2 elements < p, c may be a or b",
+            "//  Operation: c[l] = a[l] * b[l] * R^(-1) mod p, l = 0, 1",
+            "//***********************************************************************",
+            ".global fmt(f_mul2_asm)",
+            "fmt(f_mul2_asm):"]
+    out += Kernel(p, words).body()
+    return "\n".join(out) + "\n"
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Two-lane Montgomery multiplication kernels in ARM64 assembly")
+    ap.add_argument("--prime", choices=PRIMES, help="print the kernel of one prime")
+    ap.add_argument("--all", action="store_true", help="regenerate src/primes/*/arm64/arith_arm*_mul2.S")
+    args = ap.parse_args()
+
+    if args.all:
+        for name in PRIMES:
+            bits = name[1:].split("_")[0]
+            path = os.path.join(ROOT, "src", "primes", name, "arm64", "arith_arm%s_mul2.S" % bits)
+            with open(path, "w") as f:
+                f.write(mul2_source(name, read_prime(name)))
+            print("wrote %s" % os.path.relpath(path, ROOT))
+        return
+    if args.prime is None:
+        ap.error("--prime or --all is required")
+    sys.stdout.write(mul2_source(args.prime, read_prime(args.prime)))
+
+
+if __name__ == "__main__":
+    main()